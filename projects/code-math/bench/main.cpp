@@ -0,0 +1,450 @@
+#include <basic>
+#include <engine>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <filesystem>
+#include <iterator>
+#include <fixed-string>
+#include <fnv-hash>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using std::vector;
+namespace fs = std::filesystem;
+
+// code-math 的吞吐量基准测试：生成合成的 C++ 输入，运行完整的 exectute() 流程，
+// 报告每种输入的吞吐量 (MB/s)、每秒替换次数与峰值常驻内存，并记录输出的散列值，用于证明引擎的修改不改变输出；
+// 另外逐个命令报告同样的数据
+// 用法: code-math-bench [--sizes 1K,64K,1M,16M] [--density 比例] [--seed 种子] [--output 文件]
+//                       [--compare 基线文件] [--threshold 比例] [--per-command on|off] [--save-outputs 目录]
+//   --sizes         输入的字节数，可以使用 K、M 后缀 (1K = 1024)，上限为 100M，默认为 1K,64K,1M,16M
+//   --density       生成的语句中类型位置使用 context 中类型名的比例，默认为 0.2
+//   --seed          生成输入所用的随机数种子，默认为 1
+//   --output        把 JSON 写入文件 (默认写到标准输出)
+//   --compare       与基线比较：输出的散列值不同视为错误，吞吐量低于基线 (1 - threshold) 倍视为退化，
+//                   报告写到标准错误，存在错误或退化时返回1
+//   --threshold     退化的判定比例，默认为 0.10
+//   --per-command   是否另外逐个命令测量 (每个替换命令一个子进程，报告各自的吞吐量与峰值常驻内存)，默认为 on
+//   --save-outputs  把每种输入与对应的输出保存到该目录，便于逐字节比较
+
+constexpr sizevalue MAX_CORPUS_BYTES = 100 * 1024 * 1024;
+
+// context 中定义了替换规则的类型名
+const vector<const char*> TYPE_NAMES = {
+    "int8", "int16", "int32", "int64", "intmin", "intmax",
+    "nat8", "nat16", "nat32", "nat64", "natmin", "natmax", "sizevalue"
+};
+// 普通标识符，其中一些含有类型名但不应被替换，用于检验标识符的边界
+const vector<const char*> OTHER_NAMES = {
+    "value", "index", "count", "total", "buffer", "result", "auto",
+    "nat8_count", "my_int32", "sizevalue_max", "intmax_limit", "natmaxima"
+};
+
+struct bench_result
+{
+    byte_array name;
+    sizevalue input_bytes;
+    float64 seconds;
+    sizevalue matches;
+    sizevalue peak_rss_kilobytes;
+    natmax output_hash;
+};
+
+// 逻辑规范：
+// 前置条件 P: 0 <= density <= 1
+// 后置条件 Q: 返回恰好 bytes 个字节的合成 C++ 代码，同样的参数总是得到同样的内容
+byte_array generate_corpus(sizevalue bytes, float64 density, natmax seed)
+{
+    std::mt19937_64 random(seed);
+    std::bernoulli_distribution use_type_name(density);
+    auto type_slot = [&]() -> byte_array {
+        return use_type_name(random) ? TYPE_NAMES[random() % TYPE_NAMES.size()] : OTHER_NAMES[random() % OTHER_NAMES.size()];
+    };
+    auto name_slot = [&]() -> byte_array {
+        return byte_array(OTHER_NAMES[random() % OTHER_NAMES.size()]) + "_" + std::to_string(random() % 100);
+    };
+
+    byte_array corpus;
+    corpus.reserve(bytes + 256);
+    sizevalue depth = 0;
+    while (corpus.size() < bytes) {
+        byte_array indent(depth * 4, ' ');
+        switch (random() % 6) {
+        case 0:
+            corpus += indent + type_slot() + " " + name_slot() + " = static_cast<" + type_slot() + ">(" + name_slot() + ") + " + std::to_string(random() % 1000) + ";\n";
+            break;
+        case 1:
+            if (depth < 8) {
+                corpus += indent + "for (" + type_slot() + " i = 0; i < " + name_slot() + "; ++i) {\n";
+                ++depth;
+            }
+            break;
+        case 2:
+            if (depth > 0) {
+                --depth;
+                corpus += byte_array(depth * 4, ' ') + "}\n";
+            }
+            break;
+        case 3:
+            corpus += indent + "// " + type_slot() + " is converted before " + name_slot() + "\n";
+            break;
+        case 4:
+            corpus += indent + name_slot() + "(" + type_slot() + "{}, " + name_slot() + ");\n";
+            break;
+        default:
+            corpus += indent + "return (" + type_slot() + ")" + name_slot() + ";\n";
+            break;
+        }
+    }
+    corpus.resize(bytes);
+    return corpus;
+}
+
+// 子进程写回父进程的测量结果
+struct child_report
+{
+    float64 seconds;
+    sizevalue matches;
+    natmax output_hash;
+};
+
+// 逻辑规范：
+// 前置条件 P: work 可以在子进程中独立运行，返回子进程中的测量结果
+// 后置条件 Q: 在子进程中运行 work，返回名为 name、输入为 bytes 字节的测量结果；峰值常驻内存取自子进程的资源统计，
+//   因此各次测量之间互不影响；子进程失败时抛出 runtime_error
+template<typename function>
+bench_result measure_in_child(const byte_array& name, sizevalue bytes, function work)
+{
+    int32 channel[2];
+    if (pipe(channel) != 0) {
+        throw std::runtime_error("无法创建管道");
+    }
+    pid_t child = fork();
+    if (child < 0) {
+        throw std::runtime_error("无法创建子进程");
+    }
+    if (child == 0) {
+        close(channel[0]);
+        child_report report = work();
+        bool written = write(channel[1], &report, sizeof(report)) == static_cast<ssize_t>(sizeof(report));
+        close(channel[1]);
+        _exit(written ? 0 : 1);
+    }
+    close(channel[1]);
+    child_report report{};
+    bool received = read(channel[0], &report, sizeof(report)) == static_cast<ssize_t>(sizeof(report));
+    close(channel[0]);
+    int32 status = 0;
+    rusage usage{};
+    wait4(child, &status, 0, &usage);
+    if (not received or not WIFEXITED(status) or WEXITSTATUS(status) != 0) {
+        throw std::runtime_error("子进程在运行 " + name + " 时失败");
+    }
+    // Linux 中 ru_maxrss 以 KiB 为单位
+    return { name, bytes, report.seconds, report.matches, static_cast<sizevalue>(usage.ru_maxrss), report.output_hash };
+}
+
+byte_array name_of_case(sizevalue bytes, float64 density, natmax seed)
+{
+    std::ostringstream name;
+    name << "exectute/density=" << density << "/seed=" << seed << "/" << bytes;
+    return name.str();
+}
+
+// 逻辑规范：
+// 前置条件 P: 0 < bytes <= MAX_CORPUS_BYTES
+// 后置条件 Q: 在子进程中生成输入并运行完整的 exectute()，返回测量结果；子进程失败时抛出 runtime_error
+bench_result run_in_child(sizevalue bytes, float64 density, natmax seed, const byte_array& save_directory)
+{
+    return measure_in_child(name_of_case(bytes, density, seed), bytes, [&]() -> child_report {
+        byte_array content = generate_corpus(bytes, density, seed);
+        if (not save_directory.empty()) {
+            std::ofstream(fs::path(save_directory) / (std::to_string(bytes) + ".cpp"), std::ios::binary) << content;
+        }
+        auto start = std::chrono::steady_clock::now();
+        sizevalue matches = exectute(content);
+        std::chrono::duration<float64> elapsed = std::chrono::steady_clock::now() - start;
+        if (not save_directory.empty()) {
+            std::ofstream(fs::path(save_directory) / (std::to_string(bytes) + ".lean"), std::ios::binary) << content;
+        }
+        return { elapsed.count(), matches, fnv1a_hash(content) };
+    });
+}
+
+// 逻辑规范：
+// 前置条件 P: 0 < bytes <= MAX_CORPUS_BYTES，directory 为可写的空目录
+// 后置条件 Q: 每个替换命令各用一个子进程，只运行这一个命令，返回各命令的测量结果 (名称为用例名后接命令名)；
+//   命令的输入是上一个命令的子进程写入 directory 的输出，因此每个命令的峰值常驻内存只包含它自己的输入、输出与工作空间。
+//   子进程失败时抛出 runtime_error
+vector<bench_result> run_commands_in_children(sizevalue bytes, float64 density, natmax seed, const fs::path& directory)
+{
+    vector<bench_result> results;
+    fs::path input;
+    sizevalue stage = 0;
+    for (const commmand_value& executable : current_executables()) {
+        if (executable.type != command_type::REPLACE_COMMAND) {
+            continue;
+        }
+        fs::path output = directory / ("stage-" + std::to_string(stage++));
+        sizevalue input_bytes = input.empty() ? bytes : fs::file_size(input);
+        byte_array name = name_of_case(bytes, density, seed) + "/" + variable_length(str(executable.ptr->name));
+        results.push_back(measure_in_child(name, input_bytes, [&]() -> child_report {
+            byte_array content;
+            if (input.empty()) {
+                content = generate_corpus(bytes, density, seed);
+            }
+            else {
+                std::ifstream in(input, std::ios::binary);
+                content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            }
+            commmand_value cmdv = executable;
+            sizevalue matches = 0;
+            auto start = std::chrono::steady_clock::now();
+            content = replace_content(std::move(content), cmdv, &matches);
+            std::chrono::duration<float64> elapsed = std::chrono::steady_clock::now() - start;
+            std::ofstream(output, std::ios::binary) << content;
+            return { elapsed.count(), matches, fnv1a_hash(content) };
+        }));
+        if (not input.empty()) {
+            fs::remove(input);
+        }
+        input = output;
+    }
+    if (not input.empty()) {
+        fs::remove(input);
+    }
+    return results;
+}
+
+float64 megabytes_per_second(const bench_result& result)
+{
+    return result.input_bytes / 1048576.0 / result.seconds;
+}
+
+byte_array hexadecimal(natmax value)
+{
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << value;
+    return out.str();
+}
+
+void write_json(std::ostream& out, const vector<bench_result>& results)
+{
+    // 每个结果独占一行，compare 模式按行读取
+    out << "{\n    \"benchmarks\": [\n";
+    for (sizevalue i = 0; i < results.size(); ++i) {
+        const bench_result& result = results[i];
+        out << "        {\"name\": \"" << result.name << "\", \"input_bytes\": " << result.input_bytes
+            << ", \"seconds\": " << std::setprecision(6) << result.seconds
+            << ", \"megabytes_per_second\": " << megabytes_per_second(result)
+            << ", \"matches\": " << result.matches
+            << ", \"matches_per_second\": " << result.matches / result.seconds
+            << ", \"peak_rss_kilobytes\": " << result.peak_rss_kilobytes
+            << ", \"output_hash\": \"" << hexadecimal(result.output_hash) << "\"}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "    ]\n}\n";
+}
+
+// 基线中一个用例的吞吐量与输出散列值
+struct baseline_entry
+{
+    float64 megabytes_per_second;
+    byte_array output_hash;
+};
+
+// 返回 line 中 "key": 之后的内容 (去掉字符串的引号)，不存在时返回空串
+byte_array field_of(const byte_array& line, const byte_array& key)
+{
+    byte_array prefix = "\"" + key + "\": ";
+    sizevalue position = line.find(prefix);
+    if (position == byte_array::npos) {
+        return {};
+    }
+    position += prefix.size();
+    if (line[position] == '"') {
+        ++position;
+        return line.substr(position, line.find('"', position) - position);
+    }
+    return line.substr(position, line.find_first_of(",}", position) - position);
+}
+
+// 读取由 write_json 写出的文件
+std::map<byte_array, baseline_entry> read_json(std::istream& in)
+{
+    std::map<byte_array, baseline_entry> baseline;
+    byte_array line;
+    while (std::getline(in, line)) {
+        byte_array name = field_of(line, "name");
+        byte_array throughput = field_of(line, "megabytes_per_second");
+        if (name.empty() or throughput.empty()) {
+            continue;
+        }
+        baseline[name] = { std::stod(throughput), field_of(line, "output_hash") };
+    }
+    return baseline;
+}
+
+// 返回输出不同或者吞吐量退化的用例数
+sizevalue compare(const vector<bench_result>& results, const std::map<byte_array, baseline_entry>& baseline, float64 threshold)
+{
+    sizevalue failures = 0;
+    std::cerr << std::left << std::setw(40) << "name" << std::right << std::setw(14) << "baseline MB/s" << std::setw(14) << "current MB/s" << std::setw(10) << "change" << "  output\n";
+    for (const bench_result& result : results) {
+        auto found = baseline.find(result.name);
+        if (found == baseline.end()) {
+            std::cerr << std::left << std::setw(40) << result.name << std::right << std::setw(14) << "-" << std::setw(14) << megabytes_per_second(result) << std::setw(10) << "new" << "\n";
+            continue;
+        }
+        float64 change = megabytes_per_second(result) / found->second.megabytes_per_second - 1.0;
+        bool regressed = change < -threshold;
+        bool identical = found->second.output_hash == hexadecimal(result.output_hash);
+        failures += regressed or not identical;
+        std::ostringstream percentage;
+        percentage << std::showpos << std::fixed << std::setprecision(1) << change * 100 << "%";
+        std::cerr << std::left << std::setw(40) << result.name << std::right << std::setw(14) << found->second.megabytes_per_second << std::setw(14) << megabytes_per_second(result)
+            << std::setw(10) << percentage.str() << (identical ? "  identical" : "  MISMATCH") << (regressed ? "  REGRESSION" : "") << "\n";
+    }
+    std::cerr << failures << " case(s) with different output or throughput regression over " << threshold * 100 << "%\n";
+    return failures;
+}
+
+// 解析 "1K,64K,1M" 形式的字节数列表，格式错误或者超出上限时抛出 invalid_argument
+vector<sizevalue> parse_sizes(const byte_array& text)
+{
+    vector<sizevalue> sizes;
+    std::istringstream in(text);
+    byte_array item;
+    while (std::getline(in, item, ',')) {
+        sizevalue multiplier = 1;
+        if (not item.empty() and (item.back() == 'K' or item.back() == 'k')) {
+            multiplier = 1024;
+            item.pop_back();
+        }
+        else if (not item.empty() and (item.back() == 'M' or item.back() == 'm')) {
+            multiplier = 1024 * 1024;
+            item.pop_back();
+        }
+        sizevalue bytes = std::stoull(item) * multiplier;
+        if (bytes == 0 or bytes > MAX_CORPUS_BYTES) {
+            throw std::invalid_argument("输入的字节数须在 1 与 100M 之间");
+        }
+        sizes.push_back(bytes);
+    }
+    return sizes;
+}
+
+int32 main(int32 argc, char** argv)
+{
+    vector<sizevalue> sizes = { 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024 };
+    float64 density = 0.2;
+    natmax seed = 1;
+    byte_array output_path;
+    byte_array baseline_path;
+    byte_array save_directory;
+    float64 threshold = 0.10;
+    bool per_command = true;
+    try {
+        for (int32 i = 1; i < argc; ++i) {
+            byte_array option = argv[i];
+            if (i + 1 >= argc) {
+                std::cerr << "选项 " << option << " 缺少参数\n";
+                return 2;
+            }
+            byte_array argument = argv[++i];
+            if (option == "--sizes") {
+                sizes = parse_sizes(argument);
+            }
+            else if (option == "--density") {
+                density = std::stod(argument);
+            }
+            else if (option == "--seed") {
+                seed = std::stoull(argument);
+            }
+            else if (option == "--output") {
+                output_path = argument;
+            }
+            else if (option == "--compare") {
+                baseline_path = argument;
+            }
+            else if (option == "--threshold") {
+                threshold = std::stod(argument);
+            }
+            else if (option == "--per-command") {
+                if (argument != "on" and argument != "off") {
+                    throw std::invalid_argument("--per-command 须为 on 或 off");
+                }
+                per_command = argument == "on";
+            }
+            else if (option == "--save-outputs") {
+                save_directory = argument;
+                fs::create_directories(save_directory);
+            }
+            else {
+                std::cerr << "未知的选项 " << option << "\n";
+                return 2;
+            }
+        }
+        if (density < 0 or density > 1) {
+            throw std::invalid_argument("--density 须在 0 与 1 之间");
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "参数错误: " << e.what() << "\n";
+        return 2;
+    }
+
+    vector<bench_result> results;
+    fs::path stage_directory = fs::temp_directory_path() / ("code-math-bench-" + std::to_string(getpid()));
+    try {
+        fs::create_directories(stage_directory);
+        for (sizevalue bytes : sizes) {
+            sizevalue first = results.size();
+            results.push_back(run_in_child(bytes, density, seed, save_directory));
+            if (per_command) {
+                vector<bench_result> commands = run_commands_in_children(bytes, density, seed, stage_directory);
+                results.insert(results.end(), commands.begin(), commands.end());
+            }
+            for (sizevalue i = first; i < results.size(); ++i) {
+                const bench_result& result = results[i];
+                std::cerr << result.name << ": " << megabytes_per_second(result) << " MB/s, " << result.matches / result.seconds << " matches/s, peak RSS " << result.peak_rss_kilobytes << " KiB\n";
+            }
+        }
+        fs::remove_all(stage_directory);
+    }
+    catch (const std::exception& e) {
+        std::error_code ignored;
+        fs::remove_all(stage_directory, ignored);
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
+
+    if (output_path.empty()) {
+        write_json(std::cout, results);
+    }
+    else {
+        std::ofstream out(output_path);
+        write_json(out, results);
+        if (not out) {
+            std::cerr << "无法写入 " << output_path << "\n";
+            return 2;
+        }
+    }
+
+    if (not baseline_path.empty()) {
+        std::ifstream in(baseline_path);
+        if (not in) {
+            std::cerr << "无法读取基线 " << baseline_path << "\n";
+            return 2;
+        }
+        return compare(results, read_json(in), threshold) == 0 ? 0 : 1;
+    }
+    return 0;
+}
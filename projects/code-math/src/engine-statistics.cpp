@@ -0,0 +1,98 @@
+#include <engine-statistics>
+#include <algorithm>
+#include <iomanip>
+
+using std::vector;
+using std::pair;
+
+engine_statistics* active_statistics = nullptr;
+
+void statistics_timer::stop()
+{
+    if (seconds == nullptr) {
+        return;
+    }
+    auto finish = engine_statistics::clock::now();
+    *seconds += std::chrono::duration<float64>(finish - start).count();
+    seconds = nullptr;
+    if (active_statistics != nullptr and active_statistics->record_trace) {
+        float64 start_microseconds = active_statistics->microseconds_since_origin(start);
+        active_statistics->events.push_back({ name, category, depth, start_microseconds, active_statistics->microseconds_since_origin(finish) - start_microseconds });
+    }
+}
+
+// 转义 JSON 字符串中的引号、反斜杠与控制字符
+static byte_array escape_json(const byte_array& text)
+{
+    byte_array result;
+    result.reserve(text.size());
+    for (char c : text) {
+        if (c == '"' or c == '\\') {
+            result += '\\';
+            result += c;
+        }
+        else if (static_cast<nat8>(c) < 0x20) {
+            static const char* digits = "0123456789abcdef";
+            result += "\\u00";
+            result += digits[static_cast<nat8>(c) >> 4];
+            result += digits[static_cast<nat8>(c) & 0xF];
+        }
+        else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+void engine_statistics::write_table(std::ostream& out) const
+{
+    vector<const pair<const pair<byte_array, sizevalue>, command_statistics>*> rows;
+    for (const auto& entry : commands) {
+        rows.push_back(&entry);
+    }
+    std::stable_sort(rows.begin(), rows.end(), [](auto left, auto right) { return left->second.total_seconds > right->second.total_seconds; });
+
+    sizevalue name_width = 7;
+    for (auto row : rows) {
+        name_width = std::max(name_width, row->first.first.size());
+    }
+    out << std::left << std::setw(name_width + 2) << "command" << std::right << std::setw(6) << "depth" << std::setw(10) << "calls"
+        << std::setw(12) << "total ms" << std::setw(12) << "compile ms" << std::setw(12) << "match ms"
+        << std::setw(10) << "matches" << std::setw(12) << "bytes" << std::setw(10) << "nested" << "\n";
+    out << std::fixed << std::setprecision(3);
+    for (auto row : rows) {
+        const command_statistics& statistics = row->second;
+        out << std::left << std::setw(name_width + 2) << row->first.first << std::right << std::setw(6) << row->first.second << std::setw(10) << statistics.calls
+            << std::setw(12) << statistics.total_seconds * 1e3 << std::setw(12) << statistics.compile_seconds * 1e3 << std::setw(12) << statistics.match_seconds * 1e3
+            << std::setw(10) << statistics.matches << std::setw(12) << statistics.bytes_rewritten << std::setw(10) << statistics.sub_replacements << "\n";
+    }
+    out << std::defaultfloat;
+}
+
+void engine_statistics::write_json(std::ostream& out) const
+{
+    out << "{\n    \"commands\": [\n";
+    sizevalue index = 0;
+    for (const auto& [key, statistics] : commands) {
+        out << "        {\"name\": \"" << escape_json(key.first) << "\", \"depth\": " << key.second << ", \"calls\": " << statistics.calls
+            << ", \"total_seconds\": " << statistics.total_seconds << ", \"compile_seconds\": " << statistics.compile_seconds
+            << ", \"match_seconds\": " << statistics.match_seconds << ", \"matches\": " << statistics.matches
+            << ", \"bytes_rewritten\": " << statistics.bytes_rewritten << ", \"sub_replacements\": " << statistics.sub_replacements << "}"
+            << (++index < commands.size() ? "," : "") << "\n";
+    }
+    out << "    ]\n}\n";
+}
+
+void engine_statistics::write_chrome_trace(std::ostream& out) const
+{
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    out << std::fixed << std::setprecision(3);
+    for (sizevalue i = 0; i < events.size(); ++i) {
+        const trace_event& event = events[i];
+        out << "{\"name\": \"" << escape_json(event.name) << "\", \"cat\": \"" << escape_json(event.category) << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1"
+            << ", \"ts\": " << event.start_microseconds << ", \"dur\": " << event.duration_microseconds
+            << ", \"args\": {\"depth\": " << event.depth << "}}" << (i + 1 < events.size() ? "," : "") << "\n";
+    }
+    out << "]}\n";
+    out << std::defaultfloat;
+}
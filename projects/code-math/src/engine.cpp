@@ -0,0 +1,443 @@
+#include <basic>
+#include <engine>
+#include <engine-statistics>
+#include <literal-prefilter>
+#include <replacement-template>
+#include <runtime-exception>
+#include <context>
+#include <symbol-table>
+#include <string_view>
+#include <regex>
+#include <map>
+#include <utility>
+
+using std::vector;
+using std::pair;
+
+// 根据读入的文件内容，以及 context 中的 executable_list 执行命令
+sizevalue exectute(byte_array& content)
+{
+    sizevalue total_replacements = 0;
+    for (auto& cmdv : executable_list) {
+        switch (cmdv.type) {
+        case command_type::REPLACE_COMMAND: {
+            sizevalue number_of_replacements = 0;
+            content = replace_content(content, cmdv, &number_of_replacements);
+            total_replacements += number_of_replacements;
+            break;
+        }
+        case command_type::DEFINE_COMMAND:
+            break;
+        }
+    }
+    return total_replacements;
+}
+
+byte_array set_capture_of(byte_array s, pair<sizevalue, sizevalue>& position);
+byte_array expand_number_of_target(byte_array& content, vector<pair<sizevalue, sizevalue>>& captures, byte_array& target);
+byte_array disable_all_captures(const byte_array& pattern);
+byte_array expand_symbol_of_target(byte_array& target);
+byte_array expand_symbol_once_of_target(byte_array& target);
+
+// 进行匹配过程，结果反映在 matches 和 captures 中
+void process_match(vector<pair<sizevalue, sizevalue>>& matches, vector<vector<pair<sizevalue, sizevalue>>>& captures, std::sregex_iterator begin, std::sregex_iterator end)
+{
+    for (auto it = begin; it != end; ++it) {
+        const std::smatch& match = *it;
+        
+        // 主匹配
+        sizevalue pos = match.position();
+        sizevalue length = match.length();
+        matches.emplace_back(pos, length);
+        
+        // 处理捕获组
+        vector<pair<sizevalue, sizevalue>> match_captures;
+        for (sizevalue i = 1; i < match.size(); ++i) {  // i=0是整个匹配
+            if (match[i].matched) {
+                match_captures.emplace_back(match.position(i), match.length(i));
+            } else {
+                match_captures.emplace_back(byte_array::npos, 0);  // 未匹配的捕获组
+            }
+        }
+        captures.push_back(std::move(match_captures));
+    }
+}
+
+// 各个命令编译后的形式，键为命令的地址
+static std::map<const command*, compiled_command> compiled_commands;
+
+compiled_command& compile_command(const commmand_value& cmdv)
+{
+    auto found = compiled_commands.find(cmdv.ptr.get());
+    if (found != compiled_commands.end()) {
+        return found->second;
+    }
+    compiled_command compiled;
+    compiled.expanded_pattern = expand_symbol_of_target(cmdv.ptr->pattern);
+    compiled.sub_pattern = disable_all_captures(expand_symbol_once_of_target(cmdv.ptr->pattern));
+    compiled.prefilter = analyse_pattern(compiled.expanded_pattern);
+    if (cmdv.type == command_type::REPLACE_COMMAND) {
+        // target 中的 "@名称#" 在编译时展开；展开失败时保留逐个匹配展开的做法，以便在替换时报告同样的错误
+        compiled.target = split_replacement_template(static_cast<replace_command*>(cmdv.ptr.get())->target);
+        try {
+            for (auto& segment : compiled.target.segments) {
+                if (compiled.target.precompiled and segment.capture == 0) {
+                    segment.literal = expand_symbol_of_target(segment.literal);
+                }
+            }
+        }
+        catch (const std::exception&) {
+            compiled.target.precompiled = false;
+        }
+    }
+    return compiled_commands.emplace(cmdv.ptr.get(), std::move(compiled)).first->second;
+}
+
+void provide_compiled_command(const commmand_value& cmdv, compiled_command&& compiled)
+{
+    compiled_commands.insert_or_assign(cmdv.ptr.get(), std::move(compiled));
+}
+
+// 以名称的符号编号为下标的命令表，由 buffer 生成，install_rules 之后重新生成
+static vector<commmand_value*> commands_by_symbol;
+static bool commands_by_symbol_valid = false;
+
+// 返回名称为 name 的命令，不存在时返回 nullptr；查找时不构造 str，也不比较字符串
+static commmand_value* command_named(std::string_view name)
+{
+    if (not commands_by_symbol_valid) {
+        commands_by_symbol.clear();
+        for (auto& [key, cmdv] : buffer) {
+            symbol id = global_symbol_table().intern(str_view(key));
+            if (id >= commands_by_symbol.size()) {
+                commands_by_symbol.resize(id + 1, nullptr);
+            }
+            commands_by_symbol[id] = &cmdv;
+        }
+        commands_by_symbol_valid = true;
+    }
+    symbol id = global_symbol_table().find(name);
+    return id < commands_by_symbol.size() ? commands_by_symbol[id] : nullptr;
+}
+
+void install_rules(std::map<str, commmand_value>&& commands, std::vector<commmand_value>&& executables)
+{
+    compiled_commands.clear();
+    commands_by_symbol_valid = false;
+    buffer = std::move(commands);
+    executable_list = std::move(executables);
+}
+
+const std::map<str, commmand_value>& current_commands() noexcept
+{
+    return buffer;
+}
+
+const std::vector<commmand_value>& current_executables() noexcept
+{
+    return executable_list;
+}
+
+// replace_content 当前的递归深度，顶层为0
+static sizevalue replacement_depth = 0;
+
+// 在作用域内把 replacement_depth 加一，异常退出时同样恢复
+struct replacement_depth_guard
+{
+    replacement_depth_guard() noexcept { ++replacement_depth; }
+    ~replacement_depth_guard() { --replacement_depth; }
+};
+
+// 匹配 "@名称#" 的正则表达式，第一个捕获组为名称
+static const std::regex& symbol_expression()
+{
+    static const std::regex expression(R"(@([a-zA-Z_][a-zA-Z0-9_]*)#)");
+    return expression;
+}
+
+// 按出现的顺序返回 sub_pattern 中的各个 "@名称#"，名称未定义时抛出 runtime_error
+static vector<sub_symbol> compile_sub_symbols(const byte_array& sub_pattern)
+{
+    vector<pair<sizevalue, sizevalue>> matches;
+    vector<vector<pair<sizevalue, sizevalue>>> captures;
+    process_match(matches, captures, std::sregex_iterator(sub_pattern.begin(), sub_pattern.end(), symbol_expression()), std::sregex_iterator());
+    vector<sub_symbol> result;
+    result.reserve(captures.size());
+    for (auto& capture : captures) {
+        commmand_value* named = command_named(std::string_view(sub_pattern).substr(capture[0].first, capture[0].second));
+        runtime_assert(named != nullptr, "在展开\"" + sub_pattern + "\"的\"" + sub_pattern.substr(capture[0].first, capture[0].second) + "\"时，未发现存在对应的定义！");
+        byte_array temp_pattern = set_capture_of(sub_pattern, capture[0]);
+        result.push_back({ named, std::regex(expand_symbol_of_target(temp_pattern)) });
+    }
+    return result;
+}
+
+// 替换命令的执行；known_matches 与 known_captures 非空时为调用者已经找到的全部匹配，不再查找
+static byte_array replace_content(byte_array content, commmand_value& cmdv, sizevalue* number_of_replacements,
+    vector<pair<sizevalue, sizevalue>>* known_matches, vector<vector<pair<sizevalue, sizevalue>>>* known_captures)
+{ 
+    // 统计开启时取得本命令在当前深度上的记录，std::map 的元素地址在插入后保持不变
+    command_statistics* statistics = nullptr;
+    const char* statistics_name = nullptr;
+    sizevalue depth = replacement_depth;
+    if (active_statistics != nullptr) {
+        auto& entry = *active_statistics->commands.try_emplace({ variable_length(str(cmdv.ptr->name)), depth }).first;
+        statistics = &entry.second;
+        statistics_name = entry.first.first.c_str();
+        ++statistics->calls;
+    }
+    statistics_timer call_timer(statistics != nullptr ? &statistics->total_seconds : nullptr, statistics_name, "command", depth);
+    replacement_depth_guard depth_guard;
+
+    // 查找所有匹配
+    statistics_timer compile_timer(statistics != nullptr ? &statistics->compile_seconds : nullptr, "compile", "regex", depth);
+    compiled_command& compiled = compile_command(cmdv);
+    if (not compiled.expression.has_value()) {
+        compiled.expression.emplace(compiled.expanded_pattern);
+    }
+    if (not compiled.sub_symbols.has_value()) {
+        compiled.sub_symbols = compile_sub_symbols(compiled.sub_pattern);
+    }
+    compile_timer.stop();
+    
+    vector<pair<sizevalue, sizevalue>> matches;  // 位置和长度
+    vector<vector<pair<sizevalue, sizevalue>>> captures;  // 每个匹配的捕获组
+    
+    // 先查找模式必须包含的字面量，只在其附近运行正则表达式
+    statistics_timer match_timer(statistics != nullptr ? &statistics->match_seconds : nullptr, "match", "regex", depth);
+    if (known_matches != nullptr) {
+        matches = std::move(*known_matches);
+        captures = std::move(*known_captures);
+    }
+    else {
+        find_matches(content, *compiled.expression, compiled.prefilter, matches, captures);
+    }
+    match_timer.stop();
+    if (statistics != nullptr) {
+        statistics->matches += matches.size();
+    }
+    
+    // 进行逐层子替换
+    const vector<sub_symbol>& sub_symbols = *compiled.sub_symbols;
+    auto old_matches = std::move(matches);
+    auto old_captures = std::move(captures);
+
+    // 最外层循环，遍历单层展开的 pattern 中的变量
+    for (sizevalue i = sub_symbols.size() - 1; i != sizevalue_max; --i) {
+        commmand_value& named = *sub_symbols[i].named;
+        const std::regex& temp_re = sub_symbols[i].expression;
+        // 内层循环，遍历 content 中的每个匹配的子字符串
+        for (sizevalue j = old_matches.size() - 1; j != sizevalue_max; --j) {
+            vector<pair<sizevalue, sizevalue>> temp_matches;  // 位置和长度
+            vector<vector<pair<sizevalue, sizevalue>>> temp_captures;  // 每个匹配的捕获组
+            byte_array temp_content = content.substr(old_matches[j].first, old_matches[j].second); // 子字符串
+            auto temp_begin = std::sregex_iterator(temp_content.begin(), temp_content.end(), temp_re);
+            auto temp_end = std::sregex_iterator();
+            process_match(temp_matches, temp_captures, temp_begin, temp_end);
+            // 进行子替换
+            if (statistics != nullptr) {
+                ++statistics->sub_replacements;
+            }
+            auto replacement = replace_content(content.substr(old_matches[j].first + temp_captures[0][0].first, temp_captures[0][0].second), named);
+            content.replace(old_matches[j].first + temp_captures[0][0].first, temp_captures[0][0].second, replacement);
+            // 更新索引
+            old_matches[j].second += replacement.size() - temp_captures[0][0].second;
+            old_captures[j][i].second += replacement.size() - temp_captures[0][0].second;
+            for (sizevalue k = i + 1; k < old_captures[j].size(); ++k) {
+                old_captures[j][k].first += replacement.size() - temp_captures[0][0].second;
+            }
+            for (sizevalue k = j + 1; k < old_matches.size(); ++k) {
+                old_matches[k].first += replacement.size() - temp_captures[0][0].second;
+                for (auto& old_capture : old_captures[k]) {
+                    old_capture.first += replacement.size() - temp_captures[0][0].second;
+                }
+            }
+        }
+    }
+
+    // 如果是替换指令，进行替换
+    if (cmdv.type == command_type::REPLACE_COMMAND) {
+        replace_command& cmd = *static_cast<replace_command*>(cmdv.ptr.get());
+        // 进行替换：依次把匹配之间的内容与展开后的模板追加到新的内容中
+        if (not old_matches.empty()) {
+            const replacement_template& compiled_target = compiled.target;
+            byte_array replaced_content;
+            replaced_content.reserve(content.size());
+            sizevalue copied = 0;
+            for (sizevalue i = 0; i < old_matches.size(); ++i) {
+                auto& match = old_matches[i];
+                replaced_content.append(content, copied, match.first - copied);
+                sizevalue length_before = replaced_content.size();
+                if (not compiled_target.precompiled or not append_replacement(compiled_target, content, old_captures[i], replaced_content)) {
+                    replaced_content += expand_target(content, old_captures[i], cmd.target);
+                }
+                if (statistics != nullptr) {
+                    statistics->bytes_rewritten += replaced_content.size() - length_before;
+                }
+                copied = match.first + match.second;
+            }
+            replaced_content.append(content, copied);
+            content = std::move(replaced_content);
+        }
+        if (number_of_replacements != nullptr) {
+            *number_of_replacements = old_matches.size();
+        }
+    }
+
+    return std::move(content);
+}
+
+byte_array replace_content(byte_array content, commmand_value& cmdv, sizevalue* number_of_replacements)
+{
+    return replace_content(std::move(content), cmdv, number_of_replacements, nullptr, nullptr);
+}
+
+byte_array replace_matches(byte_array content, commmand_value& cmdv, vector<pair<sizevalue, sizevalue>>&& matches,
+    vector<vector<pair<sizevalue, sizevalue>>>&& captures, sizevalue* number_of_replacements)
+{
+    return replace_content(std::move(content), cmdv, number_of_replacements, &matches, &captures);
+}
+
+// 为 s 中名称位于 position 处的变量添加捕获修饰 (若之前没有)
+byte_array set_capture_of(byte_array s, pair<sizevalue, sizevalue>& position)
+{
+    byte_array result = s;
+    result.insert(position.first + position.second + 2, ")");
+    result.insert(position.first - 1, "(");
+    return std::move(result);
+}
+
+// 展开 replace_command::target 中的 "@...#" 内容
+byte_array expand_target(byte_array& content, vector<pair<sizevalue, sizevalue>>& captures, byte_array& target)
+{
+    byte_array expanded_target = expand_number_of_target(content, captures, target);
+    expanded_target = expand_symbol_of_target(expanded_target);
+    return std::move(expanded_target);
+}
+
+// 展开 replace_command::target 中的 "@\d+#" 内容
+byte_array expand_number_of_target(byte_array& content, vector<pair<sizevalue, sizevalue>>& captures, byte_array& target)
+{
+    byte_array expanded_target = target;
+    std::regex re(R"(@(\d+)#)");
+    vector<pair<sizevalue, sizevalue>> matches;  // 位置和长度
+    vector<vector<pair<sizevalue, sizevalue>>> number_captures;  // 每个匹配的捕获组
+    
+    auto begin = std::sregex_iterator(expanded_target.begin(), expanded_target.end(), re);
+    auto end = std::sregex_iterator();
+    
+    process_match(matches, number_captures, begin, end);
+
+    for (sizevalue i = matches.size() - 1; i != sizevalue_max; --i) {
+        auto& match = matches[i];
+        sizevalue number = 0;
+        try {
+            number = std::stoll(expanded_target.substr(number_captures[i][0].first, number_captures[i][0].second));
+        }
+        catch (std::exception& e) {
+            link_error(e, "在展开\"" + target + "\"的\"" + expanded_target.substr(match.first, match.second) + "\"时，其中的数字过大！(大于sizevalue_max)");
+        }
+        runtime_assert(number - 1 < captures.size(), "在展开\"" + target + "\"的\"" + expanded_target.substr(match.first, match.second) + "\"时，未发现存在对应的捕获组！");
+        expanded_target.replace(match.first, match.second, content.substr(captures[number - 1].first, captures[number - 1].second));
+    }
+
+    return std::move(expanded_target);
+}
+
+// 将 pattern 中的所有捕获组改成非捕获组
+byte_array disable_all_captures(const byte_array& pattern)
+{
+    byte_array result;
+    result.reserve(pattern.length() + 20); // 预分配空间
+    
+    for (size_t i = 0; i < pattern.length(); ++i) {
+        if (pattern[i] == '(') {
+            // 检查前一个字符是否是反斜杠（转义情况）
+            if (i > 0 && pattern[i-1] == '\\') {
+                result += pattern[i];
+                continue;
+            }
+            
+            // 检查是否已经是特殊语法
+            if (i + 1 < pattern.length()) {
+                if (pattern[i+1] == '?') {
+                    // 已经是 (?:, (?=, (?!, (?<=, (?<! 等
+                    result += pattern[i];
+                    result += pattern[i+1];
+                    i++;
+                    if (i + 1 < pattern.length() && pattern[i+1] == ':') {
+                        result += pattern[++i]; // 非捕获组，保留
+                    } else {
+                        // 其他 (? 语法，保持原样
+                        continue;
+                    }
+                } else {
+                    // 普通捕获组，转换为非捕获组
+                    result += "(?:";
+                }
+            } else {
+                result += "(?:";
+            }
+        } else {
+            result += pattern[i];
+        }
+    }
+    
+    return result;
+}
+
+// 展开 target 中的 "@{var}#" 内容直到无法展开，其中 var 指代任意定义名标识符
+byte_array expand_symbol_of_target(byte_array& target)
+{
+    byte_array expanded_target = target;
+    const std::regex& re = symbol_expression();
+    vector<pair<sizevalue, sizevalue>> matches;  // 位置和长度
+    vector<vector<pair<sizevalue, sizevalue>>> symbol_captures;  // 每个匹配的捕获组
+
+    auto begin = std::sregex_iterator(expanded_target.begin(), expanded_target.end(), re);
+    auto end = std::sregex_iterator();
+    
+    process_match(matches, symbol_captures, begin, end);
+
+    // 展开内容
+    for (sizevalue i = matches.size() - 1; i != sizevalue_max; --i) {
+        auto& match = matches[i];
+        commmand_value* named = command_named(std::string_view(expanded_target).substr(symbol_captures[i][0].first, symbol_captures[i][0].second));
+        runtime_assert(named != nullptr, "在展开\"" + target + "\"的\"" + expanded_target.substr(match.first, match.second) + "\"时，未发现存在对应的定义！");
+        auto& cmdv = *named;
+        // 如果是定义指令或者替换指令，直接全部展开
+        if (cmdv.type == command_type::DEFINE_COMMAND || cmdv.type == command_type::REPLACE_COMMAND) {
+            expanded_target.replace(match.first, match.second, disable_all_captures(expand_symbol_of_target(static_cast<define_command*>(cmdv.ptr.get())->pattern)));
+        }
+    }
+
+    return std::move(expanded_target);
+}
+
+// 展开 target 中的 "@{var}#" 内容中的顶层，其中 var 指代任意定义名标识符
+byte_array expand_symbol_once_of_target(byte_array& target)
+{
+    byte_array expanded_target = target;
+    const std::regex& re = symbol_expression();
+    vector<pair<sizevalue, sizevalue>> matches;  // 位置和长度
+    vector<vector<pair<sizevalue, sizevalue>>> symbol_captures;  // 每个匹配的捕获组
+
+    auto begin = std::sregex_iterator(expanded_target.begin(), expanded_target.end(), re);
+    auto end = std::sregex_iterator();
+    
+    process_match(matches, symbol_captures, begin, end);
+
+    // 展开内容
+    for (sizevalue i = matches.size() - 1; i != sizevalue_max; --i) {
+        auto& match = matches[i];
+        commmand_value* named = command_named(std::string_view(expanded_target).substr(symbol_captures[i][0].first, symbol_captures[i][0].second));
+        runtime_assert(named != nullptr, "在展开\"" + target + "\"的\"" + expanded_target.substr(match.first, match.second) + "\"时，未发现存在对应的定义！");
+        auto& cmdv = *named;
+        // 如果是定义指令或者替换指令，展开一层
+        if (cmdv.type == command_type::DEFINE_COMMAND || cmdv.type == command_type::REPLACE_COMMAND) {
+            expanded_target.replace(match.first, match.second, disable_all_captures(static_cast<define_command*>(cmdv.ptr.get())->pattern));
+        }
+    }
+
+    return std::move(expanded_target);
+}
\ No newline at end of file
@@ -0,0 +1,352 @@
+#include <literal-prefilter>
+#include <algorithm>
+#include <cctype>
+
+using std::vector;
+using std::pair;
+
+// 模式中的一个原子 (含其量词)
+struct pattern_atom
+{
+    sizevalue min_width = 0;
+    sizevalue max_width = 0;
+    bool is_literal = false; // 不带量词的单个字面字符
+    char literal = 0;
+};
+
+static sizevalue add_width(sizevalue left, sizevalue right) noexcept
+{
+    return left == UNBOUNDED_WIDTH or right == UNBOUNDED_WIDTH ? UNBOUNDED_WIDTH : left + right;
+}
+
+static sizevalue multiply_width(sizevalue width, sizevalue count) noexcept
+{
+    if (width == 0 or count == 0) {
+        return 0;
+    }
+    return width == UNBOUNDED_WIDTH or count == UNBOUNDED_WIDTH ? UNBOUNDED_WIDTH : width * count;
+}
+
+static bool parse_atom(const byte_array& pattern, sizevalue& i, pattern_atom& atom, bool& context_dependent);
+
+// 逻辑规范：
+// 前置条件 P: i <= pattern.size()
+// 后置条件 Q: 解析从 i 起直到未配对的 ')' 或结尾的各个选择分支，branches 中依次为每个分支的原子序列，i 停在 ')' 或结尾处；
+//   遇到无法识别的语法时返回 false
+static bool parse_branches(const byte_array& pattern, sizevalue& i, vector<vector<pattern_atom>>& branches, bool& context_dependent)
+{
+    branches.emplace_back();
+    while (i < pattern.size() and pattern[i] != ')') {
+        if (pattern[i] == '|') {
+            ++i;
+            branches.emplace_back();
+            continue;
+        }
+        pattern_atom atom;
+        if (not parse_atom(pattern, i, atom, context_dependent)) {
+            return false;
+        }
+        branches.back().push_back(atom);
+    }
+    return true;
+}
+
+// 解析 i 处的量词 ("*", "+", "?", "{n}", "{n,}", "{n,m}"，可以带有表示非贪婪的 "?")，没有量词时 least = most = 1
+static bool parse_quantifier(const byte_array& pattern, sizevalue& i, sizevalue& least, sizevalue& most)
+{
+    least = most = 1;
+    if (i >= pattern.size()) {
+        return true;
+    }
+    switch (pattern[i]) {
+    case '*':
+        least = 0;
+        most = UNBOUNDED_WIDTH;
+        ++i;
+        break;
+    case '+':
+        most = UNBOUNDED_WIDTH;
+        ++i;
+        break;
+    case '?':
+        least = 0;
+        ++i;
+        break;
+    case '{': {
+        sizevalue close = pattern.find('}', i);
+        if (close == byte_array::npos) {
+            return false;
+        }
+        byte_array bounds = pattern.substr(i + 1, close - i - 1);
+        sizevalue comma = bounds.find(',');
+        try {
+            least = std::stoull(bounds.substr(0, comma));
+            most = comma == byte_array::npos ? least : comma + 1 == bounds.size() ? UNBOUNDED_WIDTH : std::stoull(bounds.substr(comma + 1));
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+        i = close + 1;
+        break;
+    }
+    default:
+        return true;
+    }
+    if (i < pattern.size() and pattern[i] == '?') {
+        ++i;
+    }
+    return true;
+}
+
+// 逻辑规范：
+// 前置条件 P: i < pattern.size() 且 pattern[i] 不是 ')' 或 '|'
+// 后置条件 Q: 解析 i 处的一个原子及其量词，i 移到其后；原子含有依赖上下文的断言或反向引用时 context_dependent <- true；
+//   遇到无法识别的语法时返回 false
+static bool parse_atom(const byte_array& pattern, sizevalue& i, pattern_atom& atom, bool& context_dependent)
+{
+    atom = { 1, 1, false, 0 };
+    char c = pattern[i++];
+    switch (c) {
+    case '^':
+    case '$':
+        context_dependent = true;
+        atom.min_width = atom.max_width = 0;
+        break;
+    case '.':
+        break;
+    case '[':
+        // 字符类中的内容不影响长度，只需找到结束的 ']'
+        if (i < pattern.size() and pattern[i] == '^') {
+            ++i;
+        }
+        while (i < pattern.size() and pattern[i] != ']') {
+            i += pattern[i] == '\\' ? 2 : 1;
+        }
+        if (i >= pattern.size()) {
+            return false;
+        }
+        ++i;
+        break;
+    case '(': {
+        bool lookahead = false;
+        if (pattern.compare(i, 2, "?:") == 0) {
+            i += 2;
+        }
+        else if (pattern.compare(i, 2, "?=") == 0 or pattern.compare(i, 2, "?!") == 0) {
+            i += 2;
+            lookahead = true;
+            context_dependent = true;
+        }
+        else if (i < pattern.size() and pattern[i] == '?') {
+            return false;
+        }
+        vector<vector<pattern_atom>> branches;
+        if (not parse_branches(pattern, i, branches, context_dependent) or i >= pattern.size()) {
+            return false;
+        }
+        ++i;
+        atom.min_width = UNBOUNDED_WIDTH;
+        atom.max_width = 0;
+        for (const auto& branch : branches) {
+            sizevalue least = 0, most = 0;
+            for (const auto& inner : branch) {
+                least = add_width(least, inner.min_width);
+                most = add_width(most, inner.max_width);
+            }
+            atom.min_width = std::min(atom.min_width, least);
+            atom.max_width = std::max(atom.max_width, most);
+        }
+        if (lookahead) {
+            atom.min_width = atom.max_width = 0;
+        }
+        break;
+    }
+    case '\\': {
+        if (i >= pattern.size()) {
+            return false;
+        }
+        char escaped = pattern[i++];
+        if (escaped == 'b' or escaped == 'B') {
+            context_dependent = true;
+            atom.min_width = atom.max_width = 0;
+        }
+        else if ('1' <= escaped and escaped <= '9') {
+            // 反向引用的长度取决于被引用的捕获组
+            while (i < pattern.size() and '0' <= pattern[i] and pattern[i] <= '9') {
+                ++i;
+            }
+            context_dependent = true;
+            atom.min_width = 0;
+            atom.max_width = UNBOUNDED_WIDTH;
+        }
+        else if (byte_array("dDwWsS").find(escaped) != byte_array::npos) {
+        }
+        else if (escaped == 'x' or escaped == 'u' or escaped == 'c') {
+            i += escaped == 'x' ? 2 : escaped == 'u' ? 4 : 1;
+        }
+        else if (byte_array("nrtfv0").find(escaped) != byte_array::npos) {
+            static const char control_characters[] = { '\n', '\r', '\t', '\f', '\v', '\0' };
+            atom.is_literal = true;
+            atom.literal = control_characters[byte_array("nrtfv0").find(escaped)];
+        }
+        else if (std::isalnum(static_cast<nat8>(escaped))) {
+            return false;
+        }
+        else {
+            atom.is_literal = true;
+            atom.literal = escaped;
+        }
+        break;
+    }
+    case ')':
+    case '|':
+    case '*':
+    case '+':
+    case '?':
+    case '{':
+        return false;
+    default:
+        atom.is_literal = true;
+        atom.literal = c;
+        break;
+    }
+    sizevalue least = 1, most = 1;
+    sizevalue start_of_quantifier = i;
+    if (not parse_quantifier(pattern, i, least, most)) {
+        return false;
+    }
+    if (i != start_of_quantifier) {
+        atom.is_literal = false;
+        atom.min_width = multiply_width(atom.min_width, least);
+        atom.max_width = multiply_width(atom.max_width, most);
+    }
+    return true;
+}
+
+literal_prefilter analyse_pattern(const byte_array& pattern)
+{
+    vector<vector<pattern_atom>> branches;
+    sizevalue i = 0;
+    bool context_dependent = false;
+    if (not parse_branches(pattern, i, branches, context_dependent) or i != pattern.size() or branches.size() != 1) {
+        return {};
+    }
+    // 顶层连续的字面字符中最长的一段是每个匹配都包含的字面量
+    const vector<pattern_atom>& atoms = branches.front();
+    sizevalue best_start = 0, best_length = 0;
+    for (sizevalue start = 0; start < atoms.size();) {
+        if (not atoms[start].is_literal) {
+            ++start;
+            continue;
+        }
+        sizevalue end = start;
+        while (end < atoms.size() and atoms[end].is_literal) {
+            ++end;
+        }
+        if (end - start > best_length) {
+            best_start = start;
+            best_length = end - start;
+        }
+        start = end;
+    }
+    if (best_length == 0) {
+        return {};
+    }
+    literal_prefilter prefilter;
+    prefilter.max_width_before = 0;
+    prefilter.max_width_after = 0;
+    for (sizevalue j = 0; j < atoms.size(); ++j) {
+        if (j < best_start) {
+            prefilter.max_width_before = add_width(prefilter.max_width_before, atoms[j].max_width);
+        }
+        else if (j < best_start + best_length) {
+            prefilter.literal += atoms[j].literal;
+        }
+        else {
+            prefilter.max_width_after = add_width(prefilter.max_width_after, atoms[j].max_width);
+        }
+    }
+    prefilter.windowed = not context_dependent and prefilter.max_width_before != UNBOUNDED_WIDTH and prefilter.max_width_after != UNBOUNDED_WIDTH;
+    return prefilter;
+}
+
+bool match_width_bounds(const byte_array& pattern, sizevalue& least, sizevalue& most)
+{
+    vector<vector<pattern_atom>> branches;
+    sizevalue i = 0;
+    bool context_dependent = false;
+    if (not parse_branches(pattern, i, branches, context_dependent) or i != pattern.size() or context_dependent) {
+        return false;
+    }
+    least = UNBOUNDED_WIDTH;
+    most = 0;
+    for (const auto& branch : branches) {
+        sizevalue branch_least = 0, branch_most = 0;
+        for (const auto& atom : branch) {
+            branch_least = add_width(branch_least, atom.min_width);
+            branch_most = add_width(branch_most, atom.max_width);
+        }
+        least = std::min(least, branch_least);
+        most = std::max(most, branch_most);
+    }
+    return true;
+}
+
+// 记录 match 中的匹配与捕获组，位置加上 offset
+static void record_match(const std::smatch& match, sizevalue offset, vector<pair<sizevalue, sizevalue>>& matches, vector<vector<pair<sizevalue, sizevalue>>>& captures)
+{
+    matches.emplace_back(offset + match.position(), match.length());
+    vector<pair<sizevalue, sizevalue>> match_captures;
+    for (sizevalue i = 1; i < match.size(); ++i) {
+        if (match[i].matched) {
+            match_captures.emplace_back(offset + match.position(i), match.length(i));
+        }
+        else {
+            match_captures.emplace_back(byte_array::npos, 0);
+        }
+    }
+    captures.push_back(std::move(match_captures));
+}
+
+void find_matches(const byte_array& content, const std::regex& re, const literal_prefilter& prefilter, vector<pair<sizevalue, sizevalue>>& matches, vector<vector<pair<sizevalue, sizevalue>>>& captures)
+{
+    const byte_array& literal = prefilter.literal;
+    if (not literal.empty() and content.find(literal) == byte_array::npos) {
+        // 每个匹配都包含字面量，字面量不出现时没有匹配
+        return;
+    }
+    if (literal.empty() or not prefilter.windowed) {
+        for (auto it = std::sregex_iterator(content.begin(), content.end(), re); it != std::sregex_iterator(); ++it) {
+            record_match(*it, 0, matches, captures);
+        }
+        return;
+    }
+
+    // 设下一个匹配的开始位置不小于 next_start，候选位置 candidate 为 next_start 之后字面量首次出现的位置，
+    // 则下一个匹配开始于 [max(next_start, candidate - max_width_before), ...)；
+    // 把开始位置可能落在窗口中的匹配所用的候选位置都并入窗口，窗口中最左的匹配即为整体最左的匹配 (模式不含依赖窗口之外内容的断言)
+    sizevalue before = prefilter.max_width_before;
+    sizevalue after = prefilter.max_width_after;
+    sizevalue next_start = 0;
+    sizevalue candidate = content.find(literal);
+    while (candidate != byte_array::npos) {
+        sizevalue window_begin = std::max(next_start, candidate >= before ? candidate - before : 0);
+        sizevalue window_end = std::min(content.size(), candidate + literal.size() + after);
+        sizevalue next = content.find(literal, candidate + 1);
+        while (next != byte_array::npos and next < window_end + before) {
+            window_end = std::min(content.size(), next + literal.size() + after);
+            next = content.find(literal, next + 1);
+        }
+        std::smatch match;
+        auto flags = window_begin > 0 ? std::regex_constants::match_prev_avail : std::regex_constants::match_default;
+        if (std::regex_search(content.begin() + window_begin, content.begin() + window_end, match, re, flags)) {
+            record_match(match, window_begin, matches, captures);
+            next_start = window_begin + match.position() + match.length();
+            candidate = content.find(literal, next_start);
+        }
+        else {
+            next_start = window_end;
+            candidate = next;
+        }
+    }
+}
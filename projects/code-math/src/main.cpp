@@ -1,29 +1,104 @@
 #include <basic>
 #include <exception>
-#include <runtime-exception>
-#include <context>
+#include <engine>
+#include <engine-statistics>
+#include <rule-file>
+#include <stream-translation>
+#include <watch-translation>
 #include <fstream>
 #include <filesystem>
 #include <iostream>
-#include <regex>
-#include <utility>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+#include <stdexcept>
 
 using std::vector;
-using std::pair;
 namespace fs = std::filesystem;
 
+bool create_output_directory(const fs::path& output_path);
+fs::path lean_path_of(const byte_array& filepath, const fs::path& output_path);
+bool open_lean_file(const byte_array& filepath, const fs::path& output_path, vector<byte_array>& saved_file_names, std::ofstream& out_file, fs::path& lean_path);
 bool save_as_lean(const byte_array& filepath, const fs::path& output_path, const byte_array& content, vector<byte_array>& saved_file_names);
-void exectute(byte_array& content);
-byte_array replace_content(byte_array content, commmand_value& cmd);
+bool write_statistics(const engine_statistics& statistics, const byte_array& stats_format, const byte_array& trace_path);
 
 // 读取传入参数中的文件路径，并尝试打开文件获取内容，若成功获取，尝试进行处理
 int32 main(int32 argc, char* argv[])
 {
     if (argc < 2) {
-        std::cerr << "用法: " << argv[0] << " <文件1> [文件2 ...]" << std::endl;
+        std::cerr << "用法: " << argv[0] << " <文件1|-> [文件2 ...] [-o 输出目录] [--rules 规则文件] [--stream] [--watch] [--stats[=table|json]] [--trace 文件]" << std::endl;
         return 1;
     }
 
+    // 统计选项："--stats" 或 "--stats=table" 以表格、"--stats=json" 以 JSON 把每个命令的统计写到标准错误，
+    // "--trace" 把每次替换的时间线以 Chrome trace event 格式写入文件
+    // "--rules" 以规则文件代替内置的规则 (见 include/rule-file)
+    // "--watch" 转译之后监视输入文件，文件改变时只重新转译改变的部分 (见 include/watch-translation)，统计与 trace 在每一轮转译之后输出
+    // "--stream" 按块读入并逐块写出，内存与文件大小无关 (见 include/stream-translation)；文件名 "-" 表示从标准输入读入并写到标准输出
+    byte_array stats_format{};
+    byte_array trace_path{};
+    byte_array rules_path{};
+    bool streaming = false;
+    bool watching = false;
+    for (int i = 1; i < argc; ++i) {
+        byte_array option = argv[i];
+        if (option == "-o") {
+            ++i;
+        }
+        else if (option == "--rules") {
+            ++i;
+            if (i >= argc) {
+                std::cerr << "错误：\"--rules\" 参数不存在后继参数" << std::endl;
+                return 1;
+            }
+            rules_path = argv[i];
+        }
+        else if (option == "--stream") {
+            streaming = true;
+        }
+        else if (option == "--watch") {
+            watching = true;
+        }
+        else if (option == "--stats" || option == "--stats=table") {
+            stats_format = "table";
+        }
+        else if (option == "--stats=json") {
+            stats_format = "json";
+        }
+        else if (option.starts_with("--stats=")) {
+            std::cerr << "错误：\"--stats\" 只支持 table 与 json 两种格式" << std::endl;
+            return 1;
+        }
+        else if (option == "--trace") {
+            ++i;
+            if (i >= argc) {
+                std::cerr << "错误：\"--trace\" 参数不存在后继参数" << std::endl;
+                return 1;
+            }
+            trace_path = argv[i];
+        }
+    }
+    if (!rules_path.empty()) {
+        try {
+            load_rules(rules_path);
+        } catch (const std::exception& e) {
+            std::cerr << "错误：无法载入规则：" << e.what() << std::endl;
+            return 1;
+        }
+    }
+    if (streaming) {
+        byte_array reason;
+        if (!stream_translatable(&reason)) {
+            std::cerr << "警告：" << reason << "，无法流式转译——将整体读入后转译" << std::endl;
+            streaming = false;
+        }
+    }
+    engine_statistics statistics(!trace_path.empty());
+    if (!stats_format.empty() || !trace_path.empty()) {
+        active_statistics = &statistics;
+    }
+
     fs::path output_path = "./Lean";
     // 尝试寻找"-o"选项并更改输出目录
     for (int i = 1; i < argc; ++i) {
@@ -41,21 +116,96 @@ int32 main(int32 argc, char* argv[])
         }
     }
     
+    if (watching) {
+        vector<watched_file> files{};
+        for (int i = 1; i < argc; ++i) {
+            byte_array option = argv[i];
+            if (option == "-o" || option == "--trace" || option == "--rules") {
+                ++i;
+                continue;
+            }
+            if (option.starts_with("--stats") || option == "--stream" || option == "--watch") {
+                continue;
+            }
+            if (option == "-") {
+                std::cerr << "错误：\"--watch\" 不能用于标准输入" << std::endl;
+                return 1;
+            }
+            fs::path lean_path = lean_path_of(option, output_path);
+            // 监视模式中每次都重写整个输出文件，同名的输入无法像普通模式那样追加到同一个文件
+            if (std::find_if(files.begin(), files.end(), [&lean_path](watched_file& f) { return f.output_path == lean_path; }) != files.end()) {
+                std::cerr << "错误：\"--watch\" 中多个输入文件对应同一个输出文件 " << lean_path << std::endl;
+                return 1;
+            }
+            files.push_back({ option, lean_path });
+        }
+        if (files.empty() || !create_output_directory(output_path)) {
+            return 1;
+        }
+        // 监视模式不会正常结束，统计在每一轮转译之后输出并清空 (trace 则累积，每轮重写整个文件)
+        auto report = [&]() {
+            if (!write_statistics(statistics, stats_format, trace_path)) {
+                throw std::runtime_error("无法写入文件 " + trace_path);
+            }
+            statistics.commands.clear();
+        };
+        try {
+            watch_and_translate(files, std::cout, active_statistics != nullptr ? std::function<void()>(report) : std::function<void()>{});
+        } catch (const std::exception& e) {
+            std::cerr << "错误：" << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     // 提取文件并处理
     vector<byte_array> saved_file_names{};
     for (int i = 1; i < argc; ++i) {
-        if (byte_array(argv[i]) == "-o") {
+        if (byte_array(argv[i]) == "-o" || byte_array(argv[i]) == "--trace" || byte_array(argv[i]) == "--rules") {
             ++i;
             continue;
         }
+        if (byte_array(argv[i]).starts_with("--stats") || byte_array(argv[i]) == "--stream" || byte_array(argv[i]) == "--watch") {
+            continue;
+        }
 
         byte_array filepath = argv[i];
+        // 标准输入转译到标准输出，此时提示信息不写入标准输出
+        if (filepath == "-") {
+            if (streaming) {
+                translate_stream(std::cin, std::cout);
+            }
+            else {
+                byte_array content{ std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>() };
+                exectute(content);
+                std::cout.write(content.data(), content.size());
+                std::cout.flush();
+            }
+            continue;
+        }
         std::ifstream file(filepath, std::ios::binary);
         
         if (!file.is_open()) {
             std::cerr << "警告：无法打开文件 " << filepath << std::endl;
             continue;
         }
+
+        if (streaming) {
+            std::ofstream out_file;
+            fs::path lean_path;
+            if (!open_lean_file(filepath, output_path, saved_file_names, out_file, lean_path)) {
+                std::cerr << "文件转换失败！" << std::endl;
+                return 1;
+            }
+            translate_stream(file, out_file);
+            if (!out_file) {
+                std::cerr << "错误：无法写入文件 " << lean_path << std::endl;
+                std::cerr << "文件转换失败！" << std::endl;
+                return 1;
+            }
+            std::cout << "已保存为: " << lean_path << std::endl;
+            std::cout << "文件转换成功！" << std::endl;
+            continue;
+        }
         
         // 读取文件
         file.seekg(0, std::ios::end);
@@ -76,6 +226,31 @@ int32 main(int32 argc, char* argv[])
             return 1;
         }
     }
+
+    active_statistics = nullptr;
+    if (!write_statistics(statistics, stats_format, trace_path)) {
+        std::cerr << "错误：无法写入文件 " << trace_path << std::endl;
+        return 1;
+    }
+}
+
+// 按 stats_format 把统计写到标准错误，trace_path 非空时写入 trace；无法写入 trace 时返回 false
+bool write_statistics(const engine_statistics& statistics, const byte_array& stats_format, const byte_array& trace_path)
+{
+    if (stats_format == "table") {
+        statistics.write_table(std::cerr);
+    }
+    else if (stats_format == "json") {
+        statistics.write_json(std::cerr);
+    }
+    if (!trace_path.empty()) {
+        std::ofstream trace_file(trace_path);
+        statistics.write_chrome_trace(trace_file);
+        if (!trace_file) {
+            return false;
+        }
+    }
+    return true;
 }
 
 // 创建Lean文件夹（如果不存在）
@@ -97,8 +272,22 @@ bool create_output_directory(const fs::path& output_path)
     }
 }
 
-// 修改文件后缀为.lean并保存到Lean文件夹
-bool save_as_lean(const byte_array& filepath, const fs::path& output_path, const byte_array& content, vector<byte_array>& saved_file_names)
+// 输出文件的路径：文件名中的 '-' 替换为 '_'，后缀改为.lean，放在Lean文件夹中
+fs::path lean_path_of(const byte_array& filepath, const fs::path& output_path)
+{
+    // 获取原始文件名（不含路径）
+    fs::path original_path(filepath);
+    byte_array original_name = original_path.filename().string();
+    std::replace(original_name.begin(), original_name.end(), '-', '_'); // 将文件名中的 '-' 替换为 '_'
+    
+    // 替换后缀为.lean
+    fs::path lean_path = output_path / original_name;
+    lean_path.replace_extension(".lean");
+    return lean_path;
+}
+
+// 修改文件后缀为.lean，在Lean文件夹中打开输出文件
+bool open_lean_file(const byte_array& filepath, const fs::path& output_path, vector<byte_array>& saved_file_names, std::ofstream& out_file, fs::path& lean_path)
 {
     try {
         // 创建Lean文件夹
@@ -106,30 +295,18 @@ bool save_as_lean(const byte_array& filepath, const fs::path& output_path, const
             return false;
         }
         
-        // 获取原始文件名（不含路径）
-        fs::path original_path(filepath);
-        byte_array original_name = original_path.filename().string();
-        std::replace(original_name.begin(), original_name.end(), '-', '_'); // 将文件名中的 '-' 替换为 '_'
-        
-        // 替换后缀为.lean
-        fs::path lean_path = output_path / original_name;
-        lean_path.replace_extension(".lean");
+        lean_path = lean_path_of(filepath, output_path);
         
         // 保存文件
         byte_array stem = lean_path.stem().string();
         // 根据是否已经保存过同名(省略后缀)文件来选择追加或覆盖模式
-        std::ofstream out_file(lean_path, std::find_if(saved_file_names.begin(), saved_file_names.end(), [&stem](byte_array& s) { return s == stem; }) != saved_file_names.end() ? std::ios::binary | std::ios::app : std::ios::binary);
+        out_file.open(lean_path, std::find_if(saved_file_names.begin(), saved_file_names.end(), [&stem](byte_array& s) { return s == stem; }) != saved_file_names.end() ? std::ios::binary | std::ios::app : std::ios::binary);
         if (!out_file) {
             std::cerr << "错误：无法创建文件 " << lean_path << std::endl;
             return false;
         }
-        
-        out_file.write(content.c_str(), content.size());
-        out_file.close();
 
         saved_file_names.push_back(stem);
-        
-        std::cout << "已保存为: " << lean_path << std::endl;
         return true;
         
     } catch (const std::exception& e) {
@@ -138,265 +315,20 @@ bool save_as_lean(const byte_array& filepath, const fs::path& output_path, const
     }
 }
 
-// 根据读入的文件内容，以及 context 中的 executable_list 执行命令
-void exectute(byte_array& content)
-{
-    for (auto& cmdv : executable_list) {
-        switch (cmdv.type) {
-        case command_type::REPLACE_COMMAND:
-            content = replace_content(content, cmdv);
-            break;
-        case command_type::DEFINE_COMMAND:
-            break;
-        }
-    }
-}
-
-byte_array set_capture_of(byte_array s, pair<sizevalue, sizevalue>& position);
-byte_array expand_target(byte_array& content, vector<pair<sizevalue, sizevalue>>& captures, byte_array& target);
-byte_array expand_number_of_target(byte_array& content, vector<pair<sizevalue, sizevalue>>& captures, byte_array& target);
-byte_array disable_all_captures(const byte_array& pattern);
-byte_array expand_symbol_of_target(byte_array& target);
-byte_array expand_symbol_once_of_target(byte_array& target);
-
-// 进行匹配过程，结果反映在 matches 和 captures 中
-void process_match(vector<pair<sizevalue, sizevalue>>& matches, vector<vector<pair<sizevalue, sizevalue>>>& captures, std::sregex_iterator begin, std::sregex_iterator end)
-{
-    for (auto it = begin; it != end; ++it) {
-        const std::smatch& match = *it;
-        
-        // 主匹配
-        sizevalue pos = match.position();
-        sizevalue length = match.length();
-        matches.emplace_back(pos, length);
-        
-        // 处理捕获组
-        vector<pair<sizevalue, sizevalue>> match_captures;
-        for (sizevalue i = 1; i < match.size(); ++i) {  // i=0是整个匹配
-            if (match[i].matched) {
-                match_captures.emplace_back(match.position(i), match.length(i));
-            } else {
-                match_captures.emplace_back(byte_array::npos, 0);  // 未匹配的捕获组
-            }
-        }
-        captures.push_back(std::move(match_captures));
-    }
-}
-
-// 替换命令的执行
-byte_array replace_content(byte_array content, commmand_value& cmdv)
-{ 
-    // 查找所有匹配
-    byte_array pattern = expand_symbol_of_target(cmdv.ptr->pattern);
-    std::regex re(pattern);
-    
-    vector<pair<sizevalue, sizevalue>> matches;  // 位置和长度
-    vector<vector<pair<sizevalue, sizevalue>>> captures;  // 每个匹配的捕获组
-    
-    auto begin = std::sregex_iterator(content.begin(), content.end(), re);
-    auto end = std::sregex_iterator();
-    
-    process_match(matches, captures, begin, end);
-    
-    // 进行逐层子替换
-    byte_array sub_content = disable_all_captures(expand_symbol_once_of_target(cmdv.ptr->pattern));
-    re = R"(@([a-zA-Z_][a-zA-Z0-9_]*)#)";
-    begin = std::sregex_iterator(sub_content.begin(), sub_content.end(), re);
-    end = std::sregex_iterator();
-
-    auto old_matches = std::move(matches);
-    auto old_captures = std::move(captures);
-
-    matches.clear();
-    captures.clear();
-    process_match(matches, captures, begin, end);
-
-    // 最外层循环，遍历单层展开的 pattern 中的变量
-    for (sizevalue i = captures.size() - 1; i != sizevalue_max; --i) {
-        str name = fixed_length(sub_content.substr(captures[i][0].first, captures[i][0].second));
-        runtime_assert(buffer.contains(name), "在展开\"" + sub_content + "\"的\"" + sub_content.substr(captures[i][0].first, captures[i][0].second) + "\"时，未发现存在对应的定义！");
-        byte_array temp_pattern = set_capture_of(sub_content, captures[i][0]);
-        std::regex temp_re(expand_symbol_of_target(temp_pattern));
-        // 内层循环，遍历 content 中的每个匹配的子字符串
-        for (sizevalue j = old_matches.size() - 1; j != sizevalue_max; --j) {
-            vector<pair<sizevalue, sizevalue>> temp_matches;  // 位置和长度
-            vector<vector<pair<sizevalue, sizevalue>>> temp_captures;  // 每个匹配的捕获组
-            byte_array temp_content = content.substr(old_matches[j].first, old_matches[j].second); // 子字符串
-            auto temp_begin = std::sregex_iterator(temp_content.begin(), temp_content.end(), temp_re);
-            auto temp_end = std::sregex_iterator();
-            process_match(temp_matches, temp_captures, temp_begin, temp_end);
-            // 进行子替换
-            auto replacement = replace_content(content.substr(old_matches[j].first + temp_captures[0][0].first, temp_captures[0][0].second), buffer[name]);
-            content.replace(old_matches[j].first + temp_captures[0][0].first, temp_captures[0][0].second, replacement);
-            // 更新索引
-            old_matches[j].second += replacement.size() - temp_captures[0][0].second;
-            old_captures[j][i].second += replacement.size() - temp_captures[0][0].second;
-            for (sizevalue k = i + 1; k < old_captures[j].size(); ++k) {
-                old_captures[j][k].first += replacement.size() - temp_captures[0][0].second;
-            }
-            for (sizevalue k = j + 1; k < old_matches.size(); ++k) {
-                old_matches[k].first += replacement.size() - temp_captures[0][0].second;
-                for (auto& old_capture : old_captures[k]) {
-                    old_capture.first += replacement.size() - temp_captures[0][0].second;
-                }
-            }
-        }
-    }
-
-    // 如果是替换指令，进行替换
-    if (cmdv.type == command_type::REPLACE_COMMAND) {
-        replace_command& cmd = *static_cast<replace_command*>(cmdv.ptr.get());
-        // 进行替换
-        for (sizevalue i = old_matches.size() - 1; i != sizevalue_max; --i) {
-            auto& match = old_matches[i];
-            byte_array expanded_target = expand_target(content, old_captures[i], cmd.target);
-            content.replace(match.first, match.second, expanded_target);
-        }
-    }
-
-    return std::move(content);
-}
-
-// 为 s 中名称位于 position 处的变量添加捕获修饰 (若之前没有)
-byte_array set_capture_of(byte_array s, pair<sizevalue, sizevalue>& position)
-{
-    byte_array result = s;
-    result.insert(position.first + position.second + 2, ")");
-    result.insert(position.first - 1, "(");
-    return std::move(result);
-}
-
-// 展开 replace_command::target 中的 "@...#" 内容
-byte_array expand_target(byte_array& content, vector<pair<sizevalue, sizevalue>>& captures, byte_array& target)
-{
-    byte_array expanded_target = expand_number_of_target(content, captures, target);
-    expanded_target = expand_symbol_of_target(expanded_target);
-    return std::move(expanded_target);
-}
-
-// 展开 replace_command::target 中的 "@\d+#" 内容
-byte_array expand_number_of_target(byte_array& content, vector<pair<sizevalue, sizevalue>>& captures, byte_array& target)
-{
-    byte_array expanded_target = target;
-    std::regex re(R"(@(\d+)#)");
-    vector<pair<sizevalue, sizevalue>> matches;  // 位置和长度
-    vector<vector<pair<sizevalue, sizevalue>>> number_captures;  // 每个匹配的捕获组
-    
-    auto begin = std::sregex_iterator(expanded_target.begin(), expanded_target.end(), re);
-    auto end = std::sregex_iterator();
-    
-    process_match(matches, number_captures, begin, end);
-
-    for (sizevalue i = matches.size() - 1; i != sizevalue_max; --i) {
-        auto& match = matches[i];
-        sizevalue number = 0;
-        try {
-            number = std::stoll(expanded_target.substr(number_captures[i][0].first, number_captures[i][0].second));
-        }
-        catch (std::exception& e) {
-            link_error(e, "在展开\"" + target + "\"的\"" + expanded_target.substr(match.first, match.second) + "\"时，其中的数字过大！(大于sizevalue_max)");
-        }
-        runtime_assert(number - 1 < captures.size(), "在展开\"" + target + "\"的\"" + expanded_target.substr(match.first, match.second) + "\"时，未发现存在对应的捕获组！");
-        expanded_target.replace(match.first, match.second, content.substr(captures[number - 1].first, captures[number - 1].second));
-    }
-
-    return std::move(expanded_target);
-}
-
-// 将 pattern 中的所有捕获组改成非捕获组
-byte_array disable_all_captures(const byte_array& pattern)
+// 修改文件后缀为.lean并保存到Lean文件夹
+bool save_as_lean(const byte_array& filepath, const fs::path& output_path, const byte_array& content, vector<byte_array>& saved_file_names)
 {
-    byte_array result;
-    result.reserve(pattern.length() + 20); // 预分配空间
-    
-    for (size_t i = 0; i < pattern.length(); ++i) {
-        if (pattern[i] == '(') {
-            // 检查前一个字符是否是反斜杠（转义情况）
-            if (i > 0 && pattern[i-1] == '\\') {
-                result += pattern[i];
-                continue;
-            }
-            
-            // 检查是否已经是特殊语法
-            if (i + 1 < pattern.length()) {
-                if (pattern[i+1] == '?') {
-                    // 已经是 (?:, (?=, (?!, (?<=, (?<! 等
-                    result += pattern[i];
-                    result += pattern[i+1];
-                    i++;
-                    if (i + 1 < pattern.length() && pattern[i+1] == ':') {
-                        result += pattern[++i]; // 非捕获组，保留
-                    } else {
-                        // 其他 (? 语法，保持原样
-                        continue;
-                    }
-                } else {
-                    // 普通捕获组，转换为非捕获组
-                    result += "(?:";
-                }
-            } else {
-                result += "(?:";
-            }
-        } else {
-            result += pattern[i];
-        }
+    std::ofstream out_file;
+    fs::path lean_path;
+    if (!open_lean_file(filepath, output_path, saved_file_names, out_file, lean_path)) {
+        return false;
     }
-    
-    return result;
-}
-
-// 展开 target 中的 "@{var}#" 内容直到无法展开，其中 var 指代任意定义名标识符
-byte_array expand_symbol_of_target(byte_array& target)
-{
-    byte_array expanded_target = target;
-    std::regex re(R"(@([a-zA-Z_][a-zA-Z0-9_]*)#)");
-    vector<pair<sizevalue, sizevalue>> matches;  // 位置和长度
-    vector<vector<pair<sizevalue, sizevalue>>> symbol_captures;  // 每个匹配的捕获组
-
-    auto begin = std::sregex_iterator(expanded_target.begin(), expanded_target.end(), re);
-    auto end = std::sregex_iterator();
-    
-    process_match(matches, symbol_captures, begin, end);
-
-    // 展开内容
-    for (sizevalue i = matches.size() - 1; i != sizevalue_max; --i) {
-        auto& match = matches[i];
-        str name = fixed_length(expanded_target.substr(symbol_captures[i][0].first, symbol_captures[i][0].second));
-        runtime_assert(buffer.contains(name), "在展开\"" + target + "\"的\"" + expanded_target.substr(match.first, match.second) + "\"时，未发现存在对应的定义！");
-        auto& cmdv = buffer[name];
-        // 如果是定义指令或者替换指令，直接全部展开
-        if (cmdv.type == command_type::DEFINE_COMMAND || cmdv.type == command_type::REPLACE_COMMAND) {
-            expanded_target.replace(match.first, match.second, disable_all_captures(expand_symbol_of_target(static_cast<define_command*>(cmdv.ptr.get())->pattern)));
-        }
+    out_file.write(content.c_str(), content.size());
+    out_file.close();
+    if (!out_file) {
+        std::cerr << "错误：无法写入文件 " << lean_path << std::endl;
+        return false;
     }
-
-    return std::move(expanded_target);
+    std::cout << "已保存为: " << lean_path << std::endl;
+    return true;
 }
-
-// 展开 target 中的 "@{var}#" 内容中的顶层，其中 var 指代任意定义名标识符
-byte_array expand_symbol_once_of_target(byte_array& target)
-{
-    byte_array expanded_target = target;
-    std::regex re(R"(@([a-zA-Z_][a-zA-Z0-9_]*)#)");
-    vector<pair<sizevalue, sizevalue>> matches;  // 位置和长度
-    vector<vector<pair<sizevalue, sizevalue>>> symbol_captures;  // 每个匹配的捕获组
-
-    auto begin = std::sregex_iterator(expanded_target.begin(), expanded_target.end(), re);
-    auto end = std::sregex_iterator();
-    
-    process_match(matches, symbol_captures, begin, end);
-
-    // 展开内容
-    for (sizevalue i = matches.size() - 1; i != sizevalue_max; --i) {
-        auto& match = matches[i];
-        str name = fixed_length(expanded_target.substr(symbol_captures[i][0].first, symbol_captures[i][0].second));
-        runtime_assert(buffer.contains(name), "在展开\"" + target + "\"的\"" + expanded_target.substr(match.first, match.second) + "\"时，未发现存在对应的定义！");
-        auto& cmdv = buffer[name];
-        // 如果是定义指令或者替换指令，展开一层
-        if (cmdv.type == command_type::DEFINE_COMMAND || cmdv.type == command_type::REPLACE_COMMAND) {
-            expanded_target.replace(match.first, match.second, disable_all_captures(static_cast<define_command*>(cmdv.ptr.get())->pattern));
-        }
-    }
-
-    return std::move(expanded_target);
-}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include <replacement-template>
+#include <string_view>
+
+using std::vector;
+using std::pair;
+
+static bool is_identifier_start(char c) noexcept
+{
+    return ('a' <= c and c <= 'z') or ('A' <= c and c <= 'Z') or c == '_';
+}
+
+static bool is_identifier_character(char c) noexcept
+{
+    return is_identifier_start(c) or ('0' <= c and c <= '9');
+}
+
+// 在 literal 中，每个 '@' 都是某个完整的 "@名称#" 的开头时返回 true
+static bool symbols_are_complete(const byte_array& literal) noexcept
+{
+    for (sizevalue i = literal.find('@'); i != byte_array::npos; i = literal.find('@', i)) {
+        sizevalue end = i + 1;
+        if (end >= literal.size() or not is_identifier_start(literal[end])) {
+            return false;
+        }
+        while (end < literal.size() and is_identifier_character(literal[end])) {
+            ++end;
+        }
+        if (end >= literal.size() or literal[end] != '#') {
+            return false;
+        }
+        i = end + 1;
+    }
+    return true;
+}
+
+replacement_template split_replacement_template(const byte_array& target)
+{
+    replacement_template result;
+    result.precompiled = true;
+    byte_array literal;
+    // 与正则表达式 "@(\d+)#" 从左到右不重叠地查找的结果相同
+    for (sizevalue i = 0; i < target.size();) {
+        sizevalue end = i + 1;
+        while (target[i] == '@' and end < target.size() and '0' <= target[end] and target[end] <= '9') {
+            ++end;
+        }
+        if (target[i] != '@' or end == i + 1 or end >= target.size() or target[end] != '#') {
+            literal += target[i++];
+            continue;
+        }
+        sizevalue capture = 0;
+        try {
+            capture = std::stoull(target.substr(i + 1, end - i - 1));
+        }
+        catch (const std::exception&) {
+            result.precompiled = false;
+        }
+        if (not literal.empty()) {
+            result.segments.push_back({ std::move(literal), 0 });
+            literal.clear();
+        }
+        result.segments.push_back({ byte_array{}, capture });
+        i = end + 1;
+    }
+    if (not literal.empty()) {
+        result.segments.push_back({ std::move(literal), 0 });
+    }
+    for (const auto& segment : result.segments) {
+        // 字面量片段不为空，为空说明是 "@0#"，它不引用任何捕获组，交给逐个展开时报告错误
+        if (segment.capture == 0 and (segment.literal.empty() or not symbols_are_complete(segment.literal))) {
+            result.precompiled = false;
+        }
+    }
+    return result;
+}
+
+bool append_replacement(const replacement_template& pattern, const byte_array& content, const vector<pair<sizevalue, sizevalue>>& captures, byte_array& output)
+{
+    for (const auto& segment : pattern.segments) {
+        if (segment.capture == 0) {
+            continue;
+        }
+        if (segment.capture > captures.size() or captures[segment.capture - 1].first == byte_array::npos) {
+            return false;
+        }
+        // 捕获的内容含有 '@' 时可能与相邻片段组成新的 "@名称#"，需要逐个展开
+        std::string_view captured(content.data() + captures[segment.capture - 1].first, captures[segment.capture - 1].second);
+        if (captured.find('@') != std::string_view::npos) {
+            return false;
+        }
+    }
+    for (const auto& segment : pattern.segments) {
+        if (segment.capture == 0) {
+            output += segment.literal;
+        }
+        else {
+            output.append(content, captures[segment.capture - 1].first, captures[segment.capture - 1].second);
+        }
+    }
+    return true;
+}
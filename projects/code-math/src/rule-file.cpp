@@ -0,0 +1,138 @@
+#include <rule-file>
+#include <rule-snapshot>
+#include <engine>
+#include <replace-command>
+#include <define-command>
+#include <fixed-string>
+#include <fnv-hash>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cctype>
+
+using std::vector;
+using std::map;
+using std::pair;
+using std::invalid_argument;
+
+static bool is_name(const byte_array& text) noexcept
+{
+    if (text.empty() or not (std::isalpha(static_cast<nat8>(text.front())) or text.front() == '_')) {
+        return false;
+    }
+    for (char c : text) {
+        if (not (std::isalnum(static_cast<nat8>(c)) or c == '_')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+rule_set parse_rule_file(const byte_array& text, const byte_array& file_name)
+{
+    rule_set rules;
+    // execute 可以引用之后定义的命令，因此先记录名称，全部解析之后再查找
+    vector<pair<byte_array, sizevalue>> executable_names;
+    std::istringstream in(text);
+    byte_array line;
+    sizevalue line_number = 0;
+    auto error = [&](const byte_array& information) {
+        return invalid_argument("规则文件 " + file_name + " 第 " + std::to_string(line_number) + " 行：" + information);
+    };
+    while (std::getline(in, line)) {
+        ++line_number;
+        if (not line.empty() and line.back() == '\r') {
+            line.pop_back();
+        }
+        sizevalue first = line.find_first_not_of(" \t");
+        if (first == byte_array::npos or line[first] == '#') {
+            continue;
+        }
+        sizevalue end_of_keyword = line.find(' ', first);
+        byte_array keyword = line.substr(first, end_of_keyword - first);
+        if (keyword == "execute") {
+            std::istringstream names(end_of_keyword == byte_array::npos ? byte_array{} : line.substr(end_of_keyword + 1));
+            byte_array name;
+            sizevalue count = 0;
+            while (names >> name) {
+                if (not is_name(name)) {
+                    throw error("\"" + name + "\" 不是合法的名称");
+                }
+                executable_names.emplace_back(name, line_number);
+                ++count;
+            }
+            if (count == 0) {
+                throw error("execute 之后缺少命令名");
+            }
+            continue;
+        }
+        if (keyword != "define" and keyword != "replace") {
+            throw error("未知的关键字 \"" + keyword + "\"");
+        }
+        if (end_of_keyword == byte_array::npos) {
+            throw error(keyword + " 之后缺少名称");
+        }
+        sizevalue end_of_name = line.find(' ', end_of_keyword + 1);
+        byte_array name = line.substr(end_of_keyword + 1, end_of_name - end_of_keyword - 1);
+        if (not is_name(name)) {
+            throw error("\"" + name + "\" 不是合法的名称");
+        }
+        byte_array body = end_of_name == byte_array::npos ? byte_array{} : line.substr(end_of_name + 1);
+        byte_array pattern = body;
+        byte_array target;
+        if (keyword == "replace") {
+            sizevalue separator = body.find(" => ");
+            if (separator == byte_array::npos) {
+                throw error("replace 的 pattern 与 target 之间缺少 \" => \"");
+            }
+            pattern = body.substr(0, separator);
+            target = body.substr(separator + 4);
+        }
+        if (pattern.empty()) {
+            throw error(keyword + " " + name + " 的 pattern 为空");
+        }
+        auto [entry, inserted] = rules.commands.try_emplace(fixed_length(name));
+        if (not inserted) {
+            throw error("名称 \"" + name + "\" 重复定义");
+        }
+        // command::name 与键相同，指向全局符号表中的文本
+        if (keyword == "replace") {
+            entry->second = { std::make_shared<replace_command>(entry->first, std::move(pattern), std::move(target)), command_type::REPLACE_COMMAND };
+        }
+        else {
+            entry->second = { std::make_shared<define_command>(entry->first, std::move(pattern)), command_type::DEFINE_COMMAND };
+        }
+    }
+    for (const auto& [name, number] : executable_names) {
+        auto found = rules.commands.find(fixed_length(name));
+        if (found == rules.commands.end()) {
+            line_number = number;
+            throw error("执行的命令 \"" + name + "\" 未定义");
+        }
+        rules.executables.push_back(found->second);
+    }
+    return rules;
+}
+
+void load_rules(const byte_array& rule_path)
+{
+    std::ifstream file(rule_path, std::ios::binary);
+    if (not file) {
+        throw invalid_argument("无法读取规则文件 " + rule_path);
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    const byte_array source = text.str();
+    // 快照按内容的散列值保存在缓存目录中，不写入规则文件所在的目录；载入时再与快照中保存的内容比较
+    byte_array snapshot_path = rule_snapshot_path(fnv1a_hash(source));
+    if (not snapshot_path.empty() and load_rule_snapshot(snapshot_path, source)) {
+        return;
+    }
+    rule_set rules = parse_rule_file(source, rule_path);
+    install_rules(std::move(rules.commands), std::move(rules.executables));
+    if (snapshot_path.empty()) {
+        return;
+    }
+    // 编译所有命令，同时检查 pattern 中的名称都有定义
+    save_rule_snapshot(snapshot_path, source);
+}
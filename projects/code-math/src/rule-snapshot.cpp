@@ -0,0 +1,307 @@
+#include <rule-snapshot>
+#include <engine>
+#include <replace-command>
+#include <define-command>
+#include <fnv-hash>
+#include <fstream>
+#include <filesystem>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using std::vector;
+using std::map;
+
+// 快照的布局 (本机字节序)：
+//   snapshot_header
+//   snapshot_command[number_of_commands]   (按命令名排序，与 std::map 的顺序相同)
+//   snapshot_segment[number_of_segments]
+//   natmax[number_of_executables]          (执行列表中各个命令的下标)
+//   字符串区 (size_of_strings 字节)
+// 所有记录的大小都是8的倍数，因此记录区总是对齐的；字符串区的第一段为规则来源的原文
+
+constexpr char SNAPSHOT_MAGIC[8] = { 'C', 'M', 'R', 'U', 'L', 'E', 'S', '\0' };
+
+// 字符串区中的一段
+struct snapshot_string
+{
+    natmax offset;
+    natmax length;
+};
+
+struct snapshot_header
+{
+    char magic[8];
+    nat32 version;
+    nat32 size_of_natmax; // 防止误用其他平台生成的快照
+    natmax source_hash;
+    natmax number_of_commands;
+    natmax number_of_segments;
+    natmax number_of_executables;
+    natmax size_of_strings;
+    snapshot_string source; // 规则来源的原文，散列值相同时再逐字节比较
+};
+
+struct snapshot_command
+{
+    natmax type; // command_type
+    natmax windowed;
+    natmax target_precompiled;
+    natmax first_segment;
+    natmax number_of_segments;
+    natmax max_width_before;
+    natmax max_width_after;
+    snapshot_string name; // UTF-32 原文
+    snapshot_string pattern;
+    snapshot_string target;
+    snapshot_string expanded_pattern;
+    snapshot_string sub_pattern;
+    snapshot_string literal;
+};
+
+struct snapshot_segment
+{
+    natmax capture;
+    snapshot_string literal;
+};
+
+// 向字符串区追加 length 字节
+static snapshot_string append_string(byte_array& strings, const void* data, sizevalue length)
+{
+    snapshot_string result{ strings.size(), length };
+    strings.append(static_cast<const char*>(data), length);
+    return result;
+}
+
+bool save_rule_snapshot(const byte_array& path, const byte_array& source)
+{
+    const map<str, commmand_value>& commands = current_commands();
+    vector<snapshot_command> command_records;
+    vector<snapshot_segment> segment_records;
+    vector<natmax> executable_records;
+    byte_array strings;
+    snapshot_string source_record = append_string(strings, source.data(), source.size());
+    map<const command*, natmax> index_of_command;
+    for (const auto& [name, cmdv] : commands) {
+        const compiled_command& compiled = compile_command(cmdv);
+        snapshot_command record{};
+        record.type = static_cast<natmax>(cmdv.type);
+        record.windowed = compiled.prefilter.windowed;
+        record.target_precompiled = compiled.target.precompiled;
+        record.first_segment = segment_records.size();
+        record.number_of_segments = compiled.target.segments.size();
+        record.max_width_before = compiled.prefilter.max_width_before;
+        record.max_width_after = compiled.prefilter.max_width_after;
+        record.name = append_string(strings, name.data(), name.size() * sizeof(character));
+        record.pattern = append_string(strings, cmdv.ptr->pattern.data(), cmdv.ptr->pattern.size());
+        if (cmdv.type == command_type::REPLACE_COMMAND) {
+            const byte_array& target = static_cast<replace_command*>(cmdv.ptr.get())->target;
+            record.target = append_string(strings, target.data(), target.size());
+        }
+        record.expanded_pattern = append_string(strings, compiled.expanded_pattern.data(), compiled.expanded_pattern.size());
+        record.sub_pattern = append_string(strings, compiled.sub_pattern.data(), compiled.sub_pattern.size());
+        record.literal = append_string(strings, compiled.prefilter.literal.data(), compiled.prefilter.literal.size());
+        for (const auto& segment : compiled.target.segments) {
+            segment_records.push_back({ segment.capture, append_string(strings, segment.literal.data(), segment.literal.size()) });
+        }
+        index_of_command.emplace(cmdv.ptr.get(), command_records.size());
+        command_records.push_back(record);
+    }
+    for (const auto& cmdv : current_executables()) {
+        auto found = index_of_command.find(cmdv.ptr.get());
+        if (found == index_of_command.end()) {
+            // 执行列表中的命令不在命令表中，无法用下标表示
+            return false;
+        }
+        executable_records.push_back(found->second);
+    }
+
+    snapshot_header header{};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = RULE_SNAPSHOT_VERSION;
+    header.size_of_natmax = sizeof(natmax);
+    header.source_hash = fnv1a_hash(source);
+    header.number_of_commands = command_records.size();
+    header.number_of_segments = segment_records.size();
+    header.number_of_executables = executable_records.size();
+    header.size_of_strings = strings.size();
+    header.source = source_record;
+
+    // 先写入临时文件再重命名，其他进程不会读到写了一半的快照；临时文件名含有进程号，同时写入的进程互不干扰
+    byte_array temporary_path = path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(command_records.data()), command_records.size() * sizeof(snapshot_command));
+        out.write(reinterpret_cast<const char*>(segment_records.data()), segment_records.size() * sizeof(snapshot_segment));
+        out.write(reinterpret_cast<const char*>(executable_records.data()), executable_records.size() * sizeof(natmax));
+        out.write(strings.data(), strings.size());
+        if (not out) {
+            unlink(temporary_path.c_str());
+            return false;
+        }
+    }
+    if (rename(temporary_path.c_str(), path.c_str()) != 0) {
+        unlink(temporary_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+byte_array rule_snapshot_path(natmax source_hash)
+{
+    namespace fs = std::filesystem;
+    fs::path directory;
+    const char* cache_home = std::getenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    if (cache_home != nullptr and fs::path(cache_home).is_absolute()) {
+        directory = fs::path(cache_home) / "code-math";
+    }
+    else if (home != nullptr and fs::path(home).is_absolute()) {
+        directory = fs::path(home) / ".cache" / "code-math";
+    }
+    else {
+        return {};
+    }
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (error) {
+        return {};
+    }
+    char name[64];
+    std::snprintf(name, sizeof(name), "%016llx-v%u.snapshot", source_hash, RULE_SNAPSHOT_VERSION);
+    return (directory / name).string();
+}
+
+// 只读映射一个文件，析构时解除映射
+class mapped_file
+{
+public:
+    explicit mapped_file(const byte_array& path)
+    {
+        int32 descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return;
+        }
+        struct stat status{};
+        if (fstat(descriptor, &status) == 0 and status.st_size > 0) {
+            void* address = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (address != MAP_FAILED) {
+                data = static_cast<const char*>(address);
+                size = status.st_size;
+            }
+        }
+        close(descriptor);
+    }
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    ~mapped_file()
+    {
+        if (data != nullptr) {
+            munmap(const_cast<char*>(data), size);
+        }
+    }
+
+    const char* data = nullptr;
+    sizevalue size = 0;
+};
+
+bool load_rule_snapshot(const byte_array& path, const byte_array& source)
+{
+    mapped_file file(path);
+    if (file.data == nullptr or file.size < sizeof(snapshot_header)) {
+        return false;
+    }
+    const snapshot_header& header = *reinterpret_cast<const snapshot_header*>(file.data);
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 or header.version != RULE_SNAPSHOT_VERSION
+        or header.size_of_natmax != sizeof(natmax) or header.source_hash != fnv1a_hash(source)) {
+        return false;
+    }
+    // 各区的大小都不超过文件大小，逐项比较以免乘法溢出
+    sizevalue remaining = file.size - sizeof(snapshot_header);
+    if (header.number_of_commands > remaining / sizeof(snapshot_command)) {
+        return false;
+    }
+    remaining -= header.number_of_commands * sizeof(snapshot_command);
+    if (header.number_of_segments > remaining / sizeof(snapshot_segment)) {
+        return false;
+    }
+    remaining -= header.number_of_segments * sizeof(snapshot_segment);
+    if (header.number_of_executables > remaining / sizeof(natmax)) {
+        return false;
+    }
+    remaining -= header.number_of_executables * sizeof(natmax);
+    if (header.size_of_strings != remaining) {
+        return false;
+    }
+    const snapshot_command* command_records = reinterpret_cast<const snapshot_command*>(file.data + sizeof(snapshot_header));
+    const snapshot_segment* segment_records = reinterpret_cast<const snapshot_segment*>(command_records + header.number_of_commands);
+    const natmax* executable_records = reinterpret_cast<const natmax*>(segment_records + header.number_of_segments);
+    const char* strings = reinterpret_cast<const char*>(executable_records + header.number_of_executables);
+
+    auto valid = [&](const snapshot_string& s) { return s.offset <= header.size_of_strings and s.length <= header.size_of_strings - s.offset; };
+    auto text_of = [&](const snapshot_string& s) { return byte_array(strings + s.offset, s.length); };
+    if (not valid(header.source) or header.source.length != source.size() or memcmp(strings + header.source.offset, source.data(), source.size()) != 0) {
+        return false;
+    }
+
+    map<str, commmand_value> commands;
+    vector<commmand_value> commands_in_order;
+    vector<compiled_command> compiled_in_order;
+    for (natmax i = 0; i < header.number_of_commands; ++i) {
+        const snapshot_command& record = command_records[i];
+        if (not valid(record.name) or not valid(record.pattern) or not valid(record.target) or not valid(record.expanded_pattern)
+            or not valid(record.sub_pattern) or not valid(record.literal) or record.name.length % sizeof(character) != 0
+            or record.first_segment > header.number_of_segments or record.number_of_segments > header.number_of_segments - record.first_segment
+            or record.type > static_cast<natmax>(command_type::DEFINE_COMMAND)) {
+            return false;
+        }
+        str name(record.name.length / sizeof(character), U'\0');
+        memcpy(name.data(), strings + record.name.offset, record.name.length);
+        auto [entry, inserted] = commands.try_emplace(std::move(name));
+        if (not inserted) {
+            return false;
+        }
+        // command::name 与键相同，指向全局符号表中的文本
+        command_type type = static_cast<command_type>(record.type);
+        if (type == command_type::REPLACE_COMMAND) {
+            entry->second = { std::make_shared<replace_command>(entry->first, text_of(record.pattern), text_of(record.target)), type };
+        }
+        else {
+            entry->second = { std::make_shared<define_command>(entry->first, text_of(record.pattern)), type };
+        }
+        compiled_command compiled;
+        compiled.expanded_pattern = text_of(record.expanded_pattern);
+        compiled.sub_pattern = text_of(record.sub_pattern);
+        compiled.prefilter.literal = text_of(record.literal);
+        compiled.prefilter.max_width_before = record.max_width_before;
+        compiled.prefilter.max_width_after = record.max_width_after;
+        compiled.prefilter.windowed = record.windowed != 0;
+        compiled.target.precompiled = record.target_precompiled != 0;
+        for (natmax j = record.first_segment; j < record.first_segment + record.number_of_segments; ++j) {
+            if (not valid(segment_records[j].literal)) {
+                return false;
+            }
+            compiled.target.segments.push_back({ text_of(segment_records[j].literal), segment_records[j].capture });
+        }
+        commands_in_order.push_back(entry->second);
+        compiled_in_order.push_back(std::move(compiled));
+    }
+    vector<commmand_value> executables;
+    for (natmax i = 0; i < header.number_of_executables; ++i) {
+        if (executable_records[i] >= commands_in_order.size()) {
+            return false;
+        }
+        executables.push_back(commands_in_order[executable_records[i]]);
+    }
+
+    install_rules(std::move(commands), std::move(executables));
+    for (sizevalue i = 0; i < commands_in_order.size(); ++i) {
+        provide_compiled_command(commands_in_order[i], std::move(compiled_in_order[i]));
+    }
+    return true;
+}
@@ -0,0 +1,176 @@
+#include <stream-translation>
+#include <engine>
+#include <literal-prefilter>
+#include <runtime-exception>
+#include <fixed-string>
+#include <stdexcept>
+#include <algorithm>
+
+using std::vector;
+using std::pair;
+
+// 逻辑规范：
+// 前置条件 P: cmdv 为替换命令
+// 后置条件 Q: cmdv 满足流式转译的要求时返回 true 并把匹配长度的上界写入 max_width，否则返回 false 并写入原因
+static bool stream_width_of(const commmand_value& cmdv, sizevalue& max_width, byte_array& reason)
+{
+    const compiled_command& compiled = compile_command(cmdv);
+    byte_array name = variable_length(str(cmdv.ptr->name));
+    sizevalue least = 0;
+    if (not match_width_bounds(compiled.expanded_pattern, least, max_width)) {
+        reason = "命令 " + name + " 的 pattern 含有依赖上下文的断言、反向引用或无法分析的语法";
+        return false;
+    }
+    if (max_width == UNBOUNDED_WIDTH) {
+        reason = "命令 " + name + " 的匹配长度没有上界";
+        return false;
+    }
+    if (least == 0) {
+        reason = "命令 " + name + " 可以匹配空串";
+        return false;
+    }
+    return true;
+}
+
+bool stream_translatable(byte_array* reason)
+{
+    for (const auto& cmdv : current_executables()) {
+        if (cmdv.type != command_type::REPLACE_COMMAND) {
+            continue;
+        }
+        sizevalue max_width = 0;
+        byte_array information;
+        if (not stream_width_of(cmdv, max_width, information)) {
+            if (reason != nullptr) {
+                *reason = std::move(information);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+stream_translator::stream_translator(sizevalue chunk_size) : chunk_size(chunk_size)
+{
+    runtime_assert(chunk_size > 0, "流式转译的块大小必须大于0！");
+    for (const auto& cmdv : current_executables()) {
+        if (cmdv.type != command_type::REPLACE_COMMAND) {
+            continue;
+        }
+        sizevalue max_width = 0;
+        byte_array reason;
+        if (not stream_width_of(cmdv, max_width, reason)) {
+            throw std::invalid_argument("无法流式转译：" + reason);
+        }
+        stages.push_back({ cmdv, max_width });
+    }
+}
+
+// 逻辑规范：
+// 前置条件 P: current.pending.size() >= current.max_width > 0
+// 后置条件 Q: 返回切分点 cut > 0，使得 pending 中没有跨越 cut 的匹配，且 cut 之后追加任何内容都不改变 cut 之前的匹配；
+//   matches 与 captures 为 [0, cut) 中的全部匹配，与对 [0, cut) 调用 find_matches 的结果相同，可以直接交给 replace_matches
+//
+// 匹配长度不超过 W 且不含依赖上下文的断言时，一个位置上的匹配只取决于其后 W 个字符，
+// 因此开始位置 p <= size - W 的匹配以及 "p 处没有匹配" 都已确定；从头依次取最左的匹配，
+// 开始于 decided = size - W + 1 之前的匹配都已确定，切分点取其中最后一个的结尾与 decided 中较大者。
+// 只截取 [0, cut) 时，在最后一个确定的匹配之后出现的任何匹配在完整内容中同样开始于 p < decided，与 "p 处没有匹配" 矛盾，
+// 因此对 [0, cut) 执行 replace_content 与在完整内容中替换这些匹配相同
+// 开始于 decided 之后的匹配都不早于 cut (匹配互不重叠)，去掉它们之后剩下的正是 [0, cut) 中的匹配
+sizevalue stream_translator::cut_point(stage& current, vector<pair<sizevalue, sizevalue>>& matches, vector<vector<pair<sizevalue, sizevalue>>>& captures)
+{
+    compiled_command& compiled = compile_command(current.cmdv);
+    if (not compiled.expression.has_value()) {
+        compiled.expression.emplace(compiled.expanded_pattern);
+    }
+    find_matches(current.pending, *compiled.expression, compiled.prefilter, matches, captures);
+    sizevalue decided = current.pending.size() - current.max_width + 1;
+    sizevalue cut = decided;
+    sizevalue kept = 0;
+    while (kept < matches.size() and matches[kept].first < decided) {
+        cut = std::max(cut, matches[kept].first + matches[kept].second);
+        ++kept;
+    }
+    matches.resize(kept);
+    captures.resize(kept);
+    return cut;
+}
+
+// 把 input 交给第 index 级；finishing 为真时该级及其后各级处理全部剩余内容
+void stream_translator::push(sizevalue index, const byte_array& input, byte_array& output, bool finishing)
+{
+    if (index == stages.size()) {
+        output += input;
+        return;
+    }
+    stage& current = stages[index];
+    current.pending += input;
+    sizevalue number_of_replacements = 0;
+    byte_array translated;
+    sizevalue cut = current.pending.size();
+    if (finishing) {
+        translated = replace_content(current.pending, current.cmdv, &number_of_replacements);
+    }
+    else {
+        // 窗口积累到一块以上再处理，避免每次少量输入都重新匹配
+        if (current.pending.size() < chunk_size + current.max_width) {
+            return;
+        }
+        // 切分时找到的匹配就是 [0, cut) 中的匹配，替换时不再重新匹配
+        vector<pair<sizevalue, sizevalue>> matches;
+        vector<vector<pair<sizevalue, sizevalue>>> captures;
+        cut = cut_point(current, matches, captures);
+        translated = replace_matches(current.pending.substr(0, cut), current.cmdv, std::move(matches), std::move(captures), &number_of_replacements);
+    }
+    replacements += number_of_replacements;
+    current.pending.erase(0, cut);
+    push(index + 1, translated, output, finishing);
+}
+
+void stream_translator::write(const byte_array& input, byte_array& output)
+{
+    runtime_assert(not finished, "流式转译已经结束，不能再写入！");
+    push(0, input, output, false);
+}
+
+void stream_translator::finish(byte_array& output)
+{
+    runtime_assert(not finished, "流式转译已经结束！");
+    finished = true;
+    push(0, byte_array{}, output, true);
+}
+
+bool stream_translator::same_window(const stream_translator& other) const noexcept
+{
+    if (stages.size() != other.stages.size()) {
+        return false;
+    }
+    for (sizevalue i = 0; i < stages.size(); ++i) {
+        if (stages[i].cmdv.ptr != other.stages[i].cmdv.ptr or stages[i].pending != other.stages[i].pending) {
+            return false;
+        }
+    }
+    return true;
+}
+
+sizevalue translate_stream(std::istream& in, std::ostream& out, sizevalue chunk_size)
+{
+    stream_translator translator(chunk_size);
+    byte_array input(chunk_size, '\0');
+    byte_array output;
+    while (in) {
+        in.read(input.data(), input.size());
+        sizevalue count = in.gcount();
+        if (count == 0) {
+            break;
+        }
+        output.clear();
+        translator.write(input.substr(0, count), output);
+        out.write(output.data(), output.size());
+    }
+    output.clear();
+    translator.finish(output);
+    out.write(output.data(), output.size());
+    out.flush();
+    return translator.number_of_replacements();
+}
@@ -0,0 +1,218 @@
+#include <watch-translation>
+#include <engine>
+#include <runtime-exception>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+
+using std::vector;
+using std::map;
+using std::pair;
+namespace fs = std::filesystem;
+
+const byte_array& incremental_translation::update(byte_array content)
+{
+    retranslated = 0;
+    if (initialized and content == input) {
+        return translated;
+    }
+    if (not stream_translatable()) {
+        // 规则无法流式转译，只能整体重新转译
+        translated = content;
+        exectute(translated);
+        retranslated = content.size();
+        input = std::move(content);
+        checkpoints.clear();
+        initialized = true;
+        return translated;
+    }
+
+    vector<checkpoint> old_checkpoints = std::move(checkpoints);
+    byte_array old_translated = std::move(translated);
+    checkpoints.clear();
+    translated.clear();
+    // 块大小为1：每次写入之后立即处理所有已经确定的内容，检查点只保存很短的未确定部分
+    stream_translator translator(1);
+    sizevalue offset = 0;
+    // 修改的部分在原输入中为 [.., old_edit_end)，在新输入中为 [.., new_edit_end)，之后为公共后缀
+    sizevalue old_edit_end = input.size();
+    sizevalue new_edit_end = content.size();
+    sizevalue j = old_checkpoints.size();
+    if (initialized and not old_checkpoints.empty()) {
+        sizevalue limit = std::min(input.size(), content.size());
+        sizevalue prefix = std::mismatch(input.begin(), input.begin() + limit, content.begin()).first - input.begin();
+        sizevalue suffix = 0;
+        while (suffix < limit - prefix and input[input.size() - 1 - suffix] == content[content.size() - 1 - suffix]) {
+            ++suffix;
+        }
+        old_edit_end = input.size() - suffix;
+        new_edit_end = content.size() - suffix;
+        // 从不晚于公共前缀结尾的最后一个检查点开始，其之前的输入与输出都没有改变
+        sizevalue k = std::upper_bound(old_checkpoints.begin(), old_checkpoints.end(), prefix, [](sizevalue position, const checkpoint& c) { return position < c.input_offset; }) - old_checkpoints.begin() - 1;
+        offset = old_checkpoints[k].input_offset;
+        translator = old_checkpoints[k].translator;
+        translated.assign(old_translated, 0, old_checkpoints[k].output_offset);
+        checkpoints.assign(std::make_move_iterator(old_checkpoints.begin()), std::make_move_iterator(old_checkpoints.begin() + k));
+        j = k + 1;
+    }
+    // 原输入中公共后缀里的位置在新输入中的位置
+    auto shifted = [&](sizevalue old_offset) { return old_offset - old_edit_end + new_edit_end; };
+
+    while (offset < content.size()) {
+        while (j < old_checkpoints.size() and (old_checkpoints[j].input_offset < old_edit_end or shifted(old_checkpoints[j].input_offset) <= offset)) {
+            ++j;
+        }
+        // 越过修改的部分之后，在原来检查点对应的位置上停下，以便比较状态
+        sizevalue boundary = std::min(content.size(), offset + WATCH_CHECKPOINT_INTERVAL);
+        if (offset >= new_edit_end and j < old_checkpoints.size()) {
+            boundary = shifted(old_checkpoints[j].input_offset);
+        }
+        checkpoints.push_back({ offset, translated.size(), translator });
+        translator.write(content.substr(offset, boundary - offset), translated);
+        retranslated += boundary - offset;
+        offset = boundary;
+        if (offset >= new_edit_end and j < old_checkpoints.size() and shifted(old_checkpoints[j].input_offset) == offset and translator.same_window(old_checkpoints[j].translator)) {
+            // 状态相同且之后的输入相同，之后的输出也与原来相同
+            sizevalue output_offset = translated.size();
+            for (sizevalue i = j; i < old_checkpoints.size(); ++i) {
+                checkpoints.push_back({ shifted(old_checkpoints[i].input_offset), old_checkpoints[i].output_offset - old_checkpoints[j].output_offset + output_offset, std::move(old_checkpoints[i].translator) });
+            }
+            translated.append(old_translated, old_checkpoints[j].output_offset);
+            input = std::move(content);
+            initialized = true;
+            return translated;
+        }
+    }
+    translator.finish(translated);
+    input = std::move(content);
+    initialized = true;
+    return translated;
+}
+
+// 读取整个文件，无法打开时返回 false
+static bool read_file(const byte_array& path, byte_array& content)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (not file) {
+        return false;
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    content = text.str();
+    return true;
+}
+
+// 重新读取并转译 file，写出结果并记录用时
+static void retranslate(const watched_file& file, incremental_translation& translation, std::ostream& log)
+{
+    byte_array content;
+    if (not read_file(file.input_path, content)) {
+        log << "警告：无法打开文件 " << file.input_path << std::endl;
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    const byte_array& output = translation.update(std::move(content));
+    std::ofstream out(file.output_path, std::ios::binary | std::ios::trunc);
+    out.write(output.data(), output.size());
+    out.close();
+    if (not out) {
+        throw std::runtime_error("无法写入文件 " + file.output_path.string());
+    }
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    log << "已更新: " << file.output_path << " (重新转译 " << translation.retranslated_bytes() << " 字节，用时 " << milliseconds << " 毫秒)" << std::endl;
+}
+
+// 在作用域结束 (包括抛出异常) 时关闭 inotify 的文件描述符
+struct descriptor_guard
+{
+    int32 descriptor;
+    ~descriptor_guard() { close(descriptor); }
+};
+
+void watch_and_translate(const vector<watched_file>& files, std::ostream& log, const std::function<void()>& after_round)
+{
+    runtime_assert(not files.empty(), "监视模式至少需要一个文件！");
+    int32 descriptor = inotify_init1(IN_CLOEXEC);
+    if (descriptor < 0) {
+        throw std::runtime_error(byte_array("无法使用 inotify：") + strerror(errno));
+    }
+    descriptor_guard guard{ descriptor };
+    // 监视文件所在的目录而不是文件本身：编辑器常常写入临时文件再重命名，文件本身的监视会随之失效
+    map<byte_array, int32> directories;
+    map<pair<int32, byte_array>, vector<sizevalue>> files_of_entry;
+    for (sizevalue i = 0; i < files.size(); ++i) {
+        fs::path path = fs::absolute(files[i].input_path).lexically_normal();
+        byte_array directory = path.parent_path().string();
+        auto found = directories.find(directory);
+        if (found == directories.end()) {
+            int32 watch = inotify_add_watch(descriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (watch < 0) {
+                throw std::runtime_error("无法监视目录 " + directory + "：" + strerror(errno));
+            }
+            found = directories.emplace(directory, watch).first;
+        }
+        files_of_entry[{ found->second, path.filename().string() }].push_back(i);
+    }
+
+    vector<incremental_translation> translations(files.size());
+    for (sizevalue i = 0; i < files.size(); ++i) {
+        retranslate(files[i], translations[i], log);
+    }
+    if (after_round) {
+        after_round();
+    }
+    log << "正在监视 " << files.size() << " 个文件，按 Ctrl+C 退出" << std::endl;
+
+    alignas(inotify_event) char events[4096];
+    while (true) {
+        // 等待第一个事件，之后直到 WATCH_QUIET_MILLISECONDS 内没有新的事件为止，把连续的事件合并为一次重新转译
+        std::set<sizevalue> changed;
+        int32 timeout = -1;
+        while (true) {
+            pollfd waiting{ descriptor, POLLIN, 0 };
+            int32 ready = poll(&waiting, 1, timeout);
+            if (ready < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(byte_array("等待 inotify 事件失败：") + strerror(errno));
+            }
+            if (ready == 0) {
+                break;
+            }
+            ssize_t length = read(descriptor, events, sizeof(events));
+            if (length < 0) {
+                if (errno == EINTR or errno == EAGAIN) {
+                    continue;
+                }
+                throw std::runtime_error(byte_array("读取 inotify 事件失败：") + strerror(errno));
+            }
+            for (char* p = events; p < events + length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                if (event->len > 0) {
+                    auto found = files_of_entry.find({ event->wd, byte_array(event->name) });
+                    if (found != files_of_entry.end()) {
+                        changed.insert(found->second.begin(), found->second.end());
+                    }
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+            timeout = WATCH_QUIET_MILLISECONDS;
+        }
+        for (sizevalue i : changed) {
+            retranslate(files[i], translations[i], log);
+        }
+        if (not changed.empty() and after_round) {
+            after_round();
+        }
+    }
+}
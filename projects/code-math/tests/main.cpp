@@ -0,0 +1,355 @@
+#include <basic>
+#include <engine>
+#include <rule-file>
+#include <stream-translation>
+#include <watch-translation>
+#include <engine-statistics>
+#include <literal-prefilter>
+#include <replacement-template>
+#include <replace-command>
+#include <rule-snapshot>
+#include <fixed-string>
+#include <fnv-hash>
+#include <vector>
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+using std::vector;
+
+// 可以流式转译的规则集：命令之间互相引用、前一个命令的输出被后一个命令匹配、同一命令执行多次
+const vector<const char*> STREAMABLE_RULES = {
+    "define D [0-9]\n"
+    "replace A (ab|b)@D# => <$1>\n"
+    "replace B [<>]b{1,3}c => Q\n"
+    "replace C q?Qa => zz\n"
+    "execute A B C\n",
+    "replace A abc => cba\n"
+    "replace B c[ab]{2,4} => ac\n"
+    "execute A B A B\n",
+};
+
+// 无法流式转译的规则集 (依赖上下文的断言)，增量转译只能整体重新转译
+const char* const UNSTREAMABLE_RULES = "replace A ^ab => x\nexecute A\n";
+
+const byte_array ALPHABET = "abcqQ<>0123\n";
+
+// 内置规则 (context) 与 rules/lean.rules 都会改写的一段输入
+const byte_array SAMPLE_INPUT =
+    "nat8 f(int32 a, sizevalue b)\n"
+    "{\n"
+    "    for (nat16 i = 0; i < b; ++i) {\n"
+    "        a = static_cast<int32>(i) + 3;\n"
+    "    }\n"
+    "    return (nat8)a;\n"
+    "}\n";
+
+// 由 alphabet 中的字符组成的、长度为 length 的随机文本
+byte_array random_text(std::mt19937_64& random, const byte_array& alphabet, sizevalue length)
+{
+    byte_array text(length, '\0');
+    for (char& c : text) {
+        c = alphabet[random() % alphabet.size()];
+    }
+    return text;
+}
+
+int32 main()
+{
+    std::mt19937_64 random(20240611);
+
+    // 内置规则的转译结果，之后的检查以 install_rules 替换了规则，不能再取得
+    byte_array builtin_output = SAMPLE_INPUT;
+    exectute(builtin_output);
+
+    // 流式转译：随机的块大小与随机的写入长度下，输出与一次性转译 (exectute) 逐字节相同
+    bool streamed = true;
+    for (const char* text : STREAMABLE_RULES) {
+        rule_set rules = parse_rule_file(text, "tests");
+        install_rules(std::move(rules.commands), std::move(rules.executables));
+        streamed = streamed and stream_translatable(nullptr);
+        for (sizevalue i = 0; i < 500; ++i) {
+            byte_array input = random_text(random, ALPHABET, random() % 300);
+            byte_array expected = input;
+            exectute(expected);
+            stream_translator translator(1 + random() % 20);
+            byte_array output;
+            for (sizevalue written = 0; written < input.size();) {
+                sizevalue length = 1 + random() % 7;
+                translator.write(input.substr(written, length), output);
+                written += length;
+            }
+            translator.finish(output);
+            streamed = streamed and output == expected;
+        }
+    }
+    std::cout << streamed << std::endl;
+
+    // 增量转译：对跨越多个检查点的文本做随机的插入与删除，每次更新后的输出与整体重新转译 (exectute) 逐字节相同；
+    // 规则可以流式转译时，重新转译的字节数应远少于文本的总长度
+    bool incremental = true;
+    vector<const char*> rule_sets = STREAMABLE_RULES;
+    rule_sets.push_back(UNSTREAMABLE_RULES);
+    for (const char* text : rule_sets) {
+        rule_set rules = parse_rule_file(text, "tests");
+        install_rules(std::move(rules.commands), std::move(rules.executables));
+        sizevalue retranslated = 0;
+        sizevalue total = 0;
+        for (sizevalue document = 0; document < 3; ++document) {
+            incremental_translation translation;
+            byte_array input = random_text(random, ALPHABET, 16 * WATCH_CHECKPOINT_INTERVAL);
+            for (sizevalue edit = 0; edit < 15; ++edit) {
+                if (edit > 0) {
+                    sizevalue position = random() % (input.size() + 1);
+                    sizevalue erased = std::min<sizevalue>(random() % 50, input.size() - position);
+                    input.replace(position, erased, random_text(random, ALPHABET, random() % 50));
+                }
+                byte_array expected = input;
+                exectute(expected);
+                incremental = incremental and translation.update(input) == expected;
+                if (edit > 0) {
+                    retranslated += translation.retranslated_bytes();
+                    total += input.size();
+                }
+            }
+        }
+        if (stream_translatable(nullptr)) {
+            incremental = incremental and retranslated * 4 < total;
+        }
+    }
+    std::cout << incremental << std::endl;
+
+    // 性能统计：已知输入上各命令在各深度的调用、匹配、写入字节与子替换次数，JSON 与 trace 的格式，以及关闭统计时不再记录；
+    // A 的 pattern 只展开一层后为 x(@D#)y，每个匹配中的数字由 D 在深度1替换
+    bool counted = true;
+    {
+        rule_set rules = parse_rule_file("replace D [0-9] => d\ndefine E @D#\nreplace A x(@E#)y => <@1#>\nexecute A\n", "tests");
+        install_rules(std::move(rules.commands), std::move(rules.executables));
+        engine_statistics statistics(true);
+        active_statistics = &statistics;
+        byte_array content = "x1y x2y zz x3y";
+        exectute(content);
+        active_statistics = nullptr;
+        const command_statistics& top = statistics.commands[{ "A", 0 }];
+        const command_statistics& nested = statistics.commands[{ "D", 1 }];
+        counted = content == "<d> <d> zz <d>" and statistics.commands.size() == 2
+            and top.calls == 1 and top.matches == 3 and top.bytes_rewritten == 9 and top.sub_replacements == 3
+            and nested.calls == 3 and nested.matches == 3 and nested.bytes_rewritten == 3 and nested.sub_replacements == 0
+            and top.total_seconds >= top.match_seconds and top.total_seconds >= nested.total_seconds;
+
+        std::ostringstream json;
+        statistics.write_json(json);
+        counted = counted and json.str().starts_with("{\n    \"commands\": [\n") and json.str().ends_with("    ]\n}\n")
+            and json.str().find("{\"name\": \"A\", \"depth\": 0, \"calls\": 1, ") != byte_array::npos
+            and json.str().find("\"matches\": 3, \"bytes_rewritten\": 9, \"sub_replacements\": 3}") != byte_array::npos
+            and json.str().find("{\"name\": \"D\", \"depth\": 1, \"calls\": 3, ") != byte_array::npos;
+
+        // 每次调用记录命令、编译与匹配三个事件
+        std::ostringstream trace;
+        statistics.write_chrome_trace(trace);
+        sizevalue events = 0;
+        for (sizevalue position = trace.str().find("\"ph\": \"X\""); position != byte_array::npos; position = trace.str().find("\"ph\": \"X\"", position + 1)) {
+            ++events;
+        }
+        counted = counted and trace.str().starts_with("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n") and trace.str().ends_with("]}\n")
+            and events == statistics.events.size() and events == 3 * (top.calls + nested.calls)
+            and trace.str().find("{\"name\": \"A\", \"cat\": \"command\"") != byte_array::npos
+            and trace.str().find("\"args\": {\"depth\": 1}}") != byte_array::npos;
+
+        // 统计关闭后再次执行，记录不变
+        content = "x4y";
+        exectute(content);
+        counted = counted and content == "<d>" and statistics.commands.size() == 2 and statistics.commands[{ "A", 0 }].calls == 1
+            and statistics.events.size() == events;
+    }
+    std::cout << counted << std::endl;
+
+    // 字面量预过滤：只在候选位置附近的窗口中匹配 (windowed) 与不能使用窗口的模式，find_matches 的匹配与捕获组
+    // 都与用 std::sregex_iterator 遍历整个内容相同；内容中候选位置密集、相邻或重叠，字面量位于内容的开头与末尾
+    bool prefiltered = true;
+    {
+        const vector<std::pair<const char*, bool>> patterns = {
+            { "nat8", true }, { "a?nat8_?", true }, { "(x|y)?ab[0-9]{0,3}", true }, { "b{1,3}ab", true }, { "aab?a", true },
+            { "\\(nat8\\)", true }, { "n(a)(t)8", true },
+            { "ab[0-9]*", false }, { "\\bnat8\\b", false }, { "^ab", false }, { "ab(?=8)", false }, { "(a)b\\1", false },
+        };
+        const byte_array alphabet = "abnt8_xy09() ";
+        for (const auto& [pattern, windowed] : patterns) {
+            literal_prefilter prefilter = analyse_pattern(pattern);
+            std::regex re(pattern);
+            prefiltered = prefiltered and not prefilter.literal.empty() and prefilter.windowed == windowed;
+            vector<byte_array> contents = { prefilter.literal, prefilter.literal + prefilter.literal, "x" + prefilter.literal, prefilter.literal + "8" };
+            for (sizevalue i = 0; i < 300; ++i) {
+                // 一部分内容由字面量与随机字符拼接而成，使候选位置密集
+                byte_array content;
+                while (content.size() < random() % 200) {
+                    content += random() % 2 == 0 ? prefilter.literal : random_text(random, alphabet, 1 + random() % 3);
+                }
+                contents.push_back(i % 2 == 0 ? content : random_text(random, alphabet, random() % 200));
+            }
+            for (const byte_array& content : contents) {
+                vector<std::pair<sizevalue, sizevalue>> matches;
+                vector<vector<std::pair<sizevalue, sizevalue>>> captures;
+                find_matches(content, re, prefilter, matches, captures);
+                vector<std::pair<sizevalue, sizevalue>> expected_matches;
+                vector<vector<std::pair<sizevalue, sizevalue>>> expected_captures;
+                for (auto it = std::sregex_iterator(content.begin(), content.end(), re); it != std::sregex_iterator(); ++it) {
+                    expected_matches.emplace_back(it->position(), it->length());
+                    expected_captures.emplace_back();
+                    for (sizevalue k = 1; k < it->size(); ++k) {
+                        expected_captures.back().emplace_back((*it)[k].matched ? std::pair<sizevalue, sizevalue>(it->position(k), it->length(k)) : std::pair<sizevalue, sizevalue>(byte_array::npos, 0));
+                    }
+                }
+                prefiltered = prefiltered and matches == expected_matches and captures == expected_captures;
+            }
+        }
+    }
+    std::cout << prefiltered << std::endl;
+
+    // 预编译的替换模板：含字面量片段、重复与乱序的 "@N#" 以及 "@名称#" 的模板，append_replacement 成功时
+    // 追加的内容与逐个匹配展开 (expand_target) 的结果相同；所引用的捕获组都已匹配且不含 '@' 时必须成功
+    bool templated = true;
+    {
+        rule_set rules = parse_rule_file(
+            "define N [0-9]+\n"
+            "define M @N#_(a|b)\n"
+            "replace T1 x => <@1#>\n"
+            "replace T2 x => @2#@1#@2#\n"
+            "replace T3 x => @3#-@1#:@N#\n"
+            "replace T4 x => @M#@1#@1#@M#\n"
+            "replace T5 x => [@N#]@2#{@M#}@3#@2#\n"
+            "replace T6 x => @1#@2#@3#\n"
+            "replace T7 x => 1#@3#@#@2#\n"
+            "execute T1\n", "tests");
+        install_rules(std::move(rules.commands), std::move(rules.executables));
+        const byte_array alphabet = "ab01#@_N\n";
+        for (const auto& [name, cmdv] : current_commands()) {
+            if (cmdv.type != command_type::REPLACE_COMMAND) {
+                continue;
+            }
+            const replacement_template& compiled_target = compile_command(cmdv).target;
+            byte_array target = static_cast<replace_command*>(cmdv.ptr.get())->target;
+            // T7 含有不属于 "@名称#" 的 '@'，只能逐个展开
+            templated = templated and compiled_target.precompiled == (target.find("@#") == byte_array::npos);
+            if (not compiled_target.precompiled) {
+                continue;
+            }
+            for (sizevalue i = 0; i < 500; ++i) {
+                byte_array content = random_text(random, alphabet, 1 + random() % 20);
+                vector<std::pair<sizevalue, sizevalue>> captures;
+                bool expandable = true;
+                for (sizevalue k = 0; k < 3; ++k) {
+                    if (random() % 8 == 0) {
+                        captures.emplace_back(byte_array::npos, 0);
+                        expandable = false;
+                        continue;
+                    }
+                    sizevalue first = random() % (content.size() + 1);
+                    captures.emplace_back(first, random() % (content.size() - first + 1));
+                    expandable = expandable and content.substr(captures.back().first, captures.back().second).find('@') == byte_array::npos;
+                }
+                byte_array output = "prefix";
+                if (append_replacement(compiled_target, content, captures, output)) {
+                    templated = templated and output == "prefix" + expand_target(content, captures, target);
+                }
+                else {
+                    templated = templated and not expandable and output == "prefix";
+                }
+            }
+        }
+    }
+    std::cout << templated << std::endl;
+
+    // 规则文件与快照：parse_rule_file 的结果以及带文件名与行号的错误；rules/lean.rules 第一次载入 (解析并写入快照) 与
+    // 之后直接映射快照的转译结果都与内置规则逐字节相同；截断、版本不同或者原文不同 (散列值相同) 的快照不会被载入。
+    // 规则文件以相对路径打开，需要在 code-math 目录中运行
+    bool snapshotted = true;
+    {
+        rule_set rules = parse_rule_file("# 注释\r\n\r\ndefine D [0-9]\r\n  replace A a@D# => b => c\nexecute A\nexecute D A\n", "tests.rules");
+        const commmand_value& a = rules.commands[fixed_length("A")];
+        const commmand_value& d = rules.commands[fixed_length("D")];
+        snapshotted = rules.commands.size() == 2 and a.type == command_type::REPLACE_COMMAND and d.type == command_type::DEFINE_COMMAND
+            and a.ptr->pattern == "a@D#" and static_cast<replace_command*>(a.ptr.get())->target == "b => c" and d.ptr->pattern == "[0-9]"
+            and rules.executables.size() == 3 and rules.executables[0].ptr == a.ptr and rules.executables[1].ptr == d.ptr and rules.executables[2].ptr == a.ptr;
+
+        auto error_of = [](const char* text) -> byte_array {
+            try {
+                parse_rule_file(text, "tests.rules");
+            }
+            catch (const std::invalid_argument& e) {
+                return e.what();
+            }
+            return {};
+        };
+        const vector<std::pair<const char*, sizevalue>> malformed = {
+            { "define A x\nfoo B y\n", 2 }, { "# 注释\n\nreplace A x y\n", 3 }, { "define A x\ndefine A y\n", 2 },
+            { "execute B\ndefine A x\n", 1 }, { "define A x\ndefine 9a x\n", 2 }, { "define A x\nexecute\n", 2 },
+            { "define A\n", 1 }, { "define A x\nexecute A b-c\n", 2 },
+        };
+        for (const auto& [text, line] : malformed) {
+            snapshotted = snapshotted and error_of(text).starts_with("规则文件 tests.rules 第 " + std::to_string(line) + " 行：");
+        }
+
+        namespace fs = std::filesystem;
+        const fs::path cache = fs::temp_directory_path() / ("code-math-tests-" + std::to_string(getpid()));
+        fs::remove_all(cache);
+        setenv("XDG_CACHE_HOME", cache.c_str(), 1);
+        std::ifstream file("rules/lean.rules", std::ios::binary);
+        std::ostringstream text;
+        text << file.rdbuf();
+        const byte_array source = text.str();
+        const byte_array snapshot_path = rule_snapshot_path(fnv1a_hash(source));
+        for (sizevalue i = 0; i < 2; ++i) {
+            load_rules("rules/lean.rules");
+            byte_array output = SAMPLE_INPUT;
+            exectute(output);
+            snapshotted = snapshotted and file and output != SAMPLE_INPUT and output == builtin_output and fs::exists(snapshot_path);
+        }
+
+        std::ifstream snapshot(snapshot_path, std::ios::binary);
+        std::ostringstream snapshot_text;
+        snapshot_text << snapshot.rdbuf();
+        const byte_array bytes = snapshot_text.str();
+        // 与原文长度相同、散列值不同的来源；把快照中的散列值 (位于8字节的 magic 与两个 nat32 之后) 改为它的散列值
+        byte_array other_source = source;
+        other_source.back() = other_source.back() == '\n' ? ' ' : '\n';
+        natmax other_hash = fnv1a_hash(other_source);
+        byte_array other_hashed = bytes;
+        memcpy(other_hashed.data() + 16, &other_hash, sizeof(other_hash));
+        // 版本位于 magic 之后
+        byte_array other_version = bytes;
+        nat32 version = RULE_SNAPSHOT_VERSION + 1;
+        memcpy(other_version.data() + 8, &version, sizeof(version));
+        const vector<std::pair<byte_array, const byte_array*>> rejected = {
+            { bytes.substr(0, bytes.size() - 1), &source }, { bytes.substr(0, 40), &source }, { byte_array{}, &source },
+            { bytes + "x", &source }, { other_version, &source }, { other_hashed, &other_source },
+        };
+        const byte_array modified_path = (cache / "modified.snapshot").string();
+        rule_set small = parse_rule_file("replace A x => y\nexecute A\n", "tests.rules");
+        install_rules(std::move(small.commands), std::move(small.executables));
+        for (const auto& [content, expected_source] : rejected) {
+            std::ofstream(modified_path, std::ios::binary | std::ios::trunc) << content;
+            snapshotted = snapshotted and not load_rule_snapshot(modified_path, *expected_source) and current_commands().size() == 1;
+        }
+        // 未修改的快照可以再次载入，以它保存的规则集再写入的快照逐字节相同
+        std::ofstream(modified_path, std::ios::binary | std::ios::trunc) << bytes;
+        snapshotted = snapshotted and load_rule_snapshot(modified_path, source) and current_commands().size() > 1
+            and save_rule_snapshot(modified_path, source);
+        std::ifstream saved(modified_path, std::ios::binary);
+        std::ostringstream saved_text;
+        saved_text << saved.rdbuf();
+        byte_array output = SAMPLE_INPUT;
+        exectute(output);
+        snapshotted = snapshotted and saved_text.str() == bytes and output == builtin_output;
+        fs::remove_all(cache);
+    }
+    std::cout << snapshotted << std::endl;
+    return 0;
+}
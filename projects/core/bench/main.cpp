@@ -0,0 +1,413 @@
+#include <basic>
+#include <numerical-cell>
+#include <bit-span>
+#include <fixed-string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <random>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <cstring>
+
+using std::vector;
+
+// core 的基准测试：逐个运行基准用例，以 JSON 输出每次操作的耗时 (纳秒)，并可以与保存的基线比较
+// 用法: core-bench [--filter 子串] [--output 文件] [--compare 基线文件] [--threshold 比例] [--min-time 毫秒]
+//   --filter     只运行名称中含有该子串的用例
+//   --output     把 JSON 写入文件 (默认写到标准输出)
+//   --compare    与基线比较，耗时超过基线 (1 + threshold) 倍的用例视为退化，报告写到标准错误，存在退化时返回1
+//   --threshold  退化的判定比例，默认为 0.10
+//   --min-time   每个用例至少运行的时间，默认为 100 毫秒
+
+// 一个基准用例：run(iterations) 执行 iterations 次被测操作
+struct benchmark_case
+{
+    byte_array name;
+    std::function<void(sizevalue)> run;
+};
+
+struct benchmark_result
+{
+    byte_array name;
+    sizevalue iterations;
+    float64 nanoseconds_per_operation;
+};
+
+// 阻止编译器把结果未被使用的操作优化掉
+template<typename T>
+void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// 被测的值所用的单元数，覆盖单个单元到数论变换乘法的范围
+const vector<sizevalue> LIMB_COUNTS = { 1, 2, 4, 8, 16, 64, 256, 1024, 4096, 10000 };
+
+// 状态数的形态：2 的幂 (屏蔽高位)，形如 2^k - c 的伪梅森数 (素数域常用的形式，折叠相加)，高位与低位都随机的稠密数 (长除法)
+enum class bound_kind
+{
+    POWER_OF_TWO,
+    PSEUDO_MERSENNE,
+    DENSE
+};
+
+const char* name_of(bound_kind kind)
+{
+    switch (kind) {
+    case bound_kind::POWER_OF_TWO:
+        return "power-of-two";
+    case bound_kind::PSEUDO_MERSENNE:
+        return "pseudo-mersenne";
+    default:
+        return "dense";
+    }
+}
+
+// 返回 limbs 个单元的值所对应的状态数
+vector<natmax> make_bound(bound_kind kind, sizevalue limbs, std::mt19937_64& random)
+{
+    vector<natmax> bound(limbs, 0);
+    switch (kind) {
+    case bound_kind::POWER_OF_TWO:
+        bound.push_back(1);
+        break;
+    case bound_kind::PSEUDO_MERSENNE:
+        std::fill(bound.begin(), bound.end(), natmax_max);
+        bound.front() = natmax_max - 188; // 2^{64 limbs} - 189
+        break;
+    case bound_kind::DENSE:
+        for (natmax& part : bound) {
+            part = random();
+        }
+        bound.back() |= static_cast<natmax>(1) << 63;
+        bound.front() |= 1;
+        break;
+    }
+    return bound;
+}
+
+// 返回 limbs 个单元、小于任一上述状态数的随机值
+vector<natmax> make_value(sizevalue limbs, std::mt19937_64& random)
+{
+    vector<natmax> value(limbs, 0);
+    for (natmax& part : value) {
+        part = random();
+    }
+    value.back() >>= 1;
+    return value;
+}
+
+void add_numerical_cell_cases(vector<benchmark_case>& cases)
+{
+    for (bound_kind kind : { bound_kind::POWER_OF_TWO, bound_kind::PSEUDO_MERSENNE, bound_kind::DENSE }) {
+        for (sizevalue limbs : LIMB_COUNTS) {
+            byte_array suffix = byte_array("/") + name_of(kind) + "/" + std::to_string(limbs);
+            std::mt19937_64 random(limbs * 3 + static_cast<sizevalue>(kind));
+            vector<natmax> bound = make_bound(kind, limbs, random);
+            NC left(vector<natmax>(bound), make_value(limbs, random));
+            NC right(vector<natmax>(bound), make_value(limbs, random));
+            // 除数取一半的单元数，使商与余数都不平凡
+            NC divisor(vector<natmax>(bound), make_value((limbs + 1) / 2, random));
+            // 赋值的输入的单元数为状态数的两倍，需要取模
+            vector<natmax> wide_value = make_value(limbs * 2, random);
+
+            cases.push_back({ "numerical_cell/add" + suffix, [left, right](sizevalue iterations) mutable {
+                for (sizevalue i = 0; i < iterations; ++i) {
+                    left += right;
+                }
+                do_not_optimize(left.value().data());
+            } });
+            cases.push_back({ "numerical_cell/subtract" + suffix, [left, right](sizevalue iterations) mutable {
+                for (sizevalue i = 0; i < iterations; ++i) {
+                    left -= right;
+                }
+                do_not_optimize(left.value().data());
+            } });
+            cases.push_back({ "numerical_cell/multiply" + suffix, [left, right](sizevalue iterations) mutable {
+                for (sizevalue i = 0; i < iterations; ++i) {
+                    left *= right;
+                }
+                do_not_optimize(left.value().data());
+            } });
+            // 除法与取模会改变被除数，每次先复制一份 (复制不重新分配内存，耗时相对于除法可以忽略)
+            cases.push_back({ "numerical_cell/divide" + suffix, [left, divisor](sizevalue iterations) {
+                NC quotient = left;
+                for (sizevalue i = 0; i < iterations; ++i) {
+                    quotient = left;
+                    quotient /= divisor;
+                }
+                do_not_optimize(quotient.value().data());
+            } });
+            cases.push_back({ "numerical_cell/modulo" + suffix, [left, divisor](sizevalue iterations) {
+                NC remainder = left;
+                for (sizevalue i = 0; i < iterations; ++i) {
+                    remainder = left;
+                    remainder %= divisor;
+                }
+                do_not_optimize(remainder.value().data());
+            } });
+            // 二元运算：每次复制左操作数并返回新的数胞，与复合赋值比较可以看出复制与前置条件检查的开销
+            cases.push_back({ "numerical_cell/binary-add" + suffix, [left, right](sizevalue iterations) {
+                for (sizevalue i = 0; i < iterations; ++i) {
+                    NC sum = left + right;
+                    do_not_optimize(sum.value().data());
+                }
+            } });
+            cases.push_back({ "numerical_cell/binary-subtract" + suffix, [left, right](sizevalue iterations) {
+                for (sizevalue i = 0; i < iterations; ++i) {
+                    NC difference = left - right;
+                    do_not_optimize(difference.value().data());
+                }
+            } });
+            cases.push_back({ "numerical_cell/binary-multiply" + suffix, [left, right](sizevalue iterations) {
+                for (sizevalue i = 0; i < iterations; ++i) {
+                    NC product = left * right;
+                    do_not_optimize(product.value().data());
+                }
+            } });
+            cases.push_back({ "numerical_cell/binary-divide" + suffix, [left, divisor](sizevalue iterations) {
+                for (sizevalue i = 0; i < iterations; ++i) {
+                    NC quotient = left / divisor;
+                    do_not_optimize(quotient.value().data());
+                }
+            } });
+            cases.push_back({ "numerical_cell/binary-modulo" + suffix, [left, divisor](sizevalue iterations) {
+                for (sizevalue i = 0; i < iterations; ++i) {
+                    NC remainder = left % divisor;
+                    do_not_optimize(remainder.value().data());
+                }
+            } });
+            cases.push_back({ "numerical_cell/compare" + suffix, [left, right](sizevalue iterations) {
+                sizevalue less = 0;
+                for (sizevalue i = 0; i < iterations; ++i) {
+                    less += (left <=> right) < 0;
+                    do_not_optimize(less);
+                }
+            } });
+            cases.push_back({ "numerical_cell/assign" + suffix, [left, wide_value](sizevalue iterations) mutable {
+                for (sizevalue i = 0; i < iterations; ++i) {
+                    left = span<natmax>(wide_value);
+                }
+                do_not_optimize(left.value().data());
+            } });
+        }
+    }
+}
+
+void add_bit_span_cases(vector<benchmark_case>& cases)
+{
+    for (sizevalue bytes : { 64, 4096, 262144 }) {
+        std::mt19937_64 random(bytes);
+        vector<unsigned char> buffer(bytes);
+        for (unsigned char& part : buffer) {
+            part = static_cast<unsigned char>(random());
+        }
+        byte_array suffix = "/" + std::to_string(bytes * 8);
+        // 逐比特遍历，统计1的个数
+        cases.push_back({ "bit_span/iterate" + suffix, [buffer](sizevalue iterations) mutable {
+            bit_span bits(buffer.data(), 0, buffer.size() * 8);
+            for (sizevalue i = 0; i < iterations; ++i) {
+                sizevalue ones = 0;
+                for (bool bit : bits) {
+                    ones += bit;
+                }
+                do_not_optimize(ones);
+            }
+        } });
+        // 取不对齐的子跨度并读取其首尾比特
+        cases.push_back({ "bit_span/subspan" + suffix, [buffer](sizevalue iterations) mutable {
+            bit_span bits(buffer.data(), 0, buffer.size() * 8);
+            sizevalue total = bits.size();
+            sizevalue ones = 0;
+            for (sizevalue i = 0; i < iterations; ++i) {
+                sizevalue offset = (i * 7) % (total / 2);
+                bit_span part = bits.subspan(offset + 3, total / 2 - 5);
+                ones += part.front() + part.back();
+            }
+            do_not_optimize(ones);
+        } });
+    }
+}
+
+void add_transcoding_cases(vector<benchmark_case>& cases)
+{
+    // 各语料约 64 KiB
+    const byte_array ascii_unit = "The quick brown fox jumps over the lazy dog. 0123456789\n";
+    const byte_array cjk_unit = "数胞是状态数有限的自然数，运算的结果总是被限制在状态数之中。";
+    const byte_array mixed_unit = "定理 theorem: ∀x ∈ ℕ, x + 0 = x。证明 proof 见下文 (see below)。\n";
+    const sizevalue corpus_bytes = 65536;
+    for (const auto& [name, unit] : { std::pair<const char*, byte_array>{ "ascii", ascii_unit }, { "cjk", cjk_unit }, { "mixed", mixed_unit } }) {
+        byte_array corpus;
+        while (corpus.size() < corpus_bytes) {
+            corpus += unit;
+        }
+        str decoded = fixed_length(corpus);
+        cases.push_back({ byte_array("string/fixed_length/") + name, [corpus](sizevalue iterations) {
+            for (sizevalue i = 0; i < iterations; ++i) {
+                str result = fixed_length(corpus);
+                do_not_optimize(result.data());
+            }
+        } });
+        cases.push_back({ byte_array("string/variable_length/") + name, [decoded](sizevalue iterations) {
+            for (sizevalue i = 0; i < iterations; ++i) {
+                byte_array result = variable_length(decoded);
+                do_not_optimize(result.data());
+            }
+        } });
+    }
+}
+
+// 逻辑规范：
+// 前置条件 P: min_time > 0
+// 后置条件 Q: 不断增加执行次数直到一次计时不少于 min_time，返回该次计时中每次操作的平均耗时
+benchmark_result measure(const benchmark_case& current, std::chrono::nanoseconds min_time)
+{
+    sizevalue iterations = 1;
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        current.run(iterations);
+        std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed >= min_time) {
+            return { current.name, iterations, static_cast<float64>(elapsed.count()) / iterations };
+        }
+        // 按已测得的速度估计所需的次数，多估计 40%，并限制每轮的增长倍数
+        float64 ratio = elapsed.count() == 0 ? 10.0 : static_cast<float64>(min_time.count()) / elapsed.count() * 1.4;
+        iterations = static_cast<sizevalue>(iterations * std::min(std::max(ratio, 2.0), 10.0));
+    }
+}
+
+void write_json(std::ostream& out, const vector<benchmark_result>& results)
+{
+    // 每个结果独占一行，compare 模式按行读取
+    out << "{\n    \"benchmarks\": [\n";
+    for (sizevalue i = 0; i < results.size(); ++i) {
+        out << "        {\"name\": \"" << results[i].name << "\", \"iterations\": " << results[i].iterations
+            << ", \"nanoseconds_per_operation\": " << std::setprecision(6) << results[i].nanoseconds_per_operation << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "    ]\n}\n";
+}
+
+// 读取由 write_json 写出的文件，返回用例名称到每次操作耗时的映射
+std::map<byte_array, float64> read_json(std::istream& in)
+{
+    std::map<byte_array, float64> baseline;
+    const byte_array name_key = "\"name\": \"";
+    const byte_array time_key = "\"nanoseconds_per_operation\": ";
+    byte_array line;
+    while (std::getline(in, line)) {
+        sizevalue name_position = line.find(name_key);
+        sizevalue time_position = line.find(time_key);
+        if (name_position == byte_array::npos or time_position == byte_array::npos) {
+            continue;
+        }
+        name_position += name_key.size();
+        byte_array name = line.substr(name_position, line.find('"', name_position) - name_position);
+        baseline[name] = std::stod(line.substr(time_position + time_key.size()));
+    }
+    return baseline;
+}
+
+// 返回退化的用例数
+sizevalue compare(const vector<benchmark_result>& results, const std::map<byte_array, float64>& baseline, float64 threshold)
+{
+    sizevalue regressions = 0;
+    std::cerr << std::left << std::setw(48) << "name" << std::right << std::setw(16) << "baseline (ns)" << std::setw(16) << "current (ns)" << std::setw(10) << "change" << "\n";
+    for (const benchmark_result& result : results) {
+        auto found = baseline.find(result.name);
+        if (found == baseline.end()) {
+            std::cerr << std::left << std::setw(48) << result.name << std::right << std::setw(16) << "-" << std::setw(16) << result.nanoseconds_per_operation << std::setw(10) << "new" << "\n";
+            continue;
+        }
+        float64 change = result.nanoseconds_per_operation / found->second - 1.0;
+        bool regressed = change > threshold;
+        regressions += regressed;
+        std::ostringstream percentage;
+        percentage << std::showpos << std::fixed << std::setprecision(1) << change * 100 << "%";
+        std::cerr << std::left << std::setw(48) << result.name << std::right << std::setw(16) << found->second << std::setw(16) << result.nanoseconds_per_operation
+            << std::setw(10) << percentage.str() << (regressed ? "  REGRESSION" : "") << "\n";
+    }
+    std::cerr << regressions << " regression(s) over " << threshold * 100 << "%\n";
+    return regressions;
+}
+
+int32 main(int32 argc, char** argv)
+{
+    byte_array filter;
+    byte_array output_path;
+    byte_array baseline_path;
+    float64 threshold = 0.10;
+    std::chrono::nanoseconds min_time = std::chrono::milliseconds(100);
+    for (int32 i = 1; i < argc; ++i) {
+        byte_array option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "选项 " << option << " 缺少参数\n";
+            return 2;
+        }
+        byte_array argument = argv[++i];
+        if (option == "--filter") {
+            filter = argument;
+        }
+        else if (option == "--output") {
+            output_path = argument;
+        }
+        else if (option == "--compare") {
+            baseline_path = argument;
+        }
+        else if (option == "--threshold") {
+            threshold = std::stod(argument);
+        }
+        else if (option == "--min-time") {
+            min_time = std::chrono::milliseconds(std::stoll(argument));
+        }
+        else {
+            std::cerr << "未知的选项 " << option << "\n";
+            return 2;
+        }
+    }
+
+    vector<benchmark_case> cases;
+    add_numerical_cell_cases(cases);
+    add_bit_span_cases(cases);
+    add_transcoding_cases(cases);
+
+    vector<benchmark_result> results;
+    for (const benchmark_case& current : cases) {
+        if (not filter.empty() and current.name.find(filter) == byte_array::npos) {
+            continue;
+        }
+        results.push_back(measure(current, min_time));
+        std::cerr << results.back().name << ": " << results.back().nanoseconds_per_operation << " ns\n";
+    }
+
+    if (output_path.empty()) {
+        write_json(std::cout, results);
+    }
+    else {
+        std::ofstream out(output_path);
+        write_json(out, results);
+        if (not out) {
+            std::cerr << "无法写入 " << output_path << "\n";
+            return 2;
+        }
+    }
+
+    if (not baseline_path.empty()) {
+        std::ifstream in(baseline_path);
+        if (not in) {
+            std::cerr << "无法读取基线 " << baseline_path << "\n";
+            return 2;
+        }
+        return compare(results, read_json(in), threshold) == 0 ? 0 : 1;
+    }
+    return 0;
+}
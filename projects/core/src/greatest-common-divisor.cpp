@@ -0,0 +1,447 @@
+#include <greatest-common-divisor>
+#include <limb-arithmetic>
+#include <runtime-exception>
+#include <memory-resource>
+#include <algorithm>
+#include <stdexcept>
+#include <bit>
+
+using std::vector;
+using std::span;
+using std::invalid_argument;
+using std::min;
+using std::max;
+
+// Lehmer 算法中取出的最高位数：设 β = 2^61，模拟过程中的余数与矩阵元素的绝对值都不超过 β，
+// 算法 L 中的中间结果不超过 2β，因此全部运算都在 intmax 的范围内，不需要 128 位整数
+constexpr sizevalue LEHMER_LEADING_BITS = 61;
+
+static sizevalue significant_length(const span<natmax> parts) noexcept
+{
+	sizevalue length = parts.size();
+	while (length > 0 and parts[length - 1] == 0) {
+		--length;
+	}
+	return length;
+}
+
+// 逻辑规范：
+// 前置条件 P: 无 (两者皆可以含有高位0)
+// 后置条件 Q: 返回 left < right
+static bool is_less_than(const span<natmax> left, const span<natmax> right) noexcept
+{
+	sizevalue left_length = significant_length(left);
+	sizevalue right_length = significant_length(right);
+	if (left_length != right_length) {
+		return left_length < right_length;
+	}
+	for (sizevalue i = left_length - 1; i < left_length; --i) {
+		if (left[i] != right[i]) {
+			return left[i] < right[i];
+		}
+	}
+	return false;
+}
+
+// 逻辑规范：
+// 前置条件 P: subtrahend.size() <= target.size()，且 subtrahend <= target
+// 后置条件 Q: target <- target - subtrahend
+static void subtract_parts(span<natmax> target, const span<natmax> subtrahend) noexcept
+{
+	nat8 borrow = 0;
+	for (sizevalue i = 0; i < subtrahend.size(); ++i) {
+		target[i] = subtract_with_borrow(target[i], subtrahend[i], borrow);
+	}
+	for (sizevalue i = subtrahend.size(); borrow == 1 and i < target.size(); ++i) {
+		target[i] = subtract_with_borrow(target[i], 0, borrow);
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: parts 不为0
+// 后置条件 Q: 返回 parts 的最低位1以下0的个数
+static sizevalue count_trailing_zeros(const span<natmax> parts) noexcept
+{
+	sizevalue index = 0;
+	while (parts[index] == 0) {
+		++index;
+	}
+	return index * sizeof(natmax) * WORD_SIZE + std::countr_zero(parts[index]);
+}
+
+// 逻辑规范：
+// 前置条件 P: 无
+// 后置条件 Q: parts <- parts 整除 2^shift
+static void shift_right_by_bits(span<natmax> parts, sizevalue shift) noexcept
+{
+	sizevalue limbs = min(shift / (sizeof(natmax) * WORD_SIZE), parts.size());
+	std::copy(parts.begin() + limbs, parts.end(), parts.begin());
+	std::fill(parts.end() - limbs, parts.end(), 0);
+	shift_right_in_place(parts, shift % (sizeof(natmax) * WORD_SIZE));
+}
+
+// 逻辑规范：
+// 前置条件 P: parts * 2^shift < B^{parts.size()}
+// 后置条件 Q: parts <- parts * 2^shift
+static void shift_left_by_bits(span<natmax> parts, sizevalue shift) noexcept
+{
+	sizevalue limbs = min(shift / (sizeof(natmax) * WORD_SIZE), parts.size());
+	std::copy_backward(parts.begin(), parts.end() - limbs, parts.end());
+	std::fill(parts.begin(), parts.begin() + limbs, 0);
+	shift_left_in_place(parts, shift % (sizeof(natmax) * WORD_SIZE));
+}
+
+// 二进制算法 (Stein)：gcd(2^i * u, 2^j * v) = 2^{min(i, j)} * gcd(u, v)，对奇数 u <= v 有 gcd(u, v) = gcd(u, (v - u) / 2^k)
+// 逻辑规范：
+// 前置条件 P: left.size() = right.size()
+// 后置条件 Q: left <- gcd(left, right)，right 被改变
+static void binary_gcd(span<natmax> left, span<natmax> right) noexcept
+{
+	if (significant_length(right) == 0) {
+		return;
+	}
+	if (significant_length(left) == 0) {
+		std::copy(right.begin(), right.end(), left.begin());
+		return;
+	}
+	sizevalue zeros_of_left = count_trailing_zeros(left);
+	sizevalue zeros_of_right = count_trailing_zeros(right);
+	shift_right_by_bits(left, zeros_of_left);
+	shift_right_by_bits(right, zeros_of_right);
+	if (significant_length(left) <= 1 and significant_length(right) <= 1) {
+		// 单个单元时直接在寄存器中计算
+		natmax u = left.front();
+		natmax v = right.front();
+		// 循环不变式：u, v 皆为奇数
+		while (u != v) {
+			if (u > v) {
+				std::swap(u, v);
+			}
+			v -= u;
+			v >>= std::countr_zero(v);
+		}
+		left.front() = u;
+	}
+	else {
+		span<natmax> u = left;
+		span<natmax> v = right;
+		// 循环不变式：u, v 皆为奇数
+		while (true) {
+			if (is_less_than(v, u)) {
+				std::swap(u, v);
+			}
+			subtract_parts(v, u);
+			if (significant_length(v) == 0) {
+				break;
+			}
+			shift_right_by_bits(v, count_trailing_zeros(v));
+		}
+		if (u.data() != left.data()) {
+			std::copy(u.begin(), u.end(), left.begin());
+		}
+	}
+	shift_left_by_bits(left, min(zeros_of_left, zeros_of_right));
+}
+
+// 逻辑规范：
+// 前置条件 P: first_factor * first >= second_factor * second，且两者之差小于 B^{result.size()}，first, second 的单元数不少于 result.size()
+// 后置条件 Q: result <- first_factor * first - second_factor * second (只计算 result.size() 个单元)
+static void multiply_subtract(span<natmax> result, natmax first_factor, const span<natmax> first, natmax second_factor, const span<natmax> second) noexcept
+{
+	natmax carry_of_first = 0;
+	natmax carry_of_second = 0;
+	nat8 borrow = 0;
+	for (sizevalue i = 0; i < result.size(); ++i) {
+		natmax minuend = multiply_add(first_factor, first[i], 0, carry_of_first);
+		natmax subtrahend = multiply_add(second_factor, second[i], 0, carry_of_second);
+		result[i] = subtract_with_borrow(minuend, subtrahend, borrow);
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: first_factor * first + second_factor * second < B^{result.size()}，first, second 的单元数与 result 相同
+// 后置条件 Q: result <- first_factor * first + second_factor * second
+static void multiply_add_pair(span<natmax> result, natmax first_factor, const span<natmax> first, natmax second_factor, const span<natmax> second) noexcept
+{
+	natmax carry_of_first = 0;
+	natmax carry_of_second = 0;
+	nat8 carry = 0;
+	for (sizevalue i = 0; i < result.size(); ++i) {
+		natmax left_term = multiply_add(first_factor, first[i], 0, carry_of_first);
+		natmax right_term = multiply_add(second_factor, second[i], 0, carry_of_second);
+		result[i] = add_with_carry(left_term, right_term, carry);
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: 无
+// 后置条件 Q: 返回 parts 从第 shift 位起的 LEHMER_LEADING_BITS 位
+static natmax leading_bits(const span<natmax> parts, sizevalue shift) noexcept
+{
+	sizevalue index = shift / (sizeof(natmax) * WORD_SIZE);
+	sizevalue offset = shift % (sizeof(natmax) * WORD_SIZE);
+	natmax bits = index < parts.size() ? parts[index] >> offset : 0;
+	if (offset != 0 and index + 1 < parts.size()) {
+		bits |= parts[index + 1] << (sizeof(natmax) * WORD_SIZE - offset);
+	}
+	return bits & ((static_cast<natmax>(1) << LEHMER_LEADING_BITS) - 1);
+}
+
+// 欧几里得算法的工作空间，所有缓冲区在开始时一次性分配 (单元数相同，最高单元恒为0，供长除法规范化使用)，之后只交换不重新分配
+// 记录系数时的循环不变式：a = s_a * left (mod right)，b = s_b * left (mod right)，s_a 与 s_b 异号或者其一为0，
+//   cofactor_of_a = |s_a|，cofactor_of_b = |s_b|，cofactor_of_a_is_negative 表示 s_a < 0 (此时 s_b >= 0，否则 s_b <= 0)
+struct euclid_workspace
+{
+	scratch_vector a;
+	scratch_vector b;
+	scratch_vector next_a;
+	scratch_vector next_b;
+	scratch_vector quotient;
+	scratch_vector divisor;
+	sizevalue active_length = 0; // 四个值缓冲区中下标不小于此值的单元皆为0
+	bool track_cofactors = false;
+	scratch_vector cofactor_of_a;
+	scratch_vector cofactor_of_b;
+	scratch_vector next_cofactor_of_a;
+	scratch_vector next_cofactor_of_b;
+	bool cofactor_of_a_is_negative = false;
+};
+
+// 逻辑规范：
+// 前置条件 P: left, right 为两个值 (可以含有高位0)
+// 后置条件 Q: 为计算 gcd(left, right) 准备好工作空间，a >= b
+static void prepare_workspace(euclid_workspace& workspace, const span<natmax> left, const span<natmax> right, bool track_cofactors)
+{
+	sizevalue length_of_left = significant_length(left);
+	sizevalue length_of_right = significant_length(right);
+	sizevalue size = max<sizevalue>(max(length_of_left, length_of_right), 1) + 1;
+	workspace.a = make_scratch_vector(size);
+	workspace.b = make_scratch_vector(size);
+	workspace.next_a = make_scratch_vector(size);
+	workspace.next_b = make_scratch_vector(size);
+	workspace.quotient = make_scratch_vector(size);
+	workspace.divisor = make_scratch_vector(size);
+	workspace.active_length = size;
+	std::copy(left.begin(), left.begin() + length_of_left, workspace.a.begin());
+	std::copy(right.begin(), right.begin() + length_of_right, workspace.b.begin());
+	bool swapped = is_less_than(span<natmax>(workspace.a), span<natmax>(workspace.b));
+	if (swapped) {
+		workspace.a.swap(workspace.b);
+	}
+	workspace.track_cofactors = track_cofactors;
+	if (track_cofactors) {
+		// 系数的绝对值不超过 right，再多预留一个单元
+		sizevalue size_of_cofactor = max<sizevalue>(length_of_right, 1) + 1;
+		workspace.cofactor_of_a = make_scratch_vector(size_of_cofactor);
+		workspace.cofactor_of_b = make_scratch_vector(size_of_cofactor);
+		workspace.next_cofactor_of_a = make_scratch_vector(size_of_cofactor);
+		workspace.next_cofactor_of_b = make_scratch_vector(size_of_cofactor);
+		// left = 1 * left，right = 0 * left (mod right)
+		(swapped ? workspace.cofactor_of_b : workspace.cofactor_of_a).front() = 1;
+		workspace.cofactor_of_a_is_negative = swapped;
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: b 不为0，length_of_a, length_of_b 分别为 a, b 的有效单元数
+// 后置条件 Q: 设 a = q * b + r，(a, b) <- (b, r)，(s_a, s_b) <- (s_b, s_a - q * s_b)
+static void divide_step(euclid_workspace& workspace, sizevalue length_of_a, sizevalue length_of_b) noexcept
+{
+	// 长除法会规范化除数，因此除数使用副本；a 的最高单元之上至少有一个为0的单元
+	std::copy(workspace.b.begin(), workspace.b.begin() + length_of_b, workspace.divisor.begin());
+	span<natmax> quotient = span<natmax>(workspace.quotient).first(length_of_a + 1 - length_of_b);
+	divide_in_place(span<natmax>(workspace.a).first(length_of_a + 1), span<natmax>(workspace.divisor).first(length_of_b), quotient);
+	workspace.a.swap(workspace.b);
+	if (not workspace.track_cofactors) {
+		return;
+	}
+	// s_a 与 s_b 异号，因此 |s_a - q * s_b| = |s_a| + q * |s_b|
+	span<natmax> next_cofactor(workspace.next_cofactor_of_b);
+	span<natmax> cofactor_of_b(workspace.cofactor_of_b);
+	std::copy(workspace.cofactor_of_a.begin(), workspace.cofactor_of_a.end(), next_cofactor.begin());
+	sizevalue length_of_quotient = significant_length(quotient);
+	sizevalue length_of_cofactor = significant_length(cofactor_of_b);
+	// s_b = 0 (第一步) 时 q 可能远大于 right，不必也不能相乘
+	for (sizevalue i = 0; length_of_cofactor > 0 and i < length_of_quotient; ++i) {
+		natmax carry = 0;
+		for (sizevalue j = 0; j < length_of_cofactor; ++j) {
+			next_cofactor[i + j] = multiply_add(quotient[i], cofactor_of_b[j], next_cofactor[i + j], carry);
+		}
+		nat8 carry_of_add = 0;
+		next_cofactor[i + length_of_cofactor] = add_with_carry(next_cofactor[i + length_of_cofactor], carry, carry_of_add);
+		for (sizevalue k = i + length_of_cofactor + 1; carry_of_add == 1 and k < next_cofactor.size(); ++k) {
+			next_cofactor[k] = add_with_carry(next_cofactor[k], 0, carry_of_add);
+		}
+	}
+	workspace.cofactor_of_a.swap(workspace.cofactor_of_b);
+	workspace.cofactor_of_b.swap(workspace.next_cofactor_of_b);
+	workspace.cofactor_of_a_is_negative = not workspace.cofactor_of_a_is_negative;
+}
+
+// 逻辑规范：
+// 前置条件 P: 工作空间由 prepare_workspace 准备
+// 后置条件 Q: a <- gcd(a, b)，b <- 0；记录系数时 s_a 满足 a = s_a * left (mod right)
+static void run_euclid(euclid_workspace& workspace) noexcept
+{
+	// 循环不变式：a >= b，gcd(a, b) 不变
+	while (true) {
+		sizevalue length_of_b = significant_length(span<natmax>(workspace.b));
+		if (length_of_b == 0) {
+			return;
+		}
+		sizevalue length_of_a = significant_length(span<natmax>(workspace.a));
+		if (not workspace.track_cofactors and length_of_a <= GREATEST_COMMON_DIVISOR_BINARY_THRESHOLD) {
+			binary_gcd(span<natmax>(workspace.a), span<natmax>(workspace.b));
+			std::fill(workspace.b.begin(), workspace.b.end(), 0);
+			return;
+		}
+		// 取 a 最高的 LEHMER_LEADING_BITS 位与 b 在相同位置的位，模拟欧几里得算法，直到商可能与真实的商不同
+		sizevalue bit_length = (length_of_a - 1) * sizeof(natmax) * WORD_SIZE + std::bit_width(workspace.a[length_of_a - 1]);
+		sizevalue shift = bit_length > LEHMER_LEADING_BITS ? bit_length - LEHMER_LEADING_BITS : 0;
+		intmax x = static_cast<intmax>(leading_bits(span<natmax>(workspace.a), shift));
+		intmax y = static_cast<intmax>(leading_bits(span<natmax>(workspace.b), shift));
+		intmax A = 1, B = 0, C = 0, D = 1;
+		sizevalue steps = 0;
+		while (y + C > 0 and y + D > 0) {
+			intmax q = (x + A) / (y + C);
+			if (q != (x + B) / (y + D)) {
+				break;
+			}
+			intmax t = A - q * C;
+			A = C;
+			C = t;
+			t = B - q * D;
+			B = D;
+			D = t;
+			t = x - q * y;
+			x = y;
+			y = t;
+			++steps;
+		}
+		if (B == 0) {
+			// 第一个商就无法确定 (a 远大于 b)，做一次多精度除法
+			divide_step(workspace, length_of_a, length_of_b);
+			continue;
+		}
+		// 经过偶数步时 A, D >= 0 且 B, C <= 0，奇数步时相反，因此每个新值都是两项之差，每个新系数的绝对值都是两项之和
+		// (a, b) <- (A * a + B * b, C * a + D * b)，两者都不超过 a
+		natmax absolute_A = static_cast<natmax>(A < 0 ? -A : A);
+		natmax absolute_B = static_cast<natmax>(B < 0 ? -B : B);
+		natmax absolute_C = static_cast<natmax>(C < 0 ? -C : C);
+		natmax absolute_D = static_cast<natmax>(D < 0 ? -D : D);
+		span<natmax> a(workspace.a);
+		span<natmax> b(workspace.b);
+		span<natmax> next_a = span<natmax>(workspace.next_a).first(length_of_a);
+		span<natmax> next_b = span<natmax>(workspace.next_b).first(length_of_a);
+		if (steps % 2 == 0) {
+			multiply_subtract(next_a, absolute_A, a, absolute_B, b);
+			multiply_subtract(next_b, absolute_D, b, absolute_C, a);
+		}
+		else {
+			multiply_subtract(next_a, absolute_B, b, absolute_A, a);
+			multiply_subtract(next_b, absolute_C, a, absolute_D, b);
+		}
+		std::fill(workspace.next_a.begin() + length_of_a, workspace.next_a.begin() + workspace.active_length, 0);
+		std::fill(workspace.next_b.begin() + length_of_a, workspace.next_b.begin() + workspace.active_length, 0);
+		workspace.active_length = length_of_a;
+		workspace.a.swap(workspace.next_a);
+		workspace.b.swap(workspace.next_b);
+		if (workspace.track_cofactors) {
+			multiply_add_pair(span<natmax>(workspace.next_cofactor_of_a), absolute_A, span<natmax>(workspace.cofactor_of_a), absolute_B, span<natmax>(workspace.cofactor_of_b));
+			multiply_add_pair(span<natmax>(workspace.next_cofactor_of_b), absolute_C, span<natmax>(workspace.cofactor_of_a), absolute_D, span<natmax>(workspace.cofactor_of_b));
+			workspace.cofactor_of_a.swap(workspace.next_cofactor_of_a);
+			workspace.cofactor_of_b.swap(workspace.next_cofactor_of_b);
+			workspace.cofactor_of_a_is_negative = workspace.cofactor_of_a_is_negative != (steps % 2 == 1);
+		}
+	}
+}
+
+numerical_cell gcd(const numerical_cell& left, const numerical_cell& right)
+{
+	// 前置条件: not left.empty() and not right.empty()
+	runtime_assert(not left.empty() and not right.empty(), "gcd 的前置条件不被满足");
+	euclid_workspace workspace;
+	prepare_workspace(workspace, left.significant_value(), right.significant_value(), false);
+	run_euclid(workspace);
+	numerical_cell result(left);
+	result = span<natmax>(workspace.a);
+	return result;
+	// 后置条件: 返回 gcd(left, right)
+}
+
+extended_gcd_result extended_gcd(const numerical_cell& left, const numerical_cell& right)
+{
+	// 前置条件: not left.empty() and not right.empty() and 两者的状态数相同
+	runtime_assert(not left.empty() and not right.empty() and std::ranges::equal(left.number_of_states(), right.number_of_states()), "extended_gcd 的前置条件不被满足");
+	span<natmax> left_value = left.significant_value();
+	span<natmax> right_value = right.significant_value();
+	euclid_workspace workspace;
+	prepare_workspace(workspace, left_value, right_value, true);
+	run_euclid(workspace);
+	extended_gcd_result result{ left, left, workspace.cofactor_of_a_is_negative, left, false };
+	result.gcd = span<natmax>(workspace.a);
+	result.left_coefficient = span<natmax>(workspace.cofactor_of_a);
+	// y = (gcd - left * x) / right，整除；right 为0时 gcd = left，x = 1，y = 0
+	if (significant_length(right_value) == 0) {
+		natmax zero[1] = { 0 };
+		result.right_coefficient = span<natmax>(zero);
+		return result;
+	}
+	span<natmax> gcd_value(workspace.a);
+	span<natmax> x(workspace.cofactor_of_a);
+	// 分子 |gcd - left * x| 不超过 left * right，且不少于除数的单元数，再为长除法预留一个单元
+	scratch_vector numerator = make_scratch_vector(max(left_value.size() + x.size(), right_value.size()) + 1);
+	multiply_by_schoolbook(span<natmax>(numerator).first(left_value.size() + x.size()), left_value, x);
+	if (workspace.cofactor_of_a_is_negative) {
+		// gcd + left * |x|
+		nat8 carry = 0;
+		for (sizevalue i = 0; i < numerator.size(); ++i) {
+			numerator[i] = add_with_carry(numerator[i], i < gcd_value.size() ? gcd_value[i] : 0, carry);
+		}
+	}
+	else if (is_less_than(span<natmax>(numerator), gcd_value)) {
+		// 只在 x = 0 时出现：gcd - left * x = gcd
+		std::fill(numerator.begin(), numerator.end(), 0);
+		std::copy(gcd_value.begin(), gcd_value.begin() + significant_length(gcd_value), numerator.begin());
+	}
+	else {
+		subtract_parts(span<natmax>(numerator), gcd_value.first(significant_length(gcd_value)));
+		result.right_coefficient_is_negative = true;
+	}
+	scratch_vector divisor(right_value.begin(), right_value.end(), thread_local_pool());
+	scratch_vector quotient = make_scratch_vector(numerator.size() - divisor.size());
+	divide_in_place(span<natmax>(numerator), span<natmax>(divisor), span<natmax>(quotient));
+	result.right_coefficient = span<natmax>(quotient);
+	return result;
+	// 后置条件: result.gcd = left * (±result.left_coefficient) + right * (±result.right_coefficient)
+}
+
+numerical_cell inverse_mod(const numerical_cell& value, const numerical_cell& modulus)
+{
+	// 前置条件: not value.empty() and not modulus.empty() and modulus 的值不为0
+	span<natmax> modulus_value = modulus.significant_value();
+	runtime_assert(not value.empty() and not modulus.empty() and modulus_value.back() != 0, "inverse_mod 的前置条件不被满足");
+	numerical_cell result(vector<natmax>(modulus_value.begin(), modulus_value.end()), value.resource());
+	// 赋值时 value 的值会被限制在 modulus 的值中
+	result = value.significant_value();
+	euclid_workspace workspace;
+	prepare_workspace(workspace, result.significant_value(), modulus_value, true);
+	run_euclid(workspace);
+	span<natmax> gcd_value(workspace.a);
+	if (significant_length(gcd_value) != 1 or gcd_value.front() != 1) {
+		throw invalid_argument("inverse_mod 的参数与模数不互素，逆元不存在");
+	}
+	// x 为负时，逆元为 modulus - |x|
+	span<natmax> x(workspace.cofactor_of_a);
+	if (workspace.cofactor_of_a_is_negative) {
+		scratch_vector complement(modulus_value.begin(), modulus_value.end(), thread_local_pool());
+		complement.push_back(0);
+		subtract_parts(span<natmax>(complement), x.first(significant_length(x)));
+		result = span<natmax>(complement);
+	}
+	else {
+		result = x;
+	}
+	return result;
+	// 后置条件: 返回 value 模 modulus 的逆元
+}
@@ -0,0 +1,33 @@
+#include <memory-resource>
+
+using std::pmr::memory_resource;
+using std::pmr::monotonic_buffer_resource;
+using std::pmr::unsynchronized_pool_resource;
+using std::pmr::pool_options;
+
+// 单调内存池每次向全局堆申请的初始大小，之后按几何级数增长
+constexpr sizevalue INITIAL_SIZE_OF_ARENA = 64 * 1024;
+// 分级内存池管理的最大内存块，更大的请求直接交给全局堆
+constexpr sizevalue LARGEST_BLOCK_OF_POOL = 1024 * 1024;
+
+static monotonic_buffer_resource& arena() noexcept
+{
+    thread_local monotonic_buffer_resource resource(INITIAL_SIZE_OF_ARENA, std::pmr::new_delete_resource());
+    return resource;
+}
+
+memory_resource* thread_local_arena() noexcept
+{
+    return &arena();
+}
+
+void reset_thread_local_arena() noexcept
+{
+    arena().release();
+}
+
+memory_resource* thread_local_pool() noexcept
+{
+    thread_local unsynchronized_pool_resource resource(pool_options{ 0, LARGEST_BLOCK_OF_POOL }, std::pmr::new_delete_resource());
+    return &resource;
+}
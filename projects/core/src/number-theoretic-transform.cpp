@@ -0,0 +1,395 @@
+#include <number-theoretic-transform>
+#include <limb-arithmetic>
+#include <runtime-exception>
+#include <memory-resource>
+#include <vector>
+#include <bit>
+#include <thread>
+#include <barrier>
+#include <algorithm>
+#include <utility>
+
+using std::vector;
+using std::span;
+using std::pair;
+using std::thread;
+using std::barrier;
+using std::min;
+using std::max;
+
+// 形如 c * 2^k + 1 且小于 2^62 的素数所确定的有限域
+// 乘法使用 Montgomery 约简 (R = B = max(natmax) + 1)，不需要任何除法
+struct prime_field
+{
+	natmax prime;
+	natmax generator; // 乘法群的生成元
+	natmax negative_inverse; // -prime^{-1} mod B
+	natmax r_squared; // R^2 mod prime
+
+	constexpr prime_field(natmax prime, natmax generator) noexcept : prime(prime), generator(generator), negative_inverse(0), r_squared(0)
+	{
+		// 牛顿迭代：奇数 prime 满足 prime * prime ≡ 1 (mod 8)，每次迭代使正确的位数翻倍，3 -> 6 -> 12 -> 24 -> 48 -> 96
+		natmax inverse = prime;
+		for (sizevalue i = 0; i < 5; ++i) {
+			inverse *= 2 - prime * inverse;
+		}
+		negative_inverse = 0 - inverse;
+		// (0 - prime) mod prime = B mod prime，再倍增 64 次得到 R^2 mod prime
+		natmax r = (0 - prime) % prime;
+		r_squared = r;
+		for (sizevalue i = 0; i < sizeof(natmax) * WORD_SIZE; ++i) {
+			r_squared = add(r_squared, r_squared);
+		}
+	}
+
+	// 前置条件 P: left, right < prime
+	constexpr natmax add(natmax left, natmax right) const noexcept
+	{
+		natmax sum = left + right;
+		return sum >= prime ? sum - prime : sum;
+	}
+
+	// 前置条件 P: left, right < prime
+	constexpr natmax subtract(natmax left, natmax right) const noexcept
+	{
+		return left >= right ? left - right : left + prime - right;
+	}
+
+	// 前置条件 P: value < 2 * prime
+	constexpr natmax reduce_once(natmax value) const noexcept
+	{
+		return value >= prime ? value - prime : value;
+	}
+
+	// 逻辑规范：
+	// 前置条件 P: left * right < prime * B
+	// 后置条件 Q: 返回 left * right * R^{-1} mod prime
+	constexpr natmax multiply(natmax left, natmax right) const noexcept
+	{
+		natmax high = 0;
+		natmax low = multiply_with_high(left, right, high);
+		natmax m = low * negative_inverse;
+		natmax m_high = 0;
+		natmax m_low = multiply_with_high(m, prime, m_high);
+		// low + m_low ≡ 0 (mod B)，只需保留其进位
+		nat8 carry = 0;
+		add_with_carry(low, m_low, carry);
+		// (left * right + m * prime) / B < 2 * prime < 2^63，不会溢出
+		return reduce_once(high + m_high + carry);
+	}
+
+	// 返回 value * R mod prime (value 可以为任意单元)
+	constexpr natmax to_montgomery(natmax value) const noexcept
+	{
+		return multiply(value, r_squared);
+	}
+
+	// 前置条件 P: base 为 Montgomery 形式
+	// 后置条件 Q: 返回 base^exponent (Montgomery 形式)
+	constexpr natmax power(natmax base, natmax exponent) const noexcept
+	{
+		natmax result = to_montgomery(1);
+		while (exponent != 0) {
+			if ((exponent & 1) == 1) {
+				result = multiply(result, base);
+			}
+			base = multiply(base, base);
+			exponent >>= 1;
+		}
+		return result;
+	}
+
+	// 返回 value^{-1} mod prime (Montgomery 形式)，由费马小定理 value^{-1} = value^{prime - 2}
+	constexpr natmax inverse_of(natmax value) const noexcept
+	{
+		return power(to_montgomery(value), prime - 2);
+	}
+};
+
+// 三个素数按从大到小排列，使得任一素数都小于其后任一素数的两倍，还原时只需做一次条件减法
+static constexpr prime_field FIELDS[3] = {
+	prime_field(29 * (static_cast<natmax>(1) << 57) + 1, 3),
+	prime_field(163 * (static_cast<natmax>(1) << 54) + 1, 3),
+	prime_field(69 * (static_cast<natmax>(1) << 55) + 1, 5),
+};
+
+// Garner 算法使用的常数 (Montgomery 形式，与普通形式的数相乘后得到普通形式的积)
+static constexpr natmax INVERSE_OF_P0_IN_P1 = FIELDS[1].inverse_of(FIELDS[1].reduce_once(FIELDS[0].prime));
+static constexpr natmax P0_IN_P2 = FIELDS[2].to_montgomery(FIELDS[2].reduce_once(FIELDS[0].prime));
+static constexpr natmax INVERSE_OF_P0_P1_IN_P2 = FIELDS[2].inverse_of(FIELDS[2].multiply(P0_IN_P2, FIELDS[1].prime));
+
+// 按下标把 [0, total) 均分给 number_of_threads 个线程，返回第 index 个线程负责的区间 [first, second)
+static pair<sizevalue, sizevalue> partition(sizevalue total, sizevalue index, sizevalue number_of_threads) noexcept
+{
+	return { total * index / number_of_threads, total * (index + 1) / number_of_threads };
+}
+
+// 逻辑规范：
+// 前置条件 P: roots.size() 为2的幂且整除 field.prime - 1，1 <= first <= last <= roots.size()
+// 后置条件 Q: 对 [first, last) 中的每个下标 length + j (length 为2的幂，0 <= j < length)，
+//   roots[length + j] <- ω_{2 length}^j (当 inverse 为真时取其逆元，Montgomery 形式)
+static void prepare_roots(span<natmax> roots, const prime_field& field, bool inverse, sizevalue first, sizevalue last) noexcept
+{
+	for (sizevalue length = std::bit_floor(first); length < last; length *= 2) {
+		natmax root = field.power(field.to_montgomery(field.generator), (field.prime - 1) / (2 * length));
+		if (inverse) {
+			root = field.power(root, 2 * length - 1);
+		}
+		sizevalue begin = max(first, length);
+		sizevalue end = min(last, 2 * length);
+		natmax current = field.power(root, begin - length);
+		for (sizevalue position = begin; position < end; ++position) {
+			roots[position] = current;
+			current = field.multiply(current, root);
+		}
+	}
+}
+
+// 频域抽取的正变换中跨度为 length 的一层的第 [first, last) 个蝶形运算
+// 各层从 length = values.size() / 2 依次做到 length = 1，输入为自然顺序，输出为比特倒序
+static void transform_forward_layer(span<natmax> values, span<const natmax> roots, const prime_field& field, sizevalue length, sizevalue first, sizevalue last) noexcept
+{
+	for (sizevalue butterfly = first; butterfly < last; ++butterfly) {
+		sizevalue j = butterfly & (length - 1);
+		sizevalue position = (butterfly - j) * 2 + j;
+		natmax u = values[position];
+		natmax v = values[position + length];
+		values[position] = field.add(u, v);
+		values[position + length] = field.multiply(field.subtract(u, v), roots[length + j]);
+	}
+}
+
+// 时域抽取的逆变换 (不含除以变换长度的缩放) 中跨度为 length 的一层的第 [first, last) 个蝶形运算
+// 各层从 length = 1 依次做到 length = values.size() / 2，输入为比特倒序，输出为自然顺序
+static void transform_inverse_layer(span<natmax> values, span<const natmax> roots, const prime_field& field, sizevalue length, sizevalue first, sizevalue last) noexcept
+{
+	for (sizevalue butterfly = first; butterfly < last; ++butterfly) {
+		sizevalue j = butterfly & (length - 1);
+		sizevalue position = (butterfly - j) * 2 + j;
+		natmax u = values[position];
+		natmax v = field.multiply(values[position + length], roots[length + j]);
+		values[position] = field.add(u, v);
+		values[position + length] = field.subtract(u, v);
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: residue[k] < FIELDS[k].prime
+// 后置条件 Q: result <- 满足 result ≡ residue[k] (mod FIELDS[k].prime) 且小于三个素数之积的唯一的数 (3 个单元)
+static void recombine(natmax (&result)[3], const natmax (&residue)[3]) noexcept
+{
+	// result = residue[0] + p0 * t1 + p0 * p1 * t2
+	natmax t1 = FIELDS[1].multiply(FIELDS[1].subtract(residue[1], FIELDS[1].reduce_once(residue[0])), INVERSE_OF_P0_IN_P1);
+	natmax partial = FIELDS[2].add(FIELDS[2].reduce_once(residue[0]), FIELDS[2].multiply(t1, P0_IN_P2));
+	natmax t2 = FIELDS[2].multiply(FIELDS[2].subtract(residue[2], partial), INVERSE_OF_P0_P1_IN_P2);
+	// p0 * p1 < 2^124，可以用两个单元表示
+	natmax p0_p1_high = 0;
+	natmax p0_p1_low = multiply_with_high(FIELDS[0].prime, FIELDS[1].prime, p0_p1_high);
+	natmax carry = 0;
+	result[0] = multiply_add(FIELDS[0].prime, t1, residue[0], carry);
+	result[1] = carry;
+	result[2] = 0;
+	carry = 0;
+	natmax low = multiply_add(p0_p1_low, t2, 0, carry);
+	natmax carry_of_low = carry;
+	carry = 0;
+	natmax middle = multiply_add(p0_p1_high, t2, carry_of_low, carry);
+	nat8 carry_of_add = 0;
+	result[0] = add_with_carry(result[0], low, carry_of_add);
+	result[1] = add_with_carry(result[1], middle, carry_of_add);
+	result[2] = add_with_carry(result[2], carry, carry_of_add);
+}
+
+// 一个乘积区间对来自更低位的进位的作用：区间完成自身的进位后向更高位的进位为 carry，
+// 再加上来自更低位的进位 x (x < B^3) 时，向更高位的进位变为 carry + [x >= threshold] (没有 threshold 时视为无穷大)。
+// 这样的函数在复合下封闭且复合满足结合律，因此各区间的进位可以用前缀扫描并行求出
+struct carry_transfer
+{
+	natmax carry[3];
+	natmax threshold[3];
+	bool has_threshold;
+};
+
+// 三个单元的数的比较与加一 (加一不会溢出)
+static bool is_at_least(const natmax (&left)[3], const natmax (&right)[3]) noexcept
+{
+	for (sizevalue m = 3; m-- > 0;) {
+		if (left[m] != right[m]) {
+			return left[m] > right[m];
+		}
+	}
+	return true;
+}
+
+static void increment(natmax (&parts)[3]) noexcept
+{
+	nat8 carry = 1;
+	for (natmax& part : parts) {
+		part = add_with_carry(part, 0, carry);
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: lower 为较低的若干个区间的作用，upper 为紧接其后的若干个区间的作用
+// 后置条件 Q: 返回这些区间合起来的作用，即 x -> upper(lower(x))
+static carry_transfer compose(const carry_transfer& lower, const carry_transfer& upper) noexcept
+{
+	carry_transfer result = upper;
+	result.has_threshold = false;
+	if (not upper.has_threshold) {
+		return result;
+	}
+	// lower(x) 为 lower.carry 或 lower.carry + 1，后者只在 x >= lower.threshold 时出现
+	natmax incremented[3] = { lower.carry[0], lower.carry[1], lower.carry[2] };
+	increment(incremented);
+	if (is_at_least(lower.carry, upper.threshold)) {
+		increment(result.carry);
+	}
+	else if (lower.has_threshold and is_at_least(incremented, upper.threshold)) {
+		result.has_threshold = true;
+		std::copy(lower.threshold, lower.threshold + 3, result.threshold);
+	}
+	return result;
+}
+
+// 一次乘法中所有线程共享的数据，每个阶段各线程只写入自己负责的区间，阶段之间用 barrier 同步
+struct transform_context
+{
+	span<natmax> product;
+	span<natmax> left;
+	span<natmax> right;
+	sizevalue length_of_convolution;
+	sizevalue size; // 变换长度
+	bool is_square;
+	sizevalue number_of_threads;
+	// 临时空间都从调用线程的线程局部内存池分配，工作线程只读写而不分配
+	scratch_vector residues[3];
+	scratch_vector transformed_right;
+	scratch_vector roots;
+	std::pmr::vector<carry_transfer> transfers[2]; // 前缀扫描的两个缓冲区，每个线程负责的乘积区间各一项
+	barrier<> synchronization;
+
+	transform_context(span<natmax> product, span<natmax> left, span<natmax> right, sizevalue number_of_threads) :
+		product(product), left(left), right(right),
+		length_of_convolution(left.size() + right.size() - 1), size(std::bit_ceil(left.size() + right.size() - 1)),
+		is_square(left.data() == right.data() and left.size() == right.size()), number_of_threads(number_of_threads),
+		residues{ make_scratch_vector(size), make_scratch_vector(size), make_scratch_vector(size) },
+		transformed_right(is_square ? 0 : size, 0, thread_local_pool()), roots(make_scratch_vector(size)),
+		transfers{ std::pmr::vector<carry_transfer>(number_of_threads, thread_local_pool()), std::pmr::vector<carry_transfer>(number_of_threads, thread_local_pool()) },
+		synchronization(static_cast<std::ptrdiff_t>(number_of_threads))
+	{
+	}
+};
+
+// 第 index 个线程的工作，由所有线程共同执行
+static void run_transform(transform_context& context, sizevalue index) noexcept
+{
+	auto [first, last] = partition(context.size, index, context.number_of_threads);
+	auto [first_butterfly, last_butterfly] = partition(context.size / 2, index, context.number_of_threads);
+	for (sizevalue k = 0; k < 3; ++k) {
+		const prime_field& field = FIELDS[k];
+		span<natmax> values(context.residues[k]);
+		span<natmax> transformed_right(context.transformed_right);
+		for (sizevalue i = first; i < last; ++i) {
+			values[i] = i < context.left.size() ? context.left[i] % field.prime : 0;
+			if (not context.is_square) {
+				transformed_right[i] = i < context.right.size() ? context.right[i] % field.prime : 0;
+			}
+		}
+		prepare_roots(span<natmax>(context.roots), field, false, max<sizevalue>(first, 1), last);
+		context.synchronization.arrive_and_wait();
+		for (sizevalue length = context.size / 2; length >= 1; length /= 2) {
+			transform_forward_layer(values, context.roots, field, length, first_butterfly, last_butterfly);
+			if (not context.is_square) {
+				transform_forward_layer(transformed_right, context.roots, field, length, first_butterfly, last_butterfly);
+			}
+			context.synchronization.arrive_and_wait();
+		}
+		span<natmax> other = context.is_square ? values : transformed_right;
+		// 逐项相乘并同时除以变换长度：size^{-1} = prime - (prime - 1) / size
+		// multiply(multiply(a, b), scale) = a * b * R^{-1} * size^{-1} * R^2 * R^{-1} = a * b * size^{-1}
+		natmax scale = field.to_montgomery(field.to_montgomery(field.prime - (field.prime - 1) / context.size));
+		for (sizevalue i = first; i < last; ++i) {
+			values[i] = field.multiply(field.multiply(values[i], other[i]), scale);
+		}
+		// 正变换的各层都已完成，可以覆盖 roots
+		prepare_roots(span<natmax>(context.roots), field, true, max<sizevalue>(first, 1), last);
+		context.synchronization.arrive_and_wait();
+		for (sizevalue length = 1; length < context.size; length *= 2) {
+			transform_inverse_layer(values, context.roots, field, length, first_butterfly, last_butterfly);
+			context.synchronization.arrive_and_wait();
+		}
+	}
+	// 还原本线程负责的每一项并逐单元进位
+	// 循环不变式：
+	//   product[first_of_product .. i - 1] + carry * B^i = ∑_{m=first_of_product}^{i-1}(convolution[m] * B^m)
+	auto [first_of_product, last_of_product] = partition(context.product.size(), index, context.number_of_threads);
+	natmax carry[3] = { 0, 0, 0 };
+	for (sizevalue i = first_of_product; i < last_of_product; ++i) {
+		natmax term[3] = { 0, 0, 0 };
+		if (i < context.length_of_convolution) {
+			const natmax residue[3] = { context.residues[0][i], context.residues[1][i], context.residues[2][i] };
+			recombine(term, residue);
+		}
+		nat8 carry_of_add = 0;
+		context.product[i] = add_with_carry(term[0], carry[0], carry_of_add);
+		carry[0] = add_with_carry(term[1], carry[1], carry_of_add);
+		carry[1] = add_with_carry(term[2], carry[2], carry_of_add);
+		carry[2] = carry_of_add;
+	}
+	if (context.number_of_threads == 1) {
+		return;
+	}
+
+	// 本区间的作用：只有最低 3 个单元以上都为 max(natmax) 时，加上 x 才可能越过整个区间，
+	// 此时 threshold = B^3 - (最低 3 个单元)；线程数的上限保证每个区间都远多于 3 个单元
+	span<natmax> own = context.product.subspan(first_of_product, last_of_product - first_of_product);
+	carry_transfer& transfer = context.transfers[0][index];
+	std::copy(carry, carry + 3, transfer.carry);
+	nat8 borrow = 0;
+	for (sizevalue m = 0; m < 3; ++m) {
+		transfer.threshold[m] = subtract_with_borrow(0, own[m], borrow);
+	}
+	// 最低 3 个单元都为 0 时 threshold = B^3，任何进位都达不到
+	transfer.has_threshold = borrow != 0 and std::all_of(own.begin() + 3, own.end(), [](natmax v) { return v == natmax_max; });
+
+	// Hillis-Steele 前缀扫描：第 r 轮之后 transfers[current][i] 为区间 i - 2^r + 1 .. i 合起来的作用
+	sizevalue current = 0;
+	for (sizevalue distance = 1; distance < context.number_of_threads; distance *= 2) {
+		context.synchronization.arrive_and_wait();
+		span<const carry_transfer> from(context.transfers[current]);
+		context.transfers[1 - current][index] = index >= distance ? compose(from[index - distance], from[index]) : from[index];
+		current = 1 - current;
+	}
+	context.synchronization.arrive_and_wait();
+	if (index == 0) {
+		return;
+	}
+	// 区间 0 .. index - 1 合起来的作用在 x = 0 处的值 (threshold 至少为 1) 就是进入本区间的进位；
+	// 本区间由此向更高位产生的进位已经计入更高的区间，因此在区间末尾丢弃
+	const natmax (&incoming)[3] = context.transfers[current][index - 1].carry;
+	nat8 carry_of_add = 0;
+	for (sizevalue i = 0; i < own.size() and (i < 3 or carry_of_add != 0); ++i) {
+		own[i] = add_with_carry(own[i], i < 3 ? incoming[i] : 0, carry_of_add);
+	}
+}
+
+void multiply_by_number_theoretic_transform(span<natmax> product, const span<natmax> left, const span<natmax> right, sizevalue number_of_threads) noexcept
+{
+	// 前置条件: not left.empty() and not right.empty() and product.size() = left.size() + right.size() <= NUMBER_THEORETIC_TRANSFORM_MAX_SIZE
+	runtime_assert(not left.empty() and not right.empty() and product.size() == left.size() + right.size() and product.size() <= NUMBER_THEORETIC_TRANSFORM_MAX_SIZE, "multiply_by_number_theoretic_transform 的前置条件不被满足");
+	// 卷积共有 left.size() + right.size() - 1 项，每项小于 min(left.size(), right.size()) * B^2 < 三个素数之积
+	// 每个线程每层至少负责 NUMBER_THEORETIC_TRANSFORM_BUTTERFLIES_PER_THREAD 个蝶形运算，否则同步的开销会超过并行的收益
+	sizevalue size = std::bit_ceil(left.size() + right.size() - 1);
+	number_of_threads = max<sizevalue>(1, min(number_of_threads, size / 2 / NUMBER_THEORETIC_TRANSFORM_BUTTERFLIES_PER_THREAD));
+	transform_context context(product, left, right, number_of_threads);
+	vector<thread> workers;
+	for (sizevalue index = 1; index < number_of_threads; ++index) {
+		workers.emplace_back(run_transform, std::ref(context), index);
+	}
+	run_transform(context, 0);
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	// 后置条件: product <- left * right
+}
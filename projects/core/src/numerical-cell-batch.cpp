@@ -0,0 +1,240 @@
+#include <numerical-cell-batch>
+#include <limb-arithmetic>
+#include <runtime-exception>
+#include <memory-resource>
+#include <algorithm>
+
+using std::vector;
+using std::span;
+using std::min;
+using std::max;
+
+// 逐元素的加减法按块处理，每块中的数胞共用栈上的进位数组，每一行 (同一单元) 的内层循环之间没有依赖
+constexpr sizevalue BLOCK_OF_CELLS = 256;
+// 求和时每列按 32 位的两半分别累加，每段至多 2^32 - 1 个数胞，累加不会溢出
+constexpr sizevalue SEGMENT_OF_SUM = nat32_max;
+
+numerical_cell_batch::numerical_cell_batch(const vector<natmax>& upper_bound, sizevalue count) : bound(upper_bound), count(count)
+{
+	// 前置条件: upper_bound 不为0
+	runtime_assert(not bound.empty(), "数胞批的构造函数的前置条件不被满足");
+	values.assign(bound.number_of_states().size() * count, 0);
+}
+
+numerical_cell numerical_cell_batch::get(sizevalue index) const
+{
+	// 前置条件: index < size()
+	runtime_assert(index < count, "数胞批的get函数的前置条件不被满足");
+	span<natmax> current_number_of_states = number_of_states();
+	vector<natmax> value(current_number_of_states.size(), 0);
+	for (sizevalue k = 0; k < value.size(); ++k) {
+		value[k] = values[k * count + index];
+	}
+	return numerical_cell(vector<natmax>(current_number_of_states.begin(), current_number_of_states.end()), std::move(value));
+}
+
+void numerical_cell_batch::set(sizevalue index, span<natmax> value) noexcept
+{
+	// 前置条件: index < size() and not value.empty()
+	runtime_assert(index < count and not value.empty(), "数胞批的set函数的前置条件不被满足");
+	sizevalue n = number_of_states().size();
+	// 多预留一个单元供取模时使用
+	scratch_vector parts = make_scratch_vector(max(value.size(), n) + 1);
+	std::copy(value.begin(), value.end(), parts.begin());
+	scratch_vector scratch = make_scratch_vector(parts.size());
+	bound.reduce_by_number_of_states(span<natmax>(parts), span<natmax>(scratch));
+	for (sizevalue k = 0; k < n; ++k) {
+		values[k * count + index] = parts[k];
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: cells[k * stride + i] (0 <= k < number_of_states.size()，0 <= i < width) 为 width 个数胞的值，width <= BLOCK_OF_CELLS
+// 后置条件 Q: mask[i] <- 全1 (当 carry[i] = 1 或者第 i 个数胞的值不小于 number_of_states 时) 或者 0 (其他情况)
+static void mask_of_at_least_number_of_states(natmax* mask, const natmax* carry, const natmax* cells, sizevalue stride, sizevalue width, span<natmax> number_of_states) noexcept
+{
+	natmax at_least[BLOCK_OF_CELLS];
+	natmax decided[BLOCK_OF_CELLS];
+	for (sizevalue i = 0; i < width; ++i) {
+		at_least[i] = 1;
+		decided[i] = 0;
+	}
+	// 从最高单元向低单元比较，第一个不相等的单元决定大小；全部相等时值等于状态数
+	for (sizevalue k = number_of_states.size() - 1; k < number_of_states.size(); --k) {
+		const natmax* row = cells + k * stride;
+		natmax limit = number_of_states[k];
+		for (sizevalue i = 0; i < width; ++i) {
+			natmax greater = row[i] > limit;
+			natmax less = row[i] < limit;
+			at_least[i] = decided[i] != 0 ? at_least[i] : (greater != 0 ? 1 : (less != 0 ? 0 : at_least[i]));
+			decided[i] |= greater | less;
+		}
+	}
+	for (sizevalue i = 0; i < width; ++i) {
+		mask[i] = 0 - (carry[i] | at_least[i]);
+	}
+}
+
+void numerical_cell_batch::operator+=(const numerical_cell_batch& right) noexcept
+{
+	// 前置条件: 两批数胞的状态数与数量皆相同
+	runtime_assert(count == right.count and std::ranges::equal(number_of_states(), right.number_of_states()) and not empty(), "数胞批的+=函数的前置条件不被满足");
+	span<natmax> current_number_of_states = number_of_states();
+	sizevalue n = current_number_of_states.size();
+	natmax carry[BLOCK_OF_CELLS];
+	natmax mask[BLOCK_OF_CELLS];
+	for (sizevalue begin = 0; begin < count; begin += BLOCK_OF_CELLS) {
+		sizevalue width = min(BLOCK_OF_CELLS, count - begin);
+		natmax* cells = values.data() + begin;
+		const natmax* right_cells = right.values.data() + begin;
+		// cells <- cells + right_cells
+		for (sizevalue i = 0; i < width; ++i) {
+			carry[i] = 0;
+		}
+		for (sizevalue k = 0; k < n; ++k) {
+			natmax* row = cells + k * count;
+			const natmax* right_row = right_cells + k * count;
+			for (sizevalue i = 0; i < width; ++i) {
+				natmax sum = row[i] + right_row[i];
+				natmax carry_of_sum = sum < row[i];
+				row[i] = sum + carry[i];
+				carry[i] = carry_of_sum | (row[i] < sum);
+			}
+		}
+		// 两个小于状态数的值相加，溢出或者不小于状态数时减去一次状态数
+		mask_of_at_least_number_of_states(mask, carry, cells, count, width, current_number_of_states);
+		for (sizevalue i = 0; i < width; ++i) {
+			carry[i] = 0; // 此处用作借位
+		}
+		for (sizevalue k = 0; k < n; ++k) {
+			natmax* row = cells + k * count;
+			natmax limit = current_number_of_states[k];
+			for (sizevalue i = 0; i < width; ++i) {
+				natmax subtrahend = limit & mask[i];
+				natmax difference = row[i] - subtrahend;
+				natmax borrow = row[i] < subtrahend;
+				row[i] = difference - carry[i];
+				carry[i] = borrow | (difference < carry[i]);
+			}
+		}
+	}
+}
+
+void numerical_cell_batch::operator-=(const numerical_cell_batch& right) noexcept
+{
+	// 前置条件: 两批数胞的状态数与数量皆相同
+	runtime_assert(count == right.count and std::ranges::equal(number_of_states(), right.number_of_states()) and not empty(), "数胞批的-=函数的前置条件不被满足");
+	span<natmax> current_number_of_states = number_of_states();
+	sizevalue n = current_number_of_states.size();
+	natmax borrow[BLOCK_OF_CELLS];
+	natmax carry[BLOCK_OF_CELLS];
+	for (sizevalue begin = 0; begin < count; begin += BLOCK_OF_CELLS) {
+		sizevalue width = min(BLOCK_OF_CELLS, count - begin);
+		natmax* cells = values.data() + begin;
+		const natmax* right_cells = right.values.data() + begin;
+		// cells <- cells - right_cells
+		for (sizevalue i = 0; i < width; ++i) {
+			borrow[i] = 0;
+		}
+		for (sizevalue k = 0; k < n; ++k) {
+			natmax* row = cells + k * count;
+			const natmax* right_row = right_cells + k * count;
+			for (sizevalue i = 0; i < width; ++i) {
+				natmax difference = row[i] - right_row[i];
+				natmax borrow_of_difference = row[i] < right_row[i];
+				row[i] = difference - borrow[i];
+				borrow[i] = borrow_of_difference | (difference < borrow[i]);
+			}
+		}
+		// 产生借位说明结果为负，加上一次状态数即可
+		for (sizevalue i = 0; i < width; ++i) {
+			borrow[i] = 0 - borrow[i];
+			carry[i] = 0;
+		}
+		for (sizevalue k = 0; k < n; ++k) {
+			natmax* row = cells + k * count;
+			natmax limit = current_number_of_states[k];
+			for (sizevalue i = 0; i < width; ++i) {
+				natmax addend = limit & borrow[i];
+				natmax sum = row[i] + addend;
+				natmax carry_of_sum = sum < addend;
+				row[i] = sum + carry[i];
+				carry[i] = carry_of_sum | (row[i] < sum);
+			}
+		}
+	}
+}
+
+void numerical_cell_batch::operator*=(const numerical_cell_batch& right) noexcept
+{
+	// 前置条件: 两批数胞的状态数与数量皆相同
+	runtime_assert(count == right.count and std::ranges::equal(number_of_states(), right.number_of_states()) and not empty(), "数胞批的*=函数的前置条件不被满足");
+	sizevalue n = number_of_states().size();
+	// 乘积至多 2n 个单元，多预留一个单元供取模时使用；所有临时空间在循环外一次性分配
+	scratch_vector left_value = make_scratch_vector(n);
+	scratch_vector right_value = make_scratch_vector(n);
+	scratch_vector product = make_scratch_vector(n * 2 + 1);
+	scratch_vector scratch = make_scratch_vector(n * 2 + 1);
+	for (sizevalue index = 0; index < count; ++index) {
+		for (sizevalue k = 0; k < n; ++k) {
+			left_value[k] = values[k * count + index];
+			right_value[k] = right.values[k * count + index];
+		}
+		std::fill(product.begin(), product.end(), 0);
+		for (sizevalue i = 0; i < n; ++i) {
+			natmax carry = 0;
+			for (sizevalue j = 0; j < n; ++j) {
+				product[i + j] = multiply_add(left_value[j], right_value[i], product[i + j], carry);
+			}
+			product[i + n] = carry;
+		}
+		bound.reduce_by_number_of_states(span<natmax>(product), span<natmax>(scratch));
+		for (sizevalue k = 0; k < n; ++k) {
+			values[k * count + index] = product[k];
+		}
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: parts 足以容纳相加的结果
+// 后置条件 Q: parts <- parts + addend * B^position
+static void add_at(span<natmax> parts, sizevalue position, natmax addend) noexcept
+{
+	nat8 carry = 0;
+	parts[position] = add_with_carry(parts[position], addend, carry);
+	for (sizevalue i = position + 1; carry == 1 and i < parts.size(); ++i) {
+		parts[i] = add_with_carry(parts[i], 0, carry);
+	}
+}
+
+numerical_cell numerical_cell_batch::sum() const noexcept
+{
+	// 前置条件: not empty()
+	runtime_assert(not empty(), "数胞批的sum函数的前置条件不被满足");
+	span<natmax> current_number_of_states = number_of_states();
+	sizevalue n = current_number_of_states.size();
+	// 先逐列求和 (不取模)，再对总和取一次模
+	// 设 B 为 max(natmax) + 1，总和小于 count * B^n，用 n + 2 个单元即可容纳，再多预留一个单元供取模时使用
+	scratch_vector total = make_scratch_vector(n + 3);
+	for (sizevalue k = 0; k < n; ++k) {
+		const natmax* row = values.data() + k * count;
+		for (sizevalue begin = 0; begin < count; begin += SEGMENT_OF_SUM) {
+			sizevalue end = min(count, begin + SEGMENT_OF_SUM);
+			// 两个累加器各自独立，循环中没有进位依赖，可以被向量化
+			natmax sum_of_low_halves = 0;
+			natmax sum_of_high_halves = 0;
+			for (sizevalue i = begin; i < end; ++i) {
+				sum_of_low_halves += row[i] & nat32_max;
+				sum_of_high_halves += row[i] >> 32;
+			}
+			// 这一段的列和 = sum_of_low_halves + sum_of_high_halves * 2^32
+			add_at(span<natmax>(total), k, sum_of_low_halves);
+			add_at(span<natmax>(total), k, sum_of_high_halves << 32);
+			add_at(span<natmax>(total), k + 1, sum_of_high_halves >> 32);
+		}
+	}
+	numerical_cell result(vector<natmax>(current_number_of_states.begin(), current_number_of_states.end()));
+	// 赋值时总和会被限制在状态数中
+	result = span<natmax>(total);
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include <numerical-cell-counters>
+#include <runtime-exception>
+#include <ostream>
+
+// 与枚举的顺序一致
+static const char* const NAMES_OF_OPERATIONS[NUMBER_OF_CELL_OPERATIONS] = { "add", "subtract", "multiply", "square", "pow", "divide", "modulo", "assign", "compare" };
+static const char* const NAMES_OF_SLOW_PATHS[NUMBER_OF_CELL_SLOW_PATHS] = {
+	"limit_right_value_then_increase", "limit_right_value_then_decrease", "limit_right_value_then_multiply",
+	"limit_value_after_increase", "limit_value_after_decrease"
+};
+static const char* const NAMES_OF_SHAPES[NUMBER_OF_STATES_SHAPES] = { "general", "power_of_two", "pseudo_mersenne", "single_limb" };
+
+#if defined(NUMERICAL_CELL_COUNTING)
+// 计数器为平凡类型并以常量初始化，访问时不需要经过线程局部变量的初始化检查
+constinit thread_local numerical_cell_counters this_thread_numerical_cell_counters{};
+numerical_cell_counters_hook numerical_cell_hook = nullptr;
+natmax numerical_cell_hook_period = 0;
+#endif
+
+numerical_cell_counters snapshot_numerical_cell_counters() noexcept
+{
+#if defined(NUMERICAL_CELL_COUNTING)
+	return this_thread_numerical_cell_counters;
+#else
+	return {};
+#endif
+}
+
+void reset_numerical_cell_counters() noexcept
+{
+#if defined(NUMERICAL_CELL_COUNTING)
+	this_thread_numerical_cell_counters = {};
+#endif
+}
+
+void set_numerical_cell_counters_hook(numerical_cell_counters_hook hook, natmax period)
+{
+	// 前置条件: hook == nullptr or period > 0
+	runtime_assert(hook == nullptr or period > 0, "set_numerical_cell_counters_hook 的前置条件不被满足");
+#if defined(NUMERICAL_CELL_COUNTING)
+	numerical_cell_hook = hook;
+	numerical_cell_hook_period = period;
+#endif
+}
+
+// 第 limb_class 级单元数的名称，例如 "1", "2", "3-4", "5-8", ">16384"
+static void write_limb_class(std::ostream& out, sizevalue limb_class)
+{
+	if (limb_class == 0) {
+		out << "1";
+	}
+	else if (limb_class == NUMBER_OF_LIMB_CLASSES - 1) {
+		out << ">" << (static_cast<sizevalue>(1) << (limb_class - 1));
+	}
+	else if (limb_class == 1) {
+		out << "2";
+	}
+	else {
+		out << (static_cast<sizevalue>(1) << (limb_class - 1)) + 1 << "-" << (static_cast<sizevalue>(1) << limb_class);
+	}
+}
+
+void write_numerical_cell_counters(std::ostream& out, const numerical_cell_counters& counters)
+{
+	out << "{\"operations\": {";
+	bool first_operation = true;
+	for (sizevalue i = 0; i < NUMBER_OF_CELL_OPERATIONS; ++i) {
+		bool first_class = true;
+		for (sizevalue j = 0; j < NUMBER_OF_LIMB_CLASSES; ++j) {
+			if (counters.operations[i][j] == 0) {
+				continue;
+			}
+			if (first_class) {
+				out << (first_operation ? "" : ", ") << "\"" << NAMES_OF_OPERATIONS[i] << "\": {";
+				first_operation = false;
+			}
+			out << (first_class ? "" : ", ") << "\"";
+			write_limb_class(out, j);
+			out << "\": " << counters.operations[i][j];
+			first_class = false;
+		}
+		if (not first_class) {
+			out << "}";
+		}
+	}
+	out << "}, \"slow_paths\": {";
+	bool first = true;
+	for (sizevalue i = 0; i < NUMBER_OF_CELL_SLOW_PATHS; ++i) {
+		if (counters.slow_paths[i] != 0) {
+			out << (first ? "" : ", ") << "\"" << NAMES_OF_SLOW_PATHS[i] << "\": " << counters.slow_paths[i];
+			first = false;
+		}
+	}
+	out << "}, \"reductions\": {";
+	first = true;
+	for (sizevalue i = 0; i < NUMBER_OF_STATES_SHAPES; ++i) {
+		if (counters.reductions[i] != 0) {
+			out << (first ? "" : ", ") << "\"" << NAMES_OF_SHAPES[i] << "\": " << counters.reductions[i];
+			first = false;
+		}
+	}
+	out << "}, \"scratch_allocations\": " << counters.scratch_allocations << ", \"scratch_limbs\": " << counters.scratch_limbs << "}";
+}
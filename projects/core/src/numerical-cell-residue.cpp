@@ -0,0 +1,252 @@
+#include <numerical-cell-residue>
+#include <limb-arithmetic>
+#include <runtime-exception>
+#include <memory-resource>
+#include <algorithm>
+#include <stdexcept>
+
+using std::vector;
+using std::span;
+using std::invalid_argument;
+
+// 以下运算中 modulus 皆为奇数且小于 2^63，negative_inverse = -modulus^{-1} mod B
+
+// 前置条件 P: left, right < modulus
+static natmax add_modulo(natmax left, natmax right, natmax modulus) noexcept
+{
+	natmax sum = left + right;
+	return sum >= modulus ? sum - modulus : sum;
+}
+
+// 前置条件 P: left, right < modulus
+static natmax subtract_modulo(natmax left, natmax right, natmax modulus) noexcept
+{
+	return left >= right ? left - right : left + modulus - right;
+}
+
+// 逻辑规范：
+// 前置条件 P: left * right < modulus * B
+// 后置条件 Q: 返回 left * right * R^{-1} mod modulus (R = B)
+static natmax multiply_montgomery(natmax left, natmax right, natmax modulus, natmax negative_inverse) noexcept
+{
+	natmax high = 0;
+	natmax low = multiply_with_high(left, right, high);
+	natmax m = low * negative_inverse;
+	natmax m_high = 0;
+	natmax m_low = multiply_with_high(m, modulus, m_high);
+	// low + m_low ≡ 0 (mod B)，只需保留其进位
+	nat8 carry = 0;
+	add_with_carry(low, m_low, carry);
+	// (left * right + m * modulus) / B < 2 * modulus < 2^64，不会溢出
+	natmax result = high + m_high + carry;
+	return result >= modulus ? result - modulus : result;
+}
+
+// 逻辑规范：
+// 前置条件 P: modulus 为奇数，value 为任意单元
+// 后置条件 Q: 返回 value^{-1} mod modulus，value 与 modulus 不互素时返回0
+static natmax inverse_of_word(natmax value, natmax modulus) noexcept
+{
+	// 扩展欧几里得算法，循环不变式：r0 ≡ s0 * value，r1 ≡ s1 * value (mod modulus)，所有量的绝对值不超过 modulus < 2^63
+	intmax r0 = static_cast<intmax>(modulus), r1 = static_cast<intmax>(value % modulus);
+	intmax s0 = 0, s1 = 1;
+	while (r1 != 0) {
+		intmax q = r0 / r1;
+		intmax t = r0 - q * r1;
+		r0 = r1;
+		r1 = t;
+		t = s0 - q * s1;
+		s0 = s1;
+		s1 = t;
+	}
+	if (r0 != 1) {
+		return 0;
+	}
+	return static_cast<natmax>(s0 < 0 ? s0 + static_cast<intmax>(modulus) : s0);
+}
+
+residue_number_system::residue_number_system(const vector<natmax>& moduli) : moduli(moduli)
+{
+	if (moduli.empty()) {
+		throw invalid_argument("剩余数系统至少需要一个模数");
+	}
+	sizevalue k = moduli.size();
+	negative_inverses.resize(k);
+	r_squared.resize(k);
+	garner_inverses.resize(k);
+	garner_moduli.resize(k * (k - 1) / 2);
+	product.assign(1, 1);
+	for (sizevalue i = 0; i < k; ++i) {
+		natmax modulus = moduli[i];
+		if (modulus < 3 or modulus % 2 == 0 or modulus >> 63 != 0) {
+			throw invalid_argument("剩余数系统的模数须为不小于3且小于2^63的奇数");
+		}
+		// 牛顿迭代：奇数 modulus 满足 modulus * modulus ≡ 1 (mod 8)，每次迭代使正确的位数翻倍
+		natmax inverse = modulus;
+		for (sizevalue j = 0; j < 5; ++j) {
+			inverse *= 2 - modulus * inverse;
+		}
+		negative_inverses[i] = 0 - inverse;
+		// (0 - modulus) mod modulus = B mod modulus，再倍增 64 次得到 R^2 mod modulus
+		natmax r = (0 - modulus) % modulus;
+		natmax square = r;
+		for (sizevalue j = 0; j < sizeof(natmax) * WORD_SIZE; ++j) {
+			square = add_modulo(square, square, modulus);
+		}
+		r_squared[i] = square;
+		// 普通形式的 m_0 * ... * m_{i-1} mod modulus；与之互素等价于与此前的每个模数都互素
+		natmax prefix = 1 % modulus;
+		natmax* row = garner_moduli.data() + i * (i - 1) / 2;
+		for (sizevalue j = 0; j < i; ++j) {
+			row[j] = multiply_montgomery(moduli[j], square, modulus, negative_inverses[i]);
+			prefix = multiply_montgomery(prefix, row[j], modulus, negative_inverses[i]);
+		}
+		natmax inverse_of_prefix = inverse_of_word(prefix, modulus);
+		if (inverse_of_prefix == 0) {
+			throw invalid_argument("剩余数系统的模数须两两互素");
+		}
+		garner_inverses[i] = multiply_montgomery(inverse_of_prefix, square, modulus, negative_inverses[i]);
+		// 模数之积 <- 模数之积 * modulus
+		natmax carry = 0;
+		for (natmax& part : product) {
+			part = multiply_add(part, modulus, 0, carry);
+		}
+		if (carry != 0) {
+			product.push_back(carry);
+		}
+	}
+}
+
+numerical_cell_residue::numerical_cell_residue(const residue_number_system& system) : system(&system)
+{
+	// 前置条件: not system.empty()
+	runtime_assert(not system.empty(), "剩余数胞的构造函数的前置条件不被满足");
+	residues.assign(system.size(), 0);
+}
+
+numerical_cell_residue::numerical_cell_residue(const residue_number_system& system, const numerical_cell& cell) : system(&system)
+{
+	// 前置条件: not system.empty() and not cell.empty()
+	runtime_assert(not system.empty() and not cell.empty(), "剩余数胞的构造函数的前置条件不被满足");
+	span<natmax> value = cell.significant_value();
+	residues.resize(system.size());
+	for (sizevalue i = 0; i < system.size(); ++i) {
+		natmax modulus = system.moduli[i];
+		natmax negative_inverse = system.negative_inverses[i];
+		natmax square = system.r_squared[i];
+		natmax one = multiply_montgomery(1, square, modulus, negative_inverse); // R mod modulus
+		// 从最高单元起按 Horner 法则累积：residue <- residue * B + value[j] (mod modulus)，皆为普通形式
+		natmax residue = 0;
+		for (sizevalue j = value.size() - 1; j < value.size(); --j) {
+			residue = add_modulo(multiply_montgomery(residue, square, modulus, negative_inverse), multiply_montgomery(value[j], one, modulus, negative_inverse), modulus);
+		}
+		residues[i] = multiply_montgomery(residue, square, modulus, negative_inverse);
+	}
+}
+
+natmax numerical_cell_residue::residue(sizevalue index) const noexcept
+{
+	// 前置条件: not empty() and index < 模数的个数
+	runtime_assert(not empty() and index < residues.size(), "剩余数胞的residue函数的前置条件不被满足");
+	return multiply_montgomery(residues[index], 1, system->moduli[index], system->negative_inverses[index]);
+}
+
+numerical_cell numerical_cell_residue::to_numerical_cell(memory_resource* resource) const
+{
+	// 前置条件: not empty()
+	runtime_assert(not empty(), "剩余数胞的to_numerical_cell函数的前置条件不被满足");
+	const residue_number_system& current_system = *system;
+	sizevalue k = residues.size();
+	// Garner 算法：x = v_0 + v_1 * m_0 + v_2 * m_0 * m_1 + ...，其中 0 <= v_i < m_i，
+	//   v_i = (r_i - (v_0 + v_1 * m_0 + ... + v_{i-1} * m_0 * ... * m_{i-2})) * (m_0 * ... * m_{i-1})^{-1} mod m_i
+	scratch_vector digits = make_scratch_vector(k);
+	for (sizevalue i = 0; i < k; ++i) {
+		natmax modulus = current_system.moduli[i];
+		natmax negative_inverse = current_system.negative_inverses[i];
+		const natmax* row = current_system.garner_moduli.data() + i * (i - 1) / 2;
+		// 普通形式与 Montgomery 形式相乘得到普通形式；与 R mod modulus 相乘即为取模
+		natmax one = multiply_montgomery(1, current_system.r_squared[i], modulus, negative_inverse);
+		natmax partial = 0;
+		for (sizevalue j = i - 1; j < i; --j) {
+			partial = add_modulo(multiply_montgomery(partial, row[j], modulus, negative_inverse), multiply_montgomery(digits[j], one, modulus, negative_inverse), modulus);
+		}
+		natmax residue = multiply_montgomery(residues[i], 1, modulus, negative_inverse);
+		digits[i] = multiply_montgomery(subtract_modulo(residue, partial, modulus), current_system.garner_inverses[i], modulus, negative_inverse);
+	}
+	// 混合进制还原为位置表示：value <- value * m_i + v_i，从最高位起
+	scratch_vector value = make_scratch_vector(k);
+	sizevalue length = 1;
+	value[0] = digits[k - 1];
+	for (sizevalue i = k - 2; i < k; --i) {
+		natmax carry = digits[i];
+		for (sizevalue j = 0; j < length; ++j) {
+			value[j] = multiply_add(value[j], current_system.moduli[i], 0, carry);
+		}
+		if (carry != 0) {
+			value[length++] = carry;
+		}
+	}
+	span<natmax> states = current_system.number_of_states();
+	numerical_cell result(vector<natmax>(states.begin(), states.end()), resource);
+	result = span<natmax>(value);
+	return result;
+}
+
+void numerical_cell_residue::operator+=(const numerical_cell_residue& right) noexcept
+{
+	// 前置条件: 两者使用同一个剩余数系统
+	runtime_assert(not empty() and system == right.system, "剩余数胞的+=函数的前置条件不被满足");
+	const natmax* moduli = system->moduli.data();
+	for (sizevalue i = 0; i < residues.size(); ++i) {
+		residues[i] = add_modulo(residues[i], right.residues[i], moduli[i]);
+	}
+}
+
+void numerical_cell_residue::operator-=(const numerical_cell_residue& right) noexcept
+{
+	// 前置条件: 两者使用同一个剩余数系统
+	runtime_assert(not empty() and system == right.system, "剩余数胞的-=函数的前置条件不被满足");
+	const natmax* moduli = system->moduli.data();
+	for (sizevalue i = 0; i < residues.size(); ++i) {
+		residues[i] = subtract_modulo(residues[i], right.residues[i], moduli[i]);
+	}
+}
+
+void numerical_cell_residue::operator*=(const numerical_cell_residue& right) noexcept
+{
+	// 前置条件: 两者使用同一个剩余数系统
+	runtime_assert(not empty() and system == right.system, "剩余数胞的*=函数的前置条件不被满足");
+	const natmax* moduli = system->moduli.data();
+	const natmax* negative_inverses = system->negative_inverses.data();
+	// 两个 Montgomery 形式相乘仍为 Montgomery 形式
+	for (sizevalue i = 0; i < residues.size(); ++i) {
+		residues[i] = multiply_montgomery(residues[i], right.residues[i], moduli[i], negative_inverses[i]);
+	}
+}
+
+numerical_cell_residue numerical_cell_residue::operator+(const numerical_cell_residue& right) const noexcept
+{
+	numerical_cell_residue result(*this);
+	result += right;
+	return result;
+}
+
+numerical_cell_residue numerical_cell_residue::operator-(const numerical_cell_residue& right) const noexcept
+{
+	numerical_cell_residue result(*this);
+	result -= right;
+	return result;
+}
+
+numerical_cell_residue numerical_cell_residue::operator*(const numerical_cell_residue& right) const noexcept
+{
+	numerical_cell_residue result(*this);
+	result *= right;
+	return result;
+}
+
+bool numerical_cell_residue::operator==(const numerical_cell_residue& right) const noexcept
+{
+	// Montgomery 形式是一一对应的，直接比较即可
+	return system == right.system and residues == right.residues;
+}
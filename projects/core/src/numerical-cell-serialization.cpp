@@ -0,0 +1,326 @@
+#include <numerical-cell-serialization>
+#include <runtime-exception>
+#include <memory-resource>
+#include <algorithm>
+#include <stdexcept>
+#include <bit>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using std::vector;
+using std::span;
+using std::runtime_error;
+
+// 头部的字数 (魔数, 版本, 种类, 数胞的个数)
+constexpr sizevalue NUMBER_OF_HEADER_WORDS = 4;
+
+// 逻辑规范：
+// 前置条件 P: 无
+// 后置条件 Q: 以小端序写入 words，写入失败时抛出 runtime_error
+static void write_words(std::ostream& out, span<const natmax> words)
+{
+	if constexpr (std::endian::native == std::endian::little) {
+		out.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(natmax));
+	}
+	else {
+		for (natmax word : words) {
+			char bytes[sizeof(natmax)];
+			for (sizevalue i = 0; i < sizeof(natmax); ++i) {
+				bytes[i] = static_cast<char>(word >> (i * BYTE_LENGTH));
+			}
+			out.write(bytes, sizeof(natmax));
+		}
+	}
+	if (not out) {
+		throw runtime_error("写入数胞表失败");
+	}
+}
+
+static void write_word(std::ostream& out, natmax word)
+{
+	write_words(out, span<const natmax>(&word, 1));
+}
+
+// 逻辑规范：
+// 前置条件 P: 无
+// 后置条件 Q: 以小端序读出 words.size() 个字，数据不足时抛出 runtime_error
+static void read_words(std::istream& in, span<natmax> words)
+{
+	in.read(reinterpret_cast<char*>(words.data()), words.size() * sizeof(natmax));
+	if (not in) {
+		throw runtime_error("数胞表的数据被截断");
+	}
+	if constexpr (std::endian::native != std::endian::little) {
+		for (natmax& word : words) {
+			const nat8* bytes = reinterpret_cast<const nat8*>(&word);
+			natmax value = 0;
+			for (sizevalue i = 0; i < sizeof(natmax); ++i) {
+				value |= static_cast<natmax>(bytes[i]) << (i * BYTE_LENGTH);
+			}
+			word = value;
+		}
+	}
+}
+
+static natmax read_word(std::istream& in)
+{
+	natmax word = 0;
+	read_words(in, span<natmax>(&word, 1));
+	return word;
+}
+
+static void write_header(std::ostream& out, numerical_cell_format_kind kind, sizevalue count)
+{
+	natmax header[NUMBER_OF_HEADER_WORDS] = { NUMERICAL_CELL_FORMAT_MAGIC, NUMERICAL_CELL_FORMAT_VERSION, static_cast<natmax>(kind), count };
+	write_words(out, span<const natmax>(header));
+}
+
+// 逻辑规范：
+// 前置条件 P: header.size() >= NUMBER_OF_HEADER_WORDS
+// 后置条件 Q: 魔数或者版本不符时抛出 runtime_error，种类不是 expected_kind 时 (expected_kind 为空指针时不检查) 抛出 runtime_error
+static void check_header(span<const natmax> header, const numerical_cell_format_kind* expected_kind)
+{
+	if (header[0] != NUMERICAL_CELL_FORMAT_MAGIC) {
+		throw runtime_error("不是数胞表");
+	}
+	if (header[1] != NUMERICAL_CELL_FORMAT_VERSION) {
+		throw runtime_error("不支持的数胞表版本" + std::to_string(header[1]));
+	}
+	if (header[2] != static_cast<natmax>(numerical_cell_format_kind::CELLS) and header[2] != static_cast<natmax>(numerical_cell_format_kind::BATCH)) {
+		throw runtime_error("未知的数胞表种类" + std::to_string(header[2]));
+	}
+	if (expected_kind != nullptr and header[2] != static_cast<natmax>(*expected_kind)) {
+		throw runtime_error("数胞表的种类不符");
+	}
+}
+
+void write_numerical_cells(std::ostream& out, span<const numerical_cell> cells)
+{
+	write_header(out, numerical_cell_format_kind::CELLS, cells.size());
+	// 数据紧接在索引之后，按数胞的顺序存放
+	natmax position = NUMBER_OF_HEADER_WORDS + 2 * cells.size();
+	for (const numerical_cell& cell : cells) {
+		natmax entry[2] = { position, cell.value().size() };
+		write_words(out, span<const natmax>(entry));
+		position += 2 * cell.value().size();
+	}
+	// 每个数胞依次写入值与状态数
+	for (const numerical_cell& cell : cells) {
+		write_words(out, span<const natmax>(cell.value()));
+		write_words(out, span<const natmax>(cell.number_of_states()));
+	}
+}
+
+vector<numerical_cell> read_numerical_cells(std::istream& in, memory_resource* resource)
+{
+	natmax header[NUMBER_OF_HEADER_WORDS];
+	read_words(in, span<natmax>(header));
+	numerical_cell_format_kind expected_kind = numerical_cell_format_kind::CELLS;
+	check_header(span<const natmax>(header), &expected_kind);
+	sizevalue count = header[3];
+	// 索引随读随存，不按文件中的 count 预先分配，避免损坏的文件导致过量分配
+	vector<natmax> index{};
+	natmax entry[2];
+	for (sizevalue i = 0; i < count; ++i) {
+		read_words(in, span<natmax>(entry));
+		index.push_back(entry[0]);
+		index.push_back(entry[1]);
+	}
+	vector<numerical_cell> cells{};
+	scratch_vector content = make_scratch_vector(0);
+	natmax position = NUMBER_OF_HEADER_WORDS + 2 * count;
+	for (sizevalue i = 0; i < count; ++i) {
+		sizevalue n = index[2 * i + 1];
+		// 流不能随意定位，因此要求数据按写入时的顺序连续存放
+		if (index[2 * i] != position) {
+			throw runtime_error("数胞表的索引与数据的位置不符");
+		}
+		if (n == 0) {
+			cells.emplace_back(resource);
+			continue;
+		}
+		content.resize(2 * n);
+		read_words(in, span<natmax>(content));
+		position += 2 * n;
+		// 构造时检查值是否小于状态数
+		cells.emplace_back(span<natmax>(content).subspan(n), span<natmax>(content).first(n), resource);
+	}
+	return cells;
+}
+
+void write_numerical_cell_batch(std::ostream& out, const numerical_cell_batch& batch)
+{
+	span<natmax> current_number_of_states = batch.number_of_states();
+	sizevalue n = current_number_of_states.size();
+	write_header(out, numerical_cell_format_kind::BATCH, batch.count);
+	write_word(out, n);
+	write_words(out, span<const natmax>(current_number_of_states.data(), n));
+	// 内存中按单元优先存放，文件中按数胞优先存放，使映射后每个数胞的值是连续的
+	scratch_vector value = make_scratch_vector(n);
+	for (sizevalue index = 0; index < batch.count; ++index) {
+		for (sizevalue k = 0; k < n; ++k) {
+			value[k] = batch.values[k * batch.count + index];
+		}
+		write_words(out, span<const natmax>(value.data(), n));
+	}
+}
+
+numerical_cell_batch read_numerical_cell_batch(std::istream& in)
+{
+	natmax header[NUMBER_OF_HEADER_WORDS];
+	read_words(in, span<natmax>(header));
+	numerical_cell_format_kind expected_kind = numerical_cell_format_kind::BATCH;
+	check_header(span<const natmax>(header), &expected_kind);
+	sizevalue count = header[3];
+	sizevalue n = read_word(in);
+	vector<natmax> upper_bound(n, 0);
+	read_words(in, span<natmax>(upper_bound));
+	if (n == 0) {
+		return numerical_cell_batch{};
+	}
+	if (upper_bound.back() == 0) {
+		throw runtime_error("数胞表中的状态数含有高位0");
+	}
+	numerical_cell_batch batch(upper_bound, count);
+	scratch_vector value = make_scratch_vector(n);
+	for (sizevalue index = 0; index < count; ++index) {
+		read_words(in, span<natmax>(value));
+		if (not std::lexicographical_compare(value.rbegin(), value.rend(), upper_bound.rbegin(), upper_bound.rend())) {
+			throw runtime_error("数胞表中第" + std::to_string(index) + "个数胞的值不小于状态数");
+		}
+		for (sizevalue k = 0; k < n; ++k) {
+			batch.values[k * count + index] = value[k];
+		}
+	}
+	return batch;
+}
+
+numerical_cell_table_view::numerical_cell_table_view(const byte_array& path)
+{
+	if constexpr (std::endian::native != std::endian::little) {
+		throw runtime_error("只有在小端序的机器上才能直接映射数胞表");
+	}
+	int descriptor = open(path.c_str(), O_RDONLY);
+	if (descriptor < 0) {
+		throw runtime_error("无法打开数胞表" + path);
+	}
+	struct stat information {};
+	if (fstat(descriptor, &information) != 0) {
+		close(descriptor);
+		throw runtime_error("无法读取数胞表的大小" + path);
+	}
+	sizevalue size_of_file = static_cast<sizevalue>(information.st_size);
+	if (size_of_file < NUMBER_OF_HEADER_WORDS * sizeof(natmax) or size_of_file % sizeof(natmax) != 0) {
+		close(descriptor);
+		throw runtime_error(path + "不是数胞表");
+	}
+	// 只读的私有映射，各页在第一次被访问时才读入；映射建立后即可关闭文件
+	void* mapping = mmap(nullptr, size_of_file, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	close(descriptor);
+	if (mapping == MAP_FAILED) {
+		throw runtime_error("无法映射数胞表" + path);
+	}
+	words = static_cast<const natmax*>(mapping);
+	number_of_words = size_of_file / sizeof(natmax);
+	try {
+		check_header(span<const natmax>(words, number_of_words), nullptr);
+		format_kind = static_cast<numerical_cell_format_kind>(words[2]);
+		count = words[3];
+		// 只检查索引 (或者共用的状态数) 与全部数据的总长度是否在文件之内，各数胞的位置在访问时检查
+		sizevalue end_of_index = 0;
+		if (format_kind == numerical_cell_format_kind::CELLS) {
+			end_of_index = count <= number_of_words / 2 ? NUMBER_OF_HEADER_WORDS + 2 * count : sizevalue_max;
+		}
+		else if (number_of_words > NUMBER_OF_HEADER_WORDS) {
+			sizevalue n = words[NUMBER_OF_HEADER_WORDS];
+			bool fits = n <= number_of_words and (n == 0 or count <= number_of_words / n);
+			end_of_index = fits ? NUMBER_OF_HEADER_WORDS + 1 + n + n * count : sizevalue_max;
+		}
+		else {
+			end_of_index = sizevalue_max;
+		}
+		if (end_of_index > number_of_words) {
+			throw runtime_error("数胞表的数据被截断");
+		}
+	}
+	catch (runtime_error& e) {
+		unmap();
+		link_error(e, "在映射数胞表" + path + "时");
+	}
+}
+
+numerical_cell_table_view::~numerical_cell_table_view()
+{
+	unmap();
+}
+
+numerical_cell_table_view::numerical_cell_table_view(numerical_cell_table_view&& right) noexcept : words(right.words), number_of_words(right.number_of_words), count(right.count), format_kind(right.format_kind)
+{
+	right.words = nullptr;
+	right.number_of_words = 0;
+	right.count = 0;
+}
+
+void numerical_cell_table_view::operator=(numerical_cell_table_view&& right) noexcept
+{
+	if (this == &right) {
+		return;
+	}
+	unmap();
+	words = right.words;
+	number_of_words = right.number_of_words;
+	count = right.count;
+	format_kind = right.format_kind;
+	right.words = nullptr;
+	right.number_of_words = 0;
+	right.count = 0;
+}
+
+void numerical_cell_table_view::unmap() noexcept
+{
+	if (words != nullptr) {
+		munmap(const_cast<natmax*>(words), number_of_words * sizeof(natmax));
+	}
+	words = nullptr;
+	number_of_words = 0;
+	count = 0;
+}
+
+span<const natmax> numerical_cell_table_view::value(sizevalue index) const
+{
+	// 前置条件: index < size()
+	runtime_assert(index < count, "numerical_cell_table_view 的value函数的前置条件不被满足");
+	if (format_kind == numerical_cell_format_kind::BATCH) {
+		sizevalue n = words[NUMBER_OF_HEADER_WORDS];
+		return span<const natmax>(words + NUMBER_OF_HEADER_WORDS + 1 + n + index * n, n);
+	}
+	sizevalue position = words[NUMBER_OF_HEADER_WORDS + 2 * index];
+	sizevalue n = words[NUMBER_OF_HEADER_WORDS + 2 * index + 1];
+	runtime_assert(position <= number_of_words and n <= (number_of_words - position) / 2, "数胞表中第" + std::to_string(index) + "个数胞的位置超出了文件");
+	return span<const natmax>(words + position, n);
+}
+
+span<const natmax> numerical_cell_table_view::number_of_states(sizevalue index) const
+{
+	// 前置条件: index < size()
+	runtime_assert(index < count, "numerical_cell_table_view 的number_of_states函数的前置条件不被满足");
+	if (format_kind == numerical_cell_format_kind::BATCH) {
+		sizevalue n = words[NUMBER_OF_HEADER_WORDS];
+		return span<const natmax>(words + NUMBER_OF_HEADER_WORDS + 1, n);
+	}
+	span<const natmax> current_value = value(index);
+	return span<const natmax>(current_value.data() + current_value.size(), current_value.size());
+}
+
+numerical_cell numerical_cell_table_view::get(sizevalue index, memory_resource* resource) const
+{
+	span<const natmax> current_value = value(index);
+	span<const natmax> current_number_of_states = number_of_states(index);
+	if (current_number_of_states.empty()) {
+		return numerical_cell(resource);
+	}
+	// 构造时检查值是否小于状态数
+	return numerical_cell(current_number_of_states, current_value, resource);
+}
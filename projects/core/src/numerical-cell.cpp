@@ -1,28 +1,39 @@
 #include <numerical-cell>
-#include <bit-span>
+#include <numerical-cell-counters>
+#include <limb-arithmetic>
+#include <number-theoretic-transform>
+#include <radix-conversion>
 #include <runtime-exception>
+#include <memory-resource>
+#include <bit>
 
 using std::vector;
 using std::span;
 using std::runtime_error;
 using std::memset;
 using std::memcpy;
+using std::memcmp;
 using std::min;
+using std::max;
 using std::to_string;
 using std::weak_ordering;
 
-numerical_cell::numerical_cell(const vector<natmax>& upper_bound) noexcept
+numerical_cell::numerical_cell(const vector<natmax>& upper_bound, memory_resource* resource) noexcept : content(resource)
 {
 	span<natmax> upper_bound_span(const_cast<natmax*>(upper_bound.data()), find_if(upper_bound.rbegin(), upper_bound.rend(), [](natmax x) { return x != 0; }).base() - upper_bound.begin());
 	content.resize(upper_bound_span.size() * 2, 0);
 	memcpy(content.data() + upper_bound_span.size(), upper_bound_span.data(), upper_bound_span.size() * sizeof(natmax));
+	length_of_value = upper_bound_span.empty() ? 0 : 1;
+	classify_number_of_states();
 }
 
-numerical_cell::numerical_cell(vector<natmax>&& upper_bound) noexcept
+numerical_cell::numerical_cell(vector<natmax>&& upper_bound, memory_resource* resource) noexcept : content(resource)
 {
 	span<natmax> upper_bound_span(const_cast<natmax*>(upper_bound.data()), find_if(upper_bound.rbegin(), upper_bound.rend(), [](natmax x) { return x != 0; }).base() - upper_bound.begin());
 	content.resize(upper_bound_span.size() * 2, 0);
 	memcpy(content.data() + upper_bound_span.size(), upper_bound_span.data(), upper_bound_span.size() * sizeof(natmax));
+	length_of_value = upper_bound_span.empty() ? 0 : 1;
+	classify_number_of_states();
 }
 
 span<natmax> numerical_cell::value() const noexcept
@@ -34,6 +45,25 @@ span<natmax> numerical_cell::value() const noexcept
 	return span<natmax>(const_cast<natmax*>(content.data()), half_size);
 }
 
+span<natmax> numerical_cell::significant_value() const noexcept
+{
+	return span<natmax>(const_cast<natmax*>(content.data()), length_of_value);
+}
+
+// 逻辑规范：
+// 前置条件 P: value() 中下标不小于 upper_bound_of_length 的单元皆为0
+// 后置条件 Q: length_of_value <- value() 中有效单元的数量 (非空时至少为1)
+void numerical_cell::refresh_length_of_value(sizevalue upper_bound_of_length) noexcept
+{
+	span<natmax> current_value = this->value();
+	sizevalue length = min(upper_bound_of_length, current_value.size());
+	// 只需从 upper_bound_of_length 处向低位寻找，而不必扫描整个 value()
+	while (length > 1 and current_value[length - 1] == 0) {
+		--length;
+	}
+	length_of_value = current_value.empty() ? 0 : max<sizevalue>(length, 1);
+}
+
 span<natmax> numerical_cell::number_of_states() const noexcept
 {
 	if (content.empty()) {
@@ -43,22 +73,19 @@ span<natmax> numerical_cell::number_of_states() const noexcept
 	return span<natmax>(const_cast<natmax*>(content.data() + half_size), half_size);
 }
 
-static vector<natmax> mod_value_by_value(const span<natmax>& dividend, const span<natmax> divisor) noexcept;
-static vector<natmax> div_value_by_value(const span<natmax>& dividend, const span<natmax> divisor) noexcept;
-template <typename T> bool bit_is_less(T&& l, T&& r) noexcept;
-static void decrease_between_bit_spans(bit_span& minuend, const bit_span& subtrahend) noexcept;
+template <typename T> weak_ordering compare_linear_tables(T&& l, T&& r) noexcept;
 template <typename T> bool is_equal(T&& l, T&& r) noexcept;
 template <typename T> bool is_less(T&& l, T&& r) noexcept;
 template <typename T> bool is_less_or_equal(T&& l, T&& r) noexcept;
 template <typename T> bool is_greater_or_equal(T&& l, T&& r) noexcept;
 
-using nathalf = nat32;
-static natmax NUMBER_OF_NATHALF_STATE = 4294967296;
 static void propagate_carry_in_increase(span<natmax>&& parts, nat8& carry) noexcept;
 static void limit_value_after_increase(span<natmax>&& number_of_states, span<natmax>&& value) noexcept;
 static void propagate_borrow_in_decrease(span<natmax>&& parts, nat8& borrow) noexcept;
 static void limit_value_after_decrease(span<natmax>&& number_of_states, span<natmax>&& value) noexcept;
-static void propagate_carry_in_multiply(span<nathalf>&& parts, nathalf& carry) noexcept;
+static void mask_by_power_of_two(span<natmax> parts, sizevalue exponent) noexcept;
+static void fold_by_pseudo_mersenne(span<natmax> parts, sizevalue exponent, natmax offset, span<natmax> number_of_states, span<natmax> high) noexcept;
+static sizevalue length_without_high_zeros(span<natmax> parts) noexcept;
 
 template <typename T>
 byte_array generate_information_of_linear_table(T&& linear_table)
@@ -72,14 +99,170 @@ byte_array generate_information_of_linear_table(T&& linear_table)
 	return std::move(information);
 }
 
+// 逻辑规范：
+// 前置条件 P: number_of_states() 不存在高位0
+// 后置条件 Q: 根据 number_of_states() 设置 shape_of_number_of_states, exponent_of_number_of_states, offset_of_number_of_states, reciprocal_of_number_of_states
+void numerical_cell::classify_number_of_states() noexcept
+{
+	shape_of_number_of_states = states_shape::GENERAL;
+	exponent_of_number_of_states = 0;
+	offset_of_number_of_states = 0;
+	reciprocal_of_number_of_states = 0;
+	span<natmax> current_number_of_states = this->number_of_states();
+	if (current_number_of_states.empty()) {
+		return;
+	}
+	sizevalue bit_length = (current_number_of_states.size() - 1) * sizeof(natmax) * WORD_SIZE + std::bit_width(current_number_of_states.back());
+	// 状态数为 2^k (k = bit_length - 1)
+	if (std::has_single_bit(current_number_of_states.back()) and all_of(current_number_of_states.begin(), current_number_of_states.end() - 1, [](natmax v) { return v == 0; })) {
+		shape_of_number_of_states = states_shape::POWER_OF_TWO;
+		exponent_of_number_of_states = bit_length - 1;
+		return;
+	}
+	// 状态数为 2^k - c (k = bit_length)，c = 2^k - number_of_states 即 number_of_states 在 k 位下的补码
+	scratch_vector offset(current_number_of_states.begin(), current_number_of_states.end(), thread_local_pool());
+	nat8 borrow = 0;
+	for (auto& part : offset) {
+		part = subtract_with_borrow(0, part, borrow);
+	}
+	mask_by_power_of_two(span<natmax>(offset), bit_length);
+	if (all_of(offset.begin() + 1, offset.end(), [](natmax v) { return v == 0; }) and std::bit_width(offset.front()) <= bit_length / 2) {
+		shape_of_number_of_states = states_shape::PSEUDO_MERSENNE;
+		exponent_of_number_of_states = bit_length;
+		offset_of_number_of_states = offset.front();
+		return;
+	}
+	if (current_number_of_states.size() == 1) {
+		shape_of_number_of_states = states_shape::SINGLE_LIMB;
+		reciprocal_of_number_of_states = reciprocal_of_limb(current_number_of_states.front() << std::countl_zero(current_number_of_states.front()));
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: parts 非空，parts.back() = 0 (为折叠相加预留的单元)
+// 后置条件 Q: parts <- parts mod number_of_states()
+void numerical_cell::reduce_by_number_of_states(span<natmax> parts) const noexcept
+{
+	scratch_vector scratch = make_scratch_vector(max(parts.size(), this->number_of_states().size()));
+	reduce_by_number_of_states(parts, span<natmax>(scratch));
+}
+
+// 逻辑规范：
+// 前置条件 P: parts 非空，parts.back() = 0 (为折叠相加或者规范化预留的单元)，scratch.size() >= max(parts.size(), number_of_states().size())
+// 后置条件 Q: parts <- parts mod number_of_states()，scratch 的内容不确定
+void numerical_cell::reduce_by_number_of_states(span<natmax> parts, span<natmax> scratch) const noexcept
+{
+	runtime_assert(not parts.empty() and parts.back() == 0 and scratch.size() >= max(parts.size(), this->number_of_states().size()), "reduce_by_number_of_states 的前置条件不被满足");
+	span<natmax> current_number_of_states = this->number_of_states();
+	COUNT_CELL_REDUCTION(shape_of_number_of_states);
+	switch (shape_of_number_of_states) {
+	case states_shape::POWER_OF_TWO:
+		mask_by_power_of_two(parts, exponent_of_number_of_states);
+		break;
+	case states_shape::PSEUDO_MERSENNE:
+		fold_by_pseudo_mersenne(parts, exponent_of_number_of_states, offset_of_number_of_states, current_number_of_states, scratch.first(parts.size()));
+		break;
+	case states_shape::SINGLE_LIMB: {
+		sizevalue length = length_without_high_zeros(parts);
+		natmax remainder = divide_by_limb(parts.first(length), current_number_of_states.front(), reciprocal_of_number_of_states, span<natmax>{});
+		std::fill(parts.begin(), parts.begin() + length, 0);
+		parts.front() = remainder;
+		break;
+	}
+	case states_shape::GENERAL: {
+		// 有效单元数少于状态数的单元数时，parts 必然小于状态数
+		sizevalue length = length_without_high_zeros(parts);
+		if (length < current_number_of_states.size()) {
+			break;
+		}
+		// divide_in_place 会规范化除数，因此在 scratch 中复制一份状态数；被除数只取有效单元与预留的一个单元
+		span<natmax> divisor = scratch.first(current_number_of_states.size());
+		memcpy(divisor.data(), current_number_of_states.data(), divisor.size() * sizeof(natmax));
+		divide_in_place(parts.first(length + 1), divisor, span<natmax>{});
+		break;
+	}
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: parts 非空
+// 后置条件 Q: 返回 parts 去除高位0后的单元数 (至少为1)
+static sizevalue length_without_high_zeros(span<natmax> parts) noexcept
+{
+	sizevalue length = parts.size();
+	while (length > 1 and parts[length - 1] == 0) {
+		--length;
+	}
+	return length;
+}
+
+// 逻辑规范：
+// 前置条件 P: 无
+// 后置条件 Q: parts <- parts mod 2^exponent
+static void mask_by_power_of_two(span<natmax> parts, sizevalue exponent) noexcept
+{
+	sizevalue index = exponent / (sizeof(natmax) * WORD_SIZE);
+	if (index >= parts.size()) {
+		return;
+	}
+	parts[index] &= (static_cast<natmax>(1) << (exponent % (sizeof(natmax) * WORD_SIZE))) - 1;
+	memset(parts.data() + index + 1, 0, (parts.size() - index - 1) * sizeof(natmax));
+}
+
+// 逻辑规范：
+// 前置条件 P: number_of_states = 2^exponent - offset，其中 offset 的位数不超过 exponent / 2，parts 非空且 parts.back() = 0，high.size() >= parts.size()
+// 后置条件 Q: parts <- parts mod number_of_states，high 的内容不确定
+static void fold_by_pseudo_mersenne(span<natmax> parts, sizevalue exponent, natmax offset, span<natmax> number_of_states, span<natmax> high) noexcept
+{
+	constexpr sizevalue BITS_OF_NATMAX = sizeof(natmax) * WORD_SIZE;
+	sizevalue index = exponent / BITS_OF_NATMAX;
+	sizevalue shift = exponent % BITS_OF_NATMAX;
+	// 主循环：利用 2^exponent ≡ offset (mod number_of_states)，将 parts = high * 2^exponent + low 折叠为 low + high * offset
+	// 循环不变式：
+	//   parts mod number_of_states 保持不变，且每次折叠后 parts 的位数严格减少，直到 parts < 2^exponent
+	while (true) {
+		sizevalue length = find_if(parts.rbegin(), --parts.rend(), [](natmax v) { return v != 0; }).base() - parts.begin();
+		if (length <= index or (length == index + 1 and (parts[index] >> shift) == 0)) {
+			break;
+		}
+		// high <- parts 整除 2^exponent
+		sizevalue length_of_high = length - index;
+		for (sizevalue i = 0; i < length_of_high; ++i) {
+			natmax next = (shift != 0 and index + i + 1 < length) ? parts[index + i + 1] << (BITS_OF_NATMAX - shift) : 0;
+			high[i] = (parts[index + i] >> shift) | next;
+		}
+		// parts <- parts mod 2^exponent
+		mask_by_power_of_two(parts.first(length), exponent);
+		// parts <- parts + high * offset，由于预留了最高单元，结果不会溢出
+		natmax multiply_carry = 0;
+		nat8 carry = 0;
+		for (sizevalue i = 0; i < length_of_high; ++i) {
+			parts[i] = add_with_carry(parts[i], multiply_add(high[i], offset, 0, multiply_carry), carry);
+		}
+		parts[length_of_high] = add_with_carry(parts[length_of_high], multiply_carry, carry);
+		for (sizevalue i = length_of_high + 1; carry == 1 and i < parts.size(); ++i) {
+			parts[i] = add_with_carry(parts[i], 0, carry);
+		}
+	}
+	// 此时 parts < 2^exponent = number_of_states + offset < 2 * number_of_states，至多减去一次状态数
+	if (parts.size() < number_of_states.size()) {
+		return;
+	}
+	span<natmax> low = parts.first(number_of_states.size());
+	if (is_greater_or_equal(span<natmax>(low.first(find_if(low.rbegin(), --low.rend(), [](natmax v) { return v != 0; }).base() - low.begin())), span<natmax>(number_of_states))) {
+		nat8 borrow = 0;
+		for (sizevalue i = 0; i < low.size(); ++i) {
+			low[i] = subtract_with_borrow(low[i], number_of_states[i], borrow);
+		}
+	}
+}
+
 bool numerical_cell::bad() const noexcept
 {
 	auto number_of_states = this->number_of_states();
 	auto value = this->value();
-	if (number_of_states.size() < value.size()) {
-		return true;
-	}
-	else if (number_of_states.size() > value.size()) {
+	// 状态数不存在高位0，因此有效单元数较少时值必然小于状态数
+	if (length_of_value < number_of_states.size()) {
 		return false;
 	}
 	auto iterator_of_units = number_of_states.rbegin();
@@ -95,27 +278,35 @@ bool numerical_cell::bad() const noexcept
 	return true;
 }
 
-numerical_cell::numerical_cell(const numerical_cell& right) noexcept
+numerical_cell::numerical_cell(const numerical_cell& right) noexcept : content(right.resource())
 {
 	auto right_number_of_states = right.number_of_states();
 	auto right_value = right.value();
 	content.resize(right_number_of_states.size() * 2, 0);
 	memcpy(content.data() + right_number_of_states.size(), right_number_of_states.data(), right_number_of_states.size() * sizeof(natmax));
 	memcpy(content.data(), right_value.data(), right_number_of_states.size() * sizeof(natmax));
+	length_of_value = right.length_of_value;
+	shape_of_number_of_states = right.shape_of_number_of_states;
+	exponent_of_number_of_states = right.exponent_of_number_of_states;
+	offset_of_number_of_states = right.offset_of_number_of_states;
+	reciprocal_of_number_of_states = right.reciprocal_of_number_of_states;
 }
 
-numerical_cell::numerical_cell(numerical_cell&& right) noexcept
+numerical_cell::numerical_cell(numerical_cell&& right) noexcept : content(std::move(right.content))
 {
-	auto right_number_of_states = right.number_of_states();
-	auto right_value = right.value();
-	content.resize(right_number_of_states.size() * 2, 0);
-	memcpy(content.data() + right_number_of_states.size(), right_number_of_states.data(), right_number_of_states.size() * sizeof(natmax));
-	memcpy(content.data(), right_value.data(), right_number_of_states.size() * sizeof(natmax));
+	// 直接接管 right 的内存，right 变为空的数胞
+	length_of_value = right.length_of_value;
+	shape_of_number_of_states = right.shape_of_number_of_states;
+	exponent_of_number_of_states = right.exponent_of_number_of_states;
+	offset_of_number_of_states = right.offset_of_number_of_states;
+	reciprocal_of_number_of_states = right.reciprocal_of_number_of_states;
+	right.clear();
 }
 
 void numerical_cell::operator=(span<natmax> value) noexcept
 {
 	runtime_assert(not value.empty(), "数胞的=函数的前置条件不被满足");
+	COUNT_CELL_OPERATION(ASSIGN, this->number_of_states().size());
 
 	auto current_number_of_states = this->number_of_states();
 	auto current_value = this->value();
@@ -124,249 +315,68 @@ void numerical_cell::operator=(span<natmax> value) noexcept
 		return;
 	}
 	else if (is_less_or_equal(span<natmax>(current_number_of_states), span<natmax>(value))) {
-		vector<natmax> copy_value(value.begin(), value.end());
-		vector<natmax> remainder{};
+		scratch_vector remainder(value.begin(), value.end(), thread_local_pool());
+		remainder.push_back(0);
 		try {
-			remainder = mod_value_by_value(span<natmax>(const_cast<natmax*>(copy_value.data()), copy_value.size()), current_number_of_states);
+			reduce_by_number_of_states(span<natmax>(remainder));
 		}
 		catch (runtime_error& e) {
 			link_error(e, "在数胞的赋值函数中，自身状态数为" + generate_information_of_linear_table(current_number_of_states) + "，赋予的值为" + generate_information_of_linear_table(value));
 		}
-		memset(current_value.data(), 0, current_value.size());
+		remainder.erase(find_if(remainder.rbegin(), --remainder.rend(), [](natmax v) { return v != 0; }).base(), remainder.end());
+		memset(current_value.data(), 0, length_of_value * sizeof(natmax));
 		memcpy(current_value.data(), remainder.data(), remainder.size() * sizeof(natmax));
+		length_of_value = remainder.size();
 	}
 	else {
-		memset(current_value.data(), 0, current_value.size());
+		memset(current_value.data(), 0, length_of_value * sizeof(natmax));
 		memcpy(current_value.data(), value.data(), value.size() * sizeof(natmax));
+		length_of_value = value.size();
 	}
 }
 
 void numerical_cell::operator=(const numerical_cell& right) noexcept
 {
 	content = right.content;
+	length_of_value = right.length_of_value;
+	shape_of_number_of_states = right.shape_of_number_of_states;
+	exponent_of_number_of_states = right.exponent_of_number_of_states;
+	offset_of_number_of_states = right.offset_of_number_of_states;
+	reciprocal_of_number_of_states = right.reciprocal_of_number_of_states;
 }
 
 void numerical_cell::operator=(numerical_cell&& right) noexcept
 {
-	content = right.content;
-}
-
-// 逻辑规范：
-// 前置条件 P: dividend 和 divisor 皆有效 (作为无符号数解释)，且 divisor != 0
-// 后置条件 Q: 返回 dividend mod divisor (余数)
-// 注意: dividend 在调用此函数之后可能会被改变
-static vector<natmax> mod_value_by_value(const span<natmax>& dividend, const span<natmax> divisor) noexcept
-{
-	runtime_assert(dividend.size() > 0 and divisor.size() > 0, "在 mod_value_by_value 中被除数与除数至少有一个是无效的");
-	runtime_assert(not all_of(divisor.begin(), divisor.end(), [](const natmax value) { return value == 0; }), "在 mod_value_by_value 中发现除数为0");
-	// 将输入转换为位跨度
-	bit_span dividend_bit_span = bit_span(reinterpret_cast<::byte*>(dividend.data()), 0, dividend.size() * sizeof(natmax) * WORD_SIZE);
-	bit_span divisor_bit_span = bit_span(reinterpret_cast<::byte*>(divisor.data()), 0, divisor.size() * sizeof(natmax) * WORD_SIZE);
-	dividend_bit_span = dividend_bit_span.subspan(0, find_if(dividend_bit_span.rbegin(), --dividend_bit_span.rend(), [](::byte b) { return b != 0; }).base() - dividend_bit_span.begin());
-	divisor_bit_span = divisor_bit_span.subspan(0, find_if(divisor_bit_span.rbegin(), --divisor_bit_span.rend(), [](::byte b) { return b != 0; }).base() - divisor_bit_span.begin());
-
-	// 如果被除数位数小于除数位数，直接返回被除数
-	if (dividend_bit_span.size() < divisor_bit_span.size()) {
-		return vector<natmax>(dividend.begin(), dividend.end());
-	}
-
-	// 主循环：长除法求余数
-	// 循环不变式: 
-	//   dividend_bit_span 的当前值 = 原始被除数的高位部分
-	//   且 0 ≤ 当前余数 < divisor
-	for (sizevalue i = 0; i < dividend_bit_span.size(); ++i) {
-		// 取当前子跨度：从最高位到当前位
-		sizevalue start_index = dividend_bit_span.size() - 1 - i;
-		sizevalue length = i + 1;
-		auto sub_dividend = dividend_bit_span.subspan(start_index, length);
-		sub_dividend = sub_dividend.subspan(0, find_if(sub_dividend.rbegin(), --sub_dividend.rend(), [](::byte b) { return b != 0; }).base() - sub_dividend.begin());
-
-		// 循环不变式: 
-		//   sub_dividend 表示当前被处理的位段
-		//   该位段的值 >= divisor 或需要继续扩展
-
-		// 比较当前子跨度与除数
-		if (!is_less(bit_span(sub_dividend), bit_span(divisor_bit_span))) { // 即 sub_dividend >= divisor
-			// 执行减法：sub_dividend = sub_dividend - divisor
-			decrease_between_bit_spans(sub_dividend, divisor_bit_span);
-		}
-	}
-
-	// 后置条件: 余数在 dividend 的低位部分
-	// 计算余数的位数 (不超过除数的位数)
-	vector<natmax> remainder(dividend.size());
-
-	// 复制余数部分 (dividend 的低位)
-	memcpy(remainder.data(), dividend.data(), remainder.size() * sizeof(natmax));
-
-	// 删除结果中无用的0
-	remainder.erase(find_if(remainder.rbegin(), --remainder.rend(), [](natmax value) { return value != 0; }).base(), remainder.end());
-	return std::move(remainder);
-}
-
-// 逻辑规范：
-// 前置条件 P: dividend 和 divisor 皆有效 (作为无符号数解释)，且 divisor != 0
-// 后置条件 Q: 返回 dividend / divisor (整除)
-// 注意: dividend 在调用此函数之后可能会被改变
-static vector<natmax> div_value_by_value(const span<natmax>& dividend, const span<natmax> divisor) noexcept
-{
-	runtime_assert(dividend.size() > 0 and divisor.size() > 0, "在 mod_value_by_value 中被除数与除数至少有一个是无效的");
-	runtime_assert(not all_of(divisor.begin(), divisor.end(), [](const natmax value) { return value == 0; }), "在 mod_value_by_value 中发现除数为0");
-	// 将被除数和除数转换为比特数组
-	bit_span dividend_bit_span = bit_span(reinterpret_cast<::byte*>(dividend.data()), 0, dividend.size() * sizeof(natmax) * WORD_SIZE);
-	bit_span divisor_bit_span = bit_span(reinterpret_cast<::byte*>(divisor.data()), 0, divisor.size() * sizeof(natmax) * WORD_SIZE);
-	dividend_bit_span = dividend_bit_span.subspan(0, find_if(dividend_bit_span.rbegin(), dividend_bit_span.rend(), [](::byte b) { return b != 0; }).base() - dividend_bit_span.begin());
-	divisor_bit_span = divisor_bit_span.subspan(0, find_if(divisor_bit_span.rbegin(), divisor_bit_span.rend(), [](::byte b) { return b != 0; }).base() - divisor_bit_span.begin());
-
-	// 如果在二进制形式下被除数的长度小于除数的长度，则说明被除数一定小于除数，此时相除必定为0
-	if (dividend_bit_span.size() < divisor_bit_span.size()) {
-		return vector<natmax>(1, 0);
-	}
-
-	vector<natmax> result(dividend.size()); // 存储相除的结果的比特数组
-	bit_span result_bitarray = bit_span(reinterpret_cast<::byte*>(result.data()), 0, result.size() * sizeof(natmax) * WORD_SIZE);
-	auto iterator_of_result = result_bitarray.rbegin();
-	// 主循环：长除法求商
-	for (sizevalue i = 0; i < dividend_bit_span.size(); ++i) {
-		// 取当前子跨度：从最高位到当前位
-		sizevalue start_index = dividend_bit_span.size() - 1 - i;
-		sizevalue length = i + 1;
-		auto sub_dividend = dividend_bit_span.subspan(start_index, length);
-		sub_dividend = sub_dividend.subspan(0, find_if(sub_dividend.rbegin(), sub_dividend.rend(), [](::byte b) { return b != 0; }).base() - sub_dividend.begin());
-		// 如果目前循环取到的被除数部分小于除数，则不能进行相减计算，即不能在此位相除
-		if (bit_is_less(sub_dividend, divisor_bit_span)) {
-			*iterator_of_result = false;
-			++iterator_of_result;
-			continue;
-		}
-		// 如果可以，则将被除数的选择部分与除数对齐相减，为之后的计算奠定基础，并将此位的比特设置为true，说明可以在此位相除
-		decrease_between_bit_spans(sub_dividend, divisor_bit_span);
-		*iterator_of_result = true;
-		++iterator_of_result;
-	}
-	// 删除结果中无用的0
-	result.erase(find_if(result.rbegin(), --result.rend(), [](natmax value) { return value != 0; }).base(), result.end());
-	return std::move(result);
+	// 两者的内存资源相同时直接接管 right 的内存，否则在自身的内存资源中复制；之后 right 变为空的数胞
+	content = std::move(right.content);
+	length_of_value = right.length_of_value;
+	shape_of_number_of_states = right.shape_of_number_of_states;
+	exponent_of_number_of_states = right.exponent_of_number_of_states;
+	offset_of_number_of_states = right.offset_of_number_of_states;
+	reciprocal_of_number_of_states = right.reciprocal_of_number_of_states;
+	right.clear();
 }
 
 // 逻辑规范：
 // 前置条件 P: l,r 皆为有效的非空线性表 (两者均作为自然数解释, l.size() > 0, r.size() > 0)，且l,r均不存在高位无效0 (l.size() > 1 => l.back() != 0, r.size() > 1 => r.back() != 0)
-// 后置条件 Q: 返回 l < r
+// 后置条件 Q: 返回 l 与 r 的大小关系
+// 两者都不存在高位0，因此长度不同时长者较大；长度相同时自高位向低位找到第一个不同的单元，只扫描一遍
 template <typename T>
-bool bit_is_less(T&& l, T&& r) noexcept
+weak_ordering compare_linear_tables(T&& l, T&& r) noexcept
 {
 	// 前置条件: l.size() > 0, r.size() > 0, l.back() != 0, r.back() != 0
-	if (l.size() < r.size()) {
-		return true;
+	runtime_assert(l.size() > 0 and r.size() > 0 and (l.size() > 1 ? l.back() != 0 : true) and (r.size() > 1 ? r.back() != 0 : true), "compare_linear_tables 的前置条件不被满足");
+	if (l.size() != r.size()) {
+		return l.size() <=> r.size();
 	}
-	// l.size() < r.size() => 返回 true 或者 l.size() >= r.size()
-	if (l.size() > r.size()) {
-		return false;
-	}
-	// l.size() < r.size() => 返回 true 或者 l.size() > r.size() => 返回 false 或者 l.size() = r.size()
-	// 主循环：满足 l.size() = r.size()
-	// 循环不变式：
-	//   设 L = l.size() = r.size()
-	//   对于当前索引 i (0 <= i < L):
-	//     High_{L-i-1}(l) = High_{L-i-1}(r) 并且 (i = sizevalue_max 或者 i < L)
-	//   其中 High_k(X) 表示 X 的高 k (k >= 0) 位组成的自然数 (当 k=0 时定义为空，恒成立)
+	// 循环不变式：High_{L-i-1}(l) = High_{L-i-1}(r)，其中 L = l.size() = r.size()，High_k(X) 表示 X 的高 k 个单元组成的自然数
 	for (sizevalue i = l.size() - 1; i < l.size(); --i) {
-		if (l[i] < r[i]) {
-			return true;
-		}
-		// (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] < r[i] => l < r => 返回 true) 或者 (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] >= r[i])
-		if (l[i] > r[i]) {
-			return false;
-		}
-		// (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] > r[i] => l > r => 返回 false) 或者 High_{L-i}(l) = High_{L-i}(r)
-	}
-	// l = r => 返回 false
-	return false;
-}
-
-static vector<natmax> bit_span_to_number(bit_span bs)
-{
-	// 计算需要的 natmax 数量
-	const size_t num_bits = bs.size();
-	const size_t num_words = (num_bits + 63) / 64;
-	vector<natmax> result(num_words, 0);
-
-	if (result.empty()) {
-		return result;
-	}
-
-	// 获取位迭代器
-	auto bit_iter = bs.begin();
-	// 逐位复制
-	for (size_t i = 0; i < num_bits; ++i, ++bit_iter) {
-		const size_t word_idx = i / 64;
-		const size_t bit_idx = i % 64;
-
-		if (*bit_iter) {
-			result[word_idx] |= (static_cast<natmax>(1) << bit_idx);
+		if (l[i] != r[i]) {
+			return l[i] <=> r[i];
 		}
 	}
-	return result;
-}
-
-// 逻辑规范：
-// 前置条件 P: minuend >= subtrahend (作为无符号整数解释)，且两者均为有效位跨度
-// 后置条件 Q: minuend := minuend - subtrahend
-static void decrease_between_bit_spans(bit_span& minuend, const bit_span& subtrahend) noexcept
-{
-	// 前置条件: minuend >= subtrahend
-	sizevalue culculate_length = min(minuend.size(), subtrahend.size());
-	// culculate_length := min(minuend.size(), subtrahend.size())
-	bool borrow = false;
-
-	vector<natmax> temp = bit_span_to_number(minuend);
-	bit_span original_minuend(reinterpret_cast<::byte*>(temp.data()), 0, temp.size() * sizeof(natmax) * WORD_SIZE); // 原来的 minuend，用于断言
-	// 主循环：处理公共位段 (0 到 culculate_length-1)
-	// 循环不变式: 
-	//   设 A = old(minuend), B = subtrahend, L = min(size)
-	//   对于当前处理的位索引 i (0 ≤ i ≤ culculate_length):
-	//     Low_i(minuend) = Low_i(A) - Low_i(B) - 2^i * borrow
-	//   其中 Low_k(X) = X mod 2^k，表示 X 的低 k 位组成的自然数
-	for (sizevalue i = 0; i < culculate_length; ++i) {
-		if (minuend[i] == true) {
-			if (subtrahend[i] == true) {
-				minuend[i] = borrow ? true : false;
-			}
-			else {
-				minuend[i] = borrow ? false : true;
-				borrow = false;
-			}
-			// minuend[i] := (1 - subtrahend[i] - borrow) mod 2
-		}
-		else {
-			if (subtrahend[i] == true) {
-				minuend[i] = borrow ? false : true;
-				borrow = true;
-			}
-			else {
-				minuend[i] = borrow ? true : false;
-			}
-			// minuend[i] := (0 - subtrahend[i] - borrow) mod 2
-		}
-		// minuend[i] := (minuend[i] - subtrahend[i] - borrow) mod 2
-		// borrow := (minuend[i] - subtrahend[i] - borrow) // 2
-	}
-
-	// 处理借位传播 (当 minuend 有更高位时)
-	// 不变式: 
-	//   minuend 的当前值 + 2^{culculate_length} * borrow = 
-	//      old(minuend) - subtrahend (仅低 culculate_length 位部分)
-	if (borrow) {
-		sizevalue offset = 0;
-		// 借位传播：从 culculate_length 开始向高位传播
-		// 终止条件：当遇到一个位翻转后为 false (即原为 true)
-		do {
-			// 翻转当前高位位 (借位传播)
-			minuend[culculate_length + offset] = not minuend[culculate_length + offset];
-			++offset;
-		} while (minuend[culculate_length + offset - 1] == true);
-	}
-	// 后置条件: minuend = old(minuend) - subtrahend
+	// l = r
+	return weak_ordering::equivalent;
 }
 
 // 逻辑规范：
@@ -375,43 +385,7 @@ static void decrease_between_bit_spans(bit_span& minuend, const bit_span& subtra
 template <typename T>
 bool is_equal(T&& l, T&& r) noexcept
 {
-	// 前置条件: l.size() > 0, r.size() > 0, l.back() != 0, r.back() != 0
-	runtime_assert(l.size() > 0 and r.size() > 0 and (l.size() > 1 ? l.back() != 0 : true) and (r.size() > 1 ? r.back() != 0 : true), "is_equal 的前置条件不被满足");
-	if (l.size() < r.size()) {
-		return false;
-	}
-	// l.size() < r.size() => 返回 false 或者 l.size() >= r.size()
-	if (l.size() > r.size()) {
-		return false;
-	}
-	// l.size() < r.size() => 返回 false 或者 l.size() > r.size() => 返回 false 或者 l.size() = r.size()
-	// 主循环：满足 l.size() = r.size()
-	// 循环不变式：
-	//   设 L = l.size() = r.size()
-	//   对于当前索引 i (0 <= i < L):
-	//     High_{L-i-1}(l) = High_{L-i-1}(r) 并且 (i = sizevalue_max 或者 i < L)
-	//   其中 High_k(X) 表示 X 的高 k (k >= 0) 位组成的自然数 (当 k=0 时定义为空，恒成立)
-	sizevalue L = l.size();
-	for (sizevalue i = l.size() - 1; i < l.size(); --i) {
-		T high_l(l.begin() + i + 1, l.end());
-		T high_r(r.begin() + i + 1, r.end());
-		for (sizevalue j = 0; j < L - i - 1; ++j) {
-			runtime_assert(high_l[j] == high_r[j] and (i == sizevalue_max or i < L), "is_equal 的循环不变式不被满足");
-		}
-		if (l[i] < r[i]) {
-			return false;
-		}
-		// (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] < r[i] => l < r => 返回 false) 或者 (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] >= r[i])
-		if (l[i] > r[i]) {
-			return false;
-		}
-		// (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] > r[i] => l > r => 返回 false) 或者 High_{L-i}(l) = High_{L-i}(r)
-	}
-	for (sizevalue j = 0; j < L; ++j) {
-		runtime_assert(l[j] == r[j], "is_equal 的循环不变式不被满足");
-	}
-	// l = r => 返回 true
-	return true;
+	return compare_linear_tables(l, r) == 0;
 }
 
 // 逻辑规范：
@@ -420,43 +394,7 @@ bool is_equal(T&& l, T&& r) noexcept
 template <typename T>
 bool is_less(T&& l, T&& r) noexcept
 {
-	// 前置条件: l.size() > 0, r.size() > 0, l.back() != 0, r.back() != 0
-	runtime_assert(l.size() > 0 and r.size() > 0 and (l.size() > 1 ? l.back() != 0 : true) and (r.size() > 1 ? r.back() != 0 : true), "is_less 的前置条件不被满足");
-	if (l.size() < r.size()) {
-		return true;
-	}
-	// l.size() < r.size() => 返回 true 或者 l.size() >= r.size()
-	if (l.size() > r.size()) {
-		return false;
-	}
-	// l.size() < r.size() => 返回 true 或者 l.size() > r.size() => 返回 false 或者 l.size() = r.size()
-	// 主循环：满足 l.size() = r.size()
-	// 循环不变式：
-	//   设 L = l.size() = r.size()
-	//   对于当前索引 i (0 <= i < L):
-	//     High_{L-i-1}(l) = High_{L-i-1}(r) 并且 (i = sizevalue_max 或者 i < L)
-	//   其中 High_k(X) 表示 X 的高 k (k >= 0) 位组成的自然数 (当 k=0 时定义为空，恒成立)
-	sizevalue L = l.size();
-	for (sizevalue i = l.size() - 1; i < l.size(); --i) {
-		T high_l(l.begin() + i + 1, l.end());
-		T high_r(r.begin() + i + 1, r.end());
-		for (sizevalue j = 0; j < L - i - 1; ++j) {
-			runtime_assert(high_l[j] == high_r[j] and (i == sizevalue_max or i < L), "is_less 的循环不变式不被满足");
-		}
-		if (l[i] < r[i]) {
-			return true;
-		}
-		// (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] < r[i] => l < r => 返回 true) 或者 (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] >= r[i])
-		if (l[i] > r[i]) {
-			return false;
-		}
-		// (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] > r[i] => l > r => 返回 false) 或者 High_{L-i}(l) = High_{L-i}(r)
-	}
-	for (sizevalue j = 0; j < L; ++j) {
-		runtime_assert(l[j] == r[j], "is_less 的循环不变式不被满足");
-	}
-	// l = r => 返回 false
-	return false;
+	return compare_linear_tables(l, r) < 0;
 }
 
 // 逻辑规范：
@@ -465,43 +403,7 @@ bool is_less(T&& l, T&& r) noexcept
 template <typename T>
 bool is_less_or_equal(T&& l, T&& r) noexcept
 {
-	// 前置条件: l.size() > 0, r.size() > 0, l.back() != 0, r.back() != 0
-	runtime_assert(l.size() > 0 and r.size() > 0 and (l.size() > 1 ? l.back() != 0 : true) and (r.size() > 1 ? r.back() != 0 : true), "is_less_or_equal 的前置条件不被满足");
-	if (l.size() < r.size()) {
-		return true;
-	}
-	// l.size() < r.size() => 返回 true 或者 l.size() >= r.size()
-	if (l.size() > r.size()) {
-		return false;
-	}
-	// l.size() < r.size() => 返回 true 或者 l.size() > r.size() => 返回 false 或者 l.size() = r.size()
-	// 主循环：满足 l.size() = r.size()
-	// 循环不变式：
-	//   设 L = l.size() = r.size()
-	//   对于当前索引 i (0 <= i < L):
-	//     High_{L-i-1}(l) = High_{L-i-1}(r) 并且 (i = sizevalue_max 或者 i < L)
-	//   其中 High_k(X) 表示 X 的高 k (k >= 0) 位组成的自然数 (当 k=0 时定义为空，恒成立)
-	sizevalue L = l.size();
-	for (sizevalue i = l.size() - 1; i < l.size(); --i) {
-		T high_l(l.begin() + i + 1, l.end());
-		T high_r(r.begin() + i + 1, r.end());
-		for (sizevalue j = 0; j < L - i - 1; ++j) {
-			runtime_assert(high_l[j] == high_r[j] and (i == sizevalue_max or i < L), "is_less_or_equal 的循环不变式不被满足");
-		}
-		if (l[i] < r[i]) {
-			return true;
-		}
-		// (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] < r[i] => l < r => 返回 true) 或者 (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] >= r[i])
-		if (l[i] > r[i]) {
-			return false;
-		}
-		// (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] > r[i] => l > r => 返回 false) 或者 High_{L-i}(l) = High_{L-i}(r)
-	}
-	for (sizevalue j = 0; j < L; ++j) {
-		runtime_assert(l[j] == r[j], "is_less_or_equal 的循环不变式不被满足");
-	}
-	// l = r => 返回 true
-	return true;
+	return compare_linear_tables(l, r) <= 0;
 }
 
 // 逻辑规范：
@@ -510,43 +412,7 @@ bool is_less_or_equal(T&& l, T&& r) noexcept
 template <typename T>
 bool is_greater_or_equal(T&& l, T&& r) noexcept
 {
-	// 前置条件: l.size() > 0, r.size() > 0, l.back() != 0, r.back() != 0
-	runtime_assert(l.size() > 0 and r.size() > 0 and (l.size() > 1 ? l.back() != 0 : true) and (r.size() > 1 ? r.back() != 0 : true), "is_less 的前置条件不被满足");
-	if (l.size() < r.size()) {
-		return false;
-	}
-	// l.size() < r.size() => 返回 false 或者 l.size() >= r.size()
-	if (l.size() > r.size()) {
-		return true;
-	}
-	// l.size() < r.size() => 返回 false 或者 l.size() > r.size() => 返回 true 或者 l.size() = r.size()
-	// 主循环：满足 l.size() = r.size()
-	// 循环不变式：
-	//   设 L = l.size() = r.size()
-	//   对于当前索引 i (0 <= i < L):
-	//     High_{L-i-1}(l) = High_{L-i-1}(r) 并且 (i = sizevalue_max 或者 i < L)
-	//   其中 High_k(X) 表示 X 的高 k (k >= 0) 位组成的自然数 (当 k=0 时定义为空，恒成立)
-	sizevalue L = l.size();
-	for (sizevalue i = l.size() - 1; i < l.size(); --i) {
-		T high_l(l.begin() + i + 1, l.end());
-		T high_r(r.begin() + i + 1, r.end());
-		for (sizevalue j = 0; j < L - i - 1; ++j) {
-			runtime_assert(high_l[j] == high_r[j] and (i == sizevalue_max or i < L), "is_greater_or_equal 的循环不变式不被满足");
-		}
-		if (l[i] < r[i]) {
-			return false;
-		}
-		// (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] < r[i] => l < r => 返回 false) 或者 (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] >= r[i])
-		if (l[i] > r[i]) {
-			return true;
-		}
-		// (High_{L-i-1}(l) = High_{L-i-1}(r) 并且 l[i] > r[i] => l > r => 返回 true) 或者 High_{L-i}(l) = High_{L-i}(r)
-	}
-	for (sizevalue j = 0; j < L; ++j) {
-		runtime_assert(l[j] == r[j], "is_greater_or_equal 的循环不变式不被满足");
-	}
-	// l = r => 返回 true
-	return true;
+	return compare_linear_tables(l, r) >= 0;
 }
 
 // 在运行 += 函数时，当 right 的值大于等于自身的状态数时，应调用此函数进行后续处理
@@ -557,11 +423,13 @@ void numerical_cell::limit_right_value_then_increase(numerical_cell& left, const
 {
 	// 前置条件: not left.content.empty() and not right.content.empty()
 	runtime_assert(not left.content.empty() and not right.content.empty(), "limit_right_value_then_increase 的前置条件不被满足");
-	vector<natmax> copy_right_value(right.value().begin(), right.value().end());
-	// copy_right_value = right.value()
-	vector<natmax> remainder = mod_value_by_value(span<natmax>(copy_right_value.data(), copy_right_value.size()), left.number_of_states());
-	// remainder = copy_right_value mod left.number_of_states() = right.value() mod left.number_of_states()
-	numerical_cell limited_right(right.number_of_states(), span<natmax>(remainder.data(), remainder.size()));
+	COUNT_CELL_SLOW_PATH(LIMIT_RIGHT_VALUE_THEN_INCREASE);
+	scratch_vector remainder(right.significant_value().begin(), right.significant_value().end(), thread_local_pool());
+	remainder.push_back(0);
+	// remainder = right.value()，并预留一个单元
+	left.reduce_by_number_of_states(span<natmax>(remainder));
+	// remainder = right.value() mod left.number_of_states()
+	numerical_cell limited_right(right.number_of_states(), span<natmax>(remainder.data(), remainder.size()), thread_local_pool());
 	// limited_right = numerical_cell(right.number_of_states(), remainder)
 	left += limited_right;
 	// 后置条件: left <- left + limited_right = left + right
@@ -602,6 +470,7 @@ static void limit_value_after_increase(span<natmax>&& number_of_states, span<nat
 {
 	// 前置条件: not number_of_states.empty() and not value.empty()
 	runtime_assert(not number_of_states.empty() and not value.empty() and number_of_states.size() == value.size(), "limit_value_after_increase 的前置条件不被满足");
+	COUNT_CELL_SLOW_PATH(LIMIT_VALUE_AFTER_INCREASE);
 	// 当 number_of_states 的大小为1时，说明 value 的大小理应也为1，此时只需一次计算即可
 	if (number_of_states.size() == 1) {
 		value.front() -= (number_of_states.front());
@@ -618,19 +487,9 @@ static void limit_value_after_increase(span<natmax>&& number_of_states, span<nat
 	auto iterator_of_right = number_of_states.begin();
 	nat8 borrow = 0; // 借位
 	for (auto it = value.begin(); it != value.end(); ++it) {
-		sizevalue i = it - value.begin();
-
-		natmax buffer = *it; // 临时存储减法前的值，稍后用于检查此次减法是否产生借位
-		// buffer = value_i
-		*it = *it - *iterator_of_right - borrow;
+		*it = subtract_with_borrow(*it, *iterator_of_right, borrow);
 		// value_i <- value_i - number_of_states_i - borrow (当value_i >= number_of_states_i + borrow时)
 		// value_i <- value_i + B - number_of_states_i - borrow (当value_i < number_of_states_i + borrow时)
-		nat8 last_borrow = borrow;
-		borrow = 0;
-		// 检查此次减法是否产生借位
-		if (*it > buffer or (last_borrow == 1 and *it == buffer)) {
-			borrow = 1; // 使下次减法额外减1（若还有下次减法）
-		}
 		// borrow <- 0 (当不产生借位时)
 		// borrow <- 1 (当产生借位时)
 		++iterator_of_right;
@@ -646,13 +505,13 @@ void numerical_cell::operator+=(const numerical_cell& right) noexcept
 	// 前置条件: not this->content.empty() and not right.content.empty()
 	runtime_assert(not this->content.empty() and not right.content.empty(), "数胞的+=函数的前置条件不被满足");
 	span<natmax> current_value = this->value();
-	span<natmax> right_value = right.value();
-	right_value = right_value.subspan(0, find_if(right_value.rbegin(), --right_value.rend(), [](const natmax v) { return v != 0; }).base() - right_value.begin());
+	span<natmax> right_value = right.significant_value();
 	// 当 right 的值大于等于自身的状态数时，需要将 right 的值限制在自身的状态数中，才能正确相加
 	if (is_less_or_equal(this->number_of_states(), span<natmax>(right_value))) {
 		limit_right_value_then_increase(*this, right);
 		return;
 	}
+	COUNT_CELL_OPERATION(ADD, current_value.size());
 	// 如果 this->number_of_states() <= right_value，则 *this <- *this + right，返回
 
 	// 主循环：满足 this->number_of_states() > right_value
@@ -663,23 +522,13 @@ void numerical_cell::operator+=(const numerical_cell& right) noexcept
 	auto iterator_of_right = right_value.begin();
 	nat8 carry = 0; // 进位
 	for (auto it = current_value.begin(); it != current_value.end(); ++it) {
-		sizevalue i = it - current_value.begin();
-
 		// 如果 right 的迭代器结束了，将可能为1的进位加到自身迭代器的值上，退出循环
 		if (iterator_of_right == right_value.end()) {
 			propagate_carry_in_increase(span<natmax>(current_value.data() + (it - current_value.begin()), current_value.size() - (it - current_value.begin())), carry);
 			break;
 		}
-		natmax buffer = *it; // 临时存储加法前的值，稍后用于检查此次加法是否产生进位
-		// buffer = current_value_i
-		*it = *it + *iterator_of_right + carry;
+		*it = add_with_carry(*it, *iterator_of_right, carry);
 		// current_value_i <- (current_value_i + right_value_i + carry) mod B
-		nat8 last_carry = carry;
-		carry = 0;
-		// 检查此次加法是否产生进位
-		if (*it < buffer or (last_carry == 1 and *it == buffer)) {
-			carry = 1; // 使下次加法额外加1 (若还有下次加法)
-		}
 		// carry <- 0 (当不产生进位时)
 		// carry <- 1 (当产生进位时)
 		++iterator_of_right;
@@ -687,8 +536,16 @@ void numerical_cell::operator+=(const numerical_cell& right) noexcept
 	// 计算完成后有两种情况
 	// 1. 最后一步产生进位(carry == 1)或没有产生进位，但是自身的值溢出(产生进位时一定不会溢出)，此时需要将自身值减去自身的状态数，方能得到正确结果
 	// 2. 没有产生进位，自身的值也没有溢出，此时不需要进行处理
-	if (carry == 1 or bad()) {
+	// 相加的结果至多比两者中较长的一方多一个单元
+	refresh_length_of_value(max(length_of_value, right_value.size()) + 1);
+	if (shape_of_number_of_states == states_shape::POWER_OF_TWO) {
+		// 状态数为 2^k 时，进位与溢出的部分恰好是第k位及以上的位，直接舍去即可
+		mask_by_power_of_two(this->significant_value(), exponent_of_number_of_states);
+		refresh_length_of_value(length_of_value);
+	}
+	else if (carry == 1 or bad()) {
 		limit_value_after_increase(this->number_of_states(), this->value());
+		refresh_length_of_value(current_value.size());
 	}
 	// 后置条件: *this <- *this + right
 }
@@ -701,11 +558,13 @@ void numerical_cell::limit_right_value_then_decrease(numerical_cell& left, const
 {
 	// 前置条件: not left.content.empty() and not right.content.empty()
 	runtime_assert(not left.content.empty() and not right.content.empty(), "limit_right_value_then_decrease 的前置条件不被满足");
-	vector<natmax> copy_right_value(right.value().begin(), right.value().end());
-	// copy_right_value = right.value()
-	vector<natmax> remainder = mod_value_by_value(span<natmax>(copy_right_value.data(), copy_right_value.size()), left.number_of_states());
-	// remainder = copy_right_value mod left.number_of_states() = right.value() mod left.number_of_states()
-	numerical_cell limited_right(right.number_of_states(), span<natmax>(remainder.data(), remainder.size()));
+	COUNT_CELL_SLOW_PATH(LIMIT_RIGHT_VALUE_THEN_DECREASE);
+	scratch_vector remainder(right.significant_value().begin(), right.significant_value().end(), thread_local_pool());
+	remainder.push_back(0);
+	// remainder = right.value()，并预留一个单元
+	left.reduce_by_number_of_states(span<natmax>(remainder));
+	// remainder = right.value() mod left.number_of_states()
+	numerical_cell limited_right(right.number_of_states(), span<natmax>(remainder.data(), remainder.size()), thread_local_pool());
 	// limited_right = numerical_cell(right.number_of_states(), remainder)
 	left -= limited_right;
 	// 后置条件: left <- left - limited_right = left - right
@@ -719,7 +578,7 @@ void numerical_cell::limit_right_value_then_decrease(numerical_cell& left, const
 static void propagate_borrow_in_decrease(span<natmax>&& parts, nat8& borrow) noexcept
 {
 	// 前置条件: not parts.empty()
-	runtime_assert(not parts.empty() and (borrow == 1 or borrow == 1), "propagate_borrow_in_decrease 的前置条件不被满足");
+	runtime_assert(not parts.empty() and (borrow == 0 or borrow == 1), "propagate_borrow_in_decrease 的前置条件不被满足");
 	if (borrow == 0) {
 		return;
 	}
@@ -746,6 +605,7 @@ static void limit_value_after_decrease(span<natmax>&& number_of_states, span<nat
 {
 	// 前置条件: not number_of_states.empty() and not value.empty()
 	runtime_assert(not number_of_states.empty() and not value.empty() and number_of_states.size() == value.size(), "limit_value_after_decrease 的前置条件不被满足");
+	COUNT_CELL_SLOW_PATH(LIMIT_VALUE_AFTER_DECREASE);
 	// 当 number_of_states 的大小为1时，说明 value 的大小理应也为1，此时只需一次计算即可
 	if (number_of_states.size() == 1) {
 		value.front() += (number_of_states.front());
@@ -760,21 +620,11 @@ static void limit_value_after_decrease(span<natmax>&& number_of_states, span<nat
 	//   value_{new} = value_{old} + Low_{i}(number_of_states) - carry * B^i 并且 i <= value.size()
 	//   其中 Low_k(X) 表示 X 的低 k 位组成的自然数
 	auto iterator_of_right = number_of_states.begin();
-	nat8 carry = 0; // 借位
+	nat8 carry = 0; // 进位
 	for (auto it = value.begin(); it != value.end(); ++it) {
-		sizevalue i = it - value.begin();
-		
-		natmax buffer = *it; // 临时存储加法前的值，稍后用于检查此次加法是否产生进位
-		// buffer = value_i
-		*it = *it + *iterator_of_right + carry;
+		*it = add_with_carry(*it, *iterator_of_right, carry);
 		// value_i <- value_i + number_of_states_i + carry (当value_i + number_of_states_i + carry < B时)
 		// value_i <- value_i - B + number_of_states_i + carry (当value_i + number_of_states_i + carry >= B时)
-		nat8 last_carry = carry;
-		carry = 0;
-		// 检查此次加法是否产生进位
-		if (*it < buffer or (last_carry == 1 and *it == buffer)) {
-			carry = 1; // 使下次加法额外加1（若还有下次加法）
-		}
 		// carry <- 0 (当不产生进位时)
 		// carry <- 1 (当产生进位时)
 		++iterator_of_right;
@@ -790,13 +640,13 @@ void numerical_cell::operator-=(const numerical_cell& right) noexcept
 	// 前置条件: not this->content.empty() and not right.content.empty()
 	runtime_assert(not this->content.empty() and not right.content.empty(), "数胞的-=函数的前置条件不被满足");
 	span<natmax> current_value = this->value();
-	span<natmax> right_value = right.value();
-	right_value = right_value.subspan(0, find_if(right_value.rbegin(), --right_value.rend(), [](const natmax v) { return v != 0; }).base() - right_value.begin());
+	span<natmax> right_value = right.significant_value();
 	// 当 right 的值大于自身的状态数限制时，需要将 right 的值限制在自身的状态数中，才能正确相减
 	if (is_less_or_equal(this->number_of_states(), span<natmax>(right_value))) {
 		limit_right_value_then_decrease(*this, right);
 		return;
 	}
+	COUNT_CELL_OPERATION(SUBTRACT, current_value.size());
 	// 如果 this->number_of_states() <= right_value，则 *this <- *this - right，返回
 
 	// 主循环：满足 this->number_of_states() > right_value
@@ -807,23 +657,13 @@ void numerical_cell::operator-=(const numerical_cell& right) noexcept
 	auto iterator_of_right = right_value.begin();
 	nat8 borrow = 0; // 借位
 	for (auto it = current_value.begin(); it != current_value.end(); ++it) {
-		sizevalue i = it - current_value.begin();
-		
 		// 如果 right 的迭代器结束了，将可能为1的借位减到自身迭代器的值上，退出循环
 		if (iterator_of_right == right_value.end()) {
 			propagate_borrow_in_decrease(span<natmax>(current_value.data() + (it - current_value.begin()), current_value.size() - (it - current_value.begin())), borrow);
 			break;
 		}
-		natmax buffer = *it; // 临时存储减法前的值，稍后用于检查此次减法是否产生借位
-		// buffer = current_value_i
-		*it = *it - *iterator_of_right - borrow;
+		*it = subtract_with_borrow(*it, *iterator_of_right, borrow);
 		// current_value_i <- (current_value_i - right_value_i - borrow) mod B
-		nat8 last_borrow = borrow;
-		borrow = 0;
-		// 检查此次减法是否产生借位
-		if (*it > buffer or (last_borrow == 1 and *it == buffer)) {
-			borrow = 1; // 使下次减法额外减1（若还有下次减法）
-		}
 		// borrow <- 0 (当不产生借位时)
 		// borrow <- 1 (当产生借位时)
 		++iterator_of_right;
@@ -831,8 +671,18 @@ void numerical_cell::operator-=(const numerical_cell& right) noexcept
 	// 计算完成后有两种情况
 	// 1. 自身的值溢出(value >= number_of_states，溢出时一定产生借位)或自身的值没有溢出，但是最后一步产生借位，此时需要将自身值加上自身的状态数，方能得到正确结果
 	// 2. 自身的值没有溢出，也没有产生借位，此时不需要进行处理
-	if (borrow == 1 or bad()) {
+	if (borrow == 1 and shape_of_number_of_states == states_shape::POWER_OF_TWO) {
+		// 状态数为 2^k 时，借位使值按 B^{value().size()} 回绕，而 2^k 整除 B^{value().size()}，屏蔽高位即可
+		mask_by_power_of_two(current_value, exponent_of_number_of_states);
+		refresh_length_of_value(current_value.size());
+	}
+	else if (borrow == 1 or bad()) {
 		limit_value_after_decrease(this->number_of_states(), this->value());
+		refresh_length_of_value(current_value.size());
+	}
+	else {
+		// 没有借位时，相减的结果不大于原值
+		refresh_length_of_value(length_of_value);
 	}
 	// 后置条件: *this <- *this - right
 }
@@ -841,143 +691,300 @@ void numerical_cell::operator-=(const numerical_cell& right) noexcept
 // 逻辑规范：
 // 前置条件 P: left, right 皆为有效的数胞 (not left.content.empty() and not right.content.empty())
 // 后置条件 Q: left <- left * right
-void numerical_cell::limit_right_value_then_multiply(numerical_cell& left, const numerical_cell& right) noexcept
+void numerical_cell::limit_right_value_then_multiply(numerical_cell& left, const numerical_cell& right, sizevalue number_of_threads) noexcept
 {
 	// 前置条件: not left.content.empty() and not right.content.empty()
 	runtime_assert(not left.content.empty() and not right.content.empty(), "limit_right_value_then_multiply 的前置条件不被满足");
-	vector<natmax> copy_right_value(right.value().begin(), right.value().end());
-	// copy_right_value = right.value()
-	vector<natmax> remainder = mod_value_by_value(span<natmax>(copy_right_value.data(), copy_right_value.size()), left.number_of_states());
-	// remainder = copy_right_value mod left.number_of_states() = right.value() mod left.number_of_states()
-	numerical_cell limited_right(right.number_of_states(), span<natmax>(remainder.data(), remainder.size()));
+	COUNT_CELL_SLOW_PATH(LIMIT_RIGHT_VALUE_THEN_MULTIPLY);
+	scratch_vector remainder(right.significant_value().begin(), right.significant_value().end(), thread_local_pool());
+	remainder.push_back(0);
+	// remainder = right.value()，并预留一个单元
+	left.reduce_by_number_of_states(span<natmax>(remainder));
+	// remainder = right.value() mod left.number_of_states()
+	numerical_cell limited_right(right.number_of_states(), span<natmax>(remainder.data(), remainder.size()), thread_local_pool());
 	// limited_right = numerical_cell(right.number_of_states(), remainder)
-	left *= limited_right;
+	left.multiply(limited_right, number_of_threads);
 	// 后置条件: left <- left * limited_right = left * right
 }
 
-// 在运行 *= 函数时，当处理中间数据时，应调用此函数进行进位的传播
+// 在运行 *= 函数时，应调用此函数计算两个值的完整乘积
 // 逻辑规范：
-// 前置条件 P: parts 为有效的数胞的局部 (not parts.empty()) 并且 parts 足够容纳进位的结果 ((parts + carry).size() <= parts.size())
-// 后置条件 Q: 设 B 为 max(nathalf) + 1
-//   parts <- parts + carry, carry <- 0
-static void propagate_carry_in_multiply(span<nathalf>&& parts, nathalf& carry) noexcept
+// 前置条件 P: left, right 皆非空，product.size() = left.size() + right.size()，且 product 与 left, right 皆不重叠
+// 后置条件 Q: product <- left * right
+static void multiply_value_by_value(span<natmax> product, const span<natmax> left, const span<natmax> right, sizevalue number_of_threads = 1) noexcept
 {
-	// 前置条件: not parts.empty()
-	if (carry == 0) {
+	// 前置条件: not left.empty() and not right.empty() and product.size() = left.size() + right.size()
+	runtime_assert(not left.empty() and not right.empty() and product.size() == left.size() + right.size(), "multiply_value_by_value 的前置条件不被满足");
+	// 两个乘数都足够大时，使用数论变换乘法
+	if (min(left.size(), right.size()) >= NUMBER_THEORETIC_TRANSFORM_THRESHOLD and product.size() <= NUMBER_THEORETIC_TRANSFORM_MAX_SIZE) {
+		multiply_by_number_theoretic_transform(product, left, right, number_of_threads);
 		return;
 	}
-	// 主循环：满足 carry = 1
+	multiply_by_schoolbook(product, left, right);
+	// 后置条件: product <- left * right
+}
+
+// 在运行 square, pow 函数时，应调用此函数计算值的平方
+// 逻辑规范：
+// 前置条件 P: value 非空，product.size() = 2 * value.size()，且 product 与 value 不重叠
+// 后置条件 Q: product <- value * value
+static void square_value(span<natmax> product, const span<natmax> value, sizevalue number_of_threads = 1) noexcept
+{
+	// 前置条件: not value.empty() and product.size() = 2 * value.size()
+	runtime_assert(not value.empty() and product.size() == 2 * value.size(), "square_value 的前置条件不被满足");
+	// 值足够大时，使用数论变换乘法 (两个乘数相同时只需做一次正变换)
+	if (value.size() >= NUMBER_THEORETIC_TRANSFORM_THRESHOLD and product.size() <= NUMBER_THEORETIC_TRANSFORM_MAX_SIZE) {
+		multiply_by_number_theoretic_transform(product, value, value, number_of_threads);
+		return;
+	}
+	memset(product.data(), 0, product.size() * sizeof(natmax));
+	// 设 B 为 max(natmax) + 1，value^2 = 2 * ∑_{i<j}(value[i] * value[j] * B^{i+j}) + ∑_i(value[i]^2 * B^{2i})
+	// 交叉项只计算一次，约为一般乘法的一半
 	// 循环不变式：
-	//   ∑_{k=0}^{i-1}(parts[k] * B^k) = ∑_{k=0}^{i-1}(parts_{old}[k] * B^k) + carry_{old} - carry_{current} * B^i
-	for (sizevalue i = 0; i < parts.size(); ++i) {
-		nathalf buffer = parts[i];
-		parts[i] += carry;
-		if (parts[i] >= buffer) {
-			carry = 0;
-			break;
-		}
-		else {
-			carry = 1;
+	//   product = ∑_{m=0}^{i-1}∑_{j=m+1}^{size-1}(value[m] * value[j] * B^{m+j})
+	for (sizevalue i = 0; i < value.size(); ++i) {
+		natmax carry = 0;
+		for (sizevalue j = i + 1; j < value.size(); ++j) {
+			product[i + j] = multiply_add(value[i], value[j], product[i + j], carry);
 		}
-	}
-	// 后置条件: parts <- parts + carry, carry <- 0
+		product[i + value.size()] = carry;
+	}
+	// 交叉项之和小于 B^{2 * size} / 2，乘2时不会溢出
+	shift_left_in_place(product, 1);
+	// 加上对角项
+	nat8 carry = 0;
+	for (sizevalue i = 0; i < value.size(); ++i) {
+		natmax high = 0;
+		natmax low = multiply_with_high(value[i], value[i], high);
+		product[2 * i] = add_with_carry(product[2 * i], low, carry);
+		product[2 * i + 1] = add_with_carry(product[2 * i + 1], high, carry);
+	}
+	// 后置条件: product <- value * value
+}
+
+// 逻辑规范：
+// 前置条件 P: *this 有效 (not this->content.empty())
+// 后置条件 Q: *this <- *this * *this
+void numerical_cell::square(sizevalue number_of_threads) noexcept
+{
+	// 前置条件: not this->content.empty()
+	runtime_assert(not this->content.empty(), "数胞的square函数的前置条件不被满足");
+	COUNT_CELL_OPERATION(SQUARE, this->number_of_states().size());
+	span<natmax> current_value = this->significant_value();
+	sizevalue n = this->number_of_states().size();
+	sizevalue length = current_value.size() * 2;
+	// 平方与取模共用一块临时空间：前 length + 1 个单元存放平方 (多预留一个单元供取模时使用)，其余供取模使用
+	sizevalue length_of_scratch = max(length + 1, n);
+	scratch_vector workspace = make_scratch_vector(length + 1 + length_of_scratch);
+	span<natmax> product(workspace.data(), length + 1);
+	span<natmax> scratch(workspace.data() + length + 1, length_of_scratch);
+	square_value(product.first(length), current_value, number_of_threads);
+	reduce_by_number_of_states(product, scratch);
+	// 此时 product 小于状态数，有效单元不超过 n 个
+	sizevalue length_of_result = min(product.size(), n);
+	memset(current_value.data(), 0, current_value.size() * sizeof(natmax));
+	memcpy(this->value().data(), product.data(), length_of_result * sizeof(natmax));
+	refresh_length_of_value(length_of_result);
+	// 后置条件: *this <- *this * *this
 }
 
 // 逻辑规范：
 // 前置条件 P: *this, right 皆有效 (not this->content.empty() and not right.content.empty())
 // 后置条件 Q: *this <- *this * right
 void numerical_cell::operator*=(const numerical_cell& right) noexcept
+{
+	multiply(right);
+}
+
+// 逻辑规范：
+// 前置条件 P: *this, right 皆有效 (not this->content.empty() and not right.content.empty())，number_of_threads >= 1
+// 后置条件 Q: *this <- *this * right
+void numerical_cell::multiply(const numerical_cell& right, sizevalue number_of_threads) noexcept
 {
 	// 前置条件: not this->content.empty() and not right.content.empty()
-	runtime_assert(not this->content.empty() and not right.content.empty(), "数胞的*=函数的前置条件不被满足");
-	span<natmax> current_value = this->value();
+	runtime_assert(not this->content.empty() and not right.content.empty(), "数胞的multiply函数的前置条件不被满足");
+	span<natmax> current_value = this->significant_value();
 	span<natmax> current_number_of_states = this->number_of_states();
-	span<natmax> right_value = right.value();
-	right_value = right_value.subspan(0, find_if(right_value.rbegin(), --right_value.rend(), [](const natmax v) { return v != 0; }).base() - right_value.begin());
+	span<natmax> right_value = right.significant_value();
 	// 当 right 的值大于自身的状态数限制时，需要将 right 的值限制在自身的状态数中，才能正确相乘
 	if (is_less_or_equal(span<natmax>(current_number_of_states), span<natmax>(right_value))) {
-		limit_right_value_then_multiply(*this, right);
+		limit_right_value_then_multiply(*this, right, number_of_threads);
 		return;
 	}
+	COUNT_CELL_OPERATION(MULTIPLY, current_number_of_states.size());
 	// 如果 this->number_of_states() <= right_value，则 *this <- *this * right，返回
 
-	// 如果满足以下条件，则 current_value.front() * right_value.front() <= NATMAX_MAX
-	if (current_value.size() == 1 and right_value.size() == 1 and current_value.front() <= nat32_max and right_value.front() <= nat32_max) {
-		current_value.front() *= right_value.front();
+	// 如果两者都只有一个单元，则乘积至多两个单元，在栈上相乘并取模 (状态数只有一个单元时只需一次带倒数的除法)
+	if (current_value.size() == 1 and right_value.size() == 1) {
+		natmax high_of_product = 0;
+		natmax low_of_product = multiply_with_high(current_value.front(), right_value.front(), high_of_product);
+		// 多预留一个单元供取模时使用
+		natmax product[3] = { low_of_product, high_of_product, 0 };
+		sizevalue length = high_of_product == 0 ? 1 : 2;
 		// 如果相乘后自身的值大于等于自身的状态数限制，需要进行限制
-		if (is_greater_or_equal(span<natmax>(current_value), span<natmax>(current_number_of_states))) {
-			mod_value_by_value(current_value, current_number_of_states);
+		if (is_greater_or_equal(span<natmax>(product, length), span<natmax>(current_number_of_states))) {
+			natmax scratch[3] = {};
+			reduce_by_number_of_states(span<natmax>(product, length + 1), span<natmax>(scratch, max<sizevalue>(length + 1, current_number_of_states.size())));
+			length = product[1] == 0 ? 1 : 2;
+		}
+		// 此时乘积小于状态数，至多占用状态数的单元数
+		span<natmax> full_value = this->value();
+		full_value[0] = product[0];
+		if (length == 2) {
+			full_value[1] = product[1];
 		}
+		length_of_value = length;
 		return;
 	}
 	// 当满足以上条件时，则 *this <- *this * right，返回
 
-	span<nathalf> half_form_current_value((nathalf*)current_value.data(), current_value.size() * 2);
-	span<nathalf> half_form_right_value((nathalf*)right_value.data(), right_value.size() * 2);
-	half_form_current_value = half_form_current_value.subspan(0, find_if(half_form_current_value.rbegin(), --half_form_current_value.rend(), [](const nathalf v) { return v != 0; }).base() - half_form_current_value.begin());
-	half_form_right_value = half_form_right_value.subspan(0, find_if(half_form_right_value.rbegin(), --half_form_right_value.rend(), [](const nathalf v) { return v != 0; }).base() - half_form_right_value.begin());
-	// 在所代表的值上，满足 half_form_current_value = current_value, half_form_right_value = right_value
-	vector<nathalf> intermediate_data(half_form_current_value.size() + half_form_right_value.size() + 1, 0);
+	// 与自身相乘或者两值相同时，交叉项只需计算一次
+	if (&right == this or (current_value.size() == right_value.size() and memcmp(current_value.data(), right_value.data(), current_value.size() * sizeof(natmax)) == 0)) {
+		square(number_of_threads);
+		return;
+	}
+
+	// 多预留一个单元供取模时使用
+	scratch_vector intermediate_data = make_scratch_vector(current_value.size() + right_value.size() + 1);
+	multiply_value_by_value(span<natmax>(intermediate_data).first(current_value.size() + right_value.size()), current_value, right_value, number_of_threads);
+	// 两个有效值的乘积至多有 current_value.size() + right_value.size() 个单元，去除其中无用的高位0
+	span<natmax> final_intermediate_data(intermediate_data.data(), find_if(intermediate_data.rbegin(), --intermediate_data.rend(), [](const natmax v) { return v != 0; }).base() - intermediate_data.begin());
+	if (is_greater_or_equal(span<natmax>(final_intermediate_data), span<natmax>(current_number_of_states))) {
+		reduce_by_number_of_states(span<natmax>(intermediate_data));
+		final_intermediate_data = final_intermediate_data.subspan(0, find_if(final_intermediate_data.rbegin(), --final_intermediate_data.rend(), [](const natmax v) { return v != 0; }).base() - final_intermediate_data.begin());
+	}
+	// final_intermediate_data <- final_intermediate_data mod current_number_of_states，此时其单元数不超过状态数的单元数
+	memset(current_value.data(), 0, current_value.size() * sizeof(natmax));
+	memcpy(current_value.data(), final_intermediate_data.data(), final_intermediate_data.size() * sizeof(natmax));
+	length_of_value = final_intermediate_data.size();
+	// 后置条件: *this <- *this * right
+}
+
+// 逻辑规范：
+// 前置条件 P: *this, exponent 皆有效 (not this->content.empty() and not exponent.content.empty())
+// 后置条件 Q: *this <- *this ^ exponent (其中 0^0 视为 1)
+void numerical_cell::pow(const numerical_cell& exponent) noexcept
+{
+	// 前置条件: not this->content.empty() and not exponent.content.empty()
+	runtime_assert(not this->content.empty() and not exponent.content.empty(), "数胞的pow函数的前置条件不被满足");
+	COUNT_CELL_OPERATION(POW, this->number_of_states().size());
+	constexpr sizevalue BITS_OF_NATMAX = sizeof(natmax) * WORD_SIZE;
+	span<natmax> current_value = this->value();
+	span<natmax> exponent_value = exponent.significant_value();
+	sizevalue n = current_value.size();
+	sizevalue bit_length = (exponent_value.size() - 1) * BITS_OF_NATMAX + std::bit_width(exponent_value.back());
+	auto bit_of_exponent = [&](sizevalue i) -> natmax { return (exponent_value[i / BITS_OF_NATMAX] >> (i % BITS_OF_NATMAX)) & 1; };
+	// 窗口宽度随指数的位数增长，使预计算的乘法次数与窗口节省的乘法次数相平衡
+	sizevalue width = bit_length <= 8 ? 1 : bit_length <= 64 ? 3 : bit_length <= 256 ? 4 : bit_length <= 1024 ? 5 : 6;
+
+	// 所有临时空间在此一次性分配，之后的每一次平方和乘法都不再分配内存
+	// odd_powers 依次存放 x^1, x^3, ..., x^{2^width - 1} (x 为当前的值)，每项占 n 个单元
+	scratch_vector odd_powers = make_scratch_vector((static_cast<sizevalue>(1) << (width - 1)) * n);
+	scratch_vector accumulator = make_scratch_vector(n);
+	// 乘积至多 2n 个单元，多预留一个单元供取模时使用
+	scratch_vector product = make_scratch_vector(n * 2 + 1);
+	scratch_vector scratch = make_scratch_vector(n * 2 + 1);
+	auto odd_power = [&](sizevalue index) { return span<natmax>(odd_powers.data() + index * n, n); };
+	// 逻辑规范：
+	// 前置条件 P: target, left, right 皆为 n 个单元且小于状态数
+	// 后置条件 Q: target <- left * right mod number_of_states() (target 可以与 left 或 right 相同)
+	auto multiply_then_reduce = [&](span<natmax> target, span<natmax> left, span<natmax> right) {
+		span<natmax> significant_left = left.first(length_without_high_zeros(left));
+		span<natmax> significant_right = right.first(length_without_high_zeros(right));
+		sizevalue length = significant_left.size() + significant_right.size();
+		if (significant_left.data() == significant_right.data()) {
+			square_value(span<natmax>(product).first(length), significant_left);
+		}
+		else {
+			multiply_value_by_value(span<natmax>(product).first(length), significant_left, significant_right);
+		}
+		memset(product.data() + length, 0, (product.size() - length) * sizeof(natmax));
+		reduce_by_number_of_states(span<natmax>(product), span<natmax>(scratch));
+		memcpy(target.data(), product.data(), n * sizeof(natmax));
+	};
+
+	memcpy(odd_power(0).data(), current_value.data(), n * sizeof(natmax));
+	if (width > 1) {
+		// 暂时借用 accumulator 存放 x^2
+		multiply_then_reduce(span<natmax>(accumulator), odd_power(0), odd_power(0));
+		for (sizevalue i = 1; i < (static_cast<sizevalue>(1) << (width - 1)); ++i) {
+			multiply_then_reduce(odd_power(i), odd_power(i - 1), span<natmax>(accumulator));
+		}
+	}
 
-	nathalf carry = 0; // 进位
-	// 外层循环，结束时代表 right 的每一位都已与自身的每一位相乘
+	// 主循环：从高位向低位扫描指数，每个窗口的最低位为1，窗口之间的0逐位平方
 	// 循环不变式：
-	//   设 B = NAT32_MAX + 1, 当 n >= half_form_current_value.size() 时 half_form_current_value[n] = 0, 当 m >= half_form_right_value.size() 时 half_form_right_value[m] = 0
-	//   intermediate_data = ∑_{m=0}^{i-1}(∑_{n=0}^{half_form_current_value.size()-1}(half_form_right_value[m] * half_form_current_value[n] * B^n) * B^m)
-	for (sizevalue i = 0; i < half_form_right_value.size(); ++i) {
-		nathalf right_digital = half_form_right_value[i]; // half_form_right_value 的第i位，将与自身的每一位进行一次乘法
-		// 内层循环，结束时代表 right 的第i位都已与自身的每一位相乘
-		// 循环不变式：
-		//   设 B = NAT32_MAX + 1, last_intermediate_data 为循环开始前的 intermediate_data, 当 k >= half_form_current_value.size() 时 half_form_current_value[k] = 0
-		//   intermediate_data = last_intermediate_data + (∑_{k=0}^{j-1}(right_digital * half_form_current_value[k] * B^k) - carry * B^{j-1}) * B^i
-		for (sizevalue j = 0; j < half_form_current_value.size(); ++j) {
-			natmax left_digital = half_form_current_value[j];
-			left_digital *= right_digital;
-			// left_digital = half_form_current_value[j] * half_form_right_value[i]
-			nathalf last_carry = carry;
-			carry = left_digital >> (sizeof(nathalf) * WORD_SIZE); // 取相乘结果的高半部分作为下次乘法的进位
-			nathalf low_half_of_left_ditital = (nathalf)left_digital; // 低半部分
-			// 此时设 intermediate_data_old <- intermediate_data
-			nathalf anchor_value = intermediate_data[i + j];
-			intermediate_data[i + j] += (nathalf)low_half_of_left_ditital;
-			sizevalue k = 0;
-			while (intermediate_data[i + j + k] < anchor_value) {
-				anchor_value = intermediate_data[i + j + k + 1];
-				intermediate_data[i + j + k + 1] += 1;
-				k += 1;
-			}
-			// intermediate_data[i + j] = (low_half_of_left_ditital + last_carry) mod (NAT32_MAX + 1)
-			propagate_carry_in_multiply(span<nathalf>(intermediate_data.data() + i + j, intermediate_data.size() - (i + j) - 1), last_carry);
-			// intermediate_data = intermediate_data_old + last_carry * (NAT32_MAX + 1)^(i + j)
-			// 如果相乘结果加上进位导致再次进位，修正进位(+1)
-			if (low_half_of_left_ditital + last_carry < low_half_of_left_ditital) {
-				++carry;
+	//   accumulator = x^{exponent 整除 2^i} mod number_of_states() (started 为真时)
+	bool started = false;
+	sizevalue i = bit_length;
+	while (i > 0) {
+		if (bit_of_exponent(i - 1) == 0) {
+			multiply_then_reduce(span<natmax>(accumulator), span<natmax>(accumulator), span<natmax>(accumulator));
+			--i;
+			continue;
+		}
+		sizevalue low = i > width ? i - width : 0;
+		while (bit_of_exponent(low) == 0) {
+			++low;
+		}
+		// 窗口为 exponent 的第 low 位到第 i - 1 位
+		natmax window = 0;
+		for (sizevalue j = i; j > low; --j) {
+			window = (window << 1) | bit_of_exponent(j - 1);
+			if (started) {
+				multiply_then_reduce(span<natmax>(accumulator), span<natmax>(accumulator), span<natmax>(accumulator));
 			}
-			// carry = (half_form_current_value[j] * half_form_right_value[i]) 整除 (NAT32_MAX + 1) + (low_half_of_left_ditital + last_carry) mod (NAT32_MAX + 1)
 		}
-
-		if (carry > 0) {
-			// 如果最后一次乘法依然产生进位，将其附加在专门为进位预留的最后一位上
-			propagate_carry_in_multiply(span<nathalf>(intermediate_data.data() + i + half_form_current_value.size(), 1), carry);
+		if (started) {
+			multiply_then_reduce(span<natmax>(accumulator), span<natmax>(accumulator), odd_power(window / 2));
 		}
-		// intermediate_data = ∑_{m=0}^{i-1}(∑_{n=0}^{j-1}(right_digital * half_form_current_value[n] * B^n) * B^m)
-	}
+		else {
+			memcpy(accumulator.data(), odd_power(window / 2).data(), n * sizeof(natmax));
+			started = true;
+		}
+		i = low;
+	}
+	if (not started) {
+		// 指数为0，结果为 1 mod number_of_states()
+		accumulator.front() = 1;
+	}
+	memset(product.data(), 0, product.size() * sizeof(natmax));
+	memcpy(product.data(), accumulator.data(), n * sizeof(natmax));
+	reduce_by_number_of_states(span<natmax>(product), span<natmax>(scratch));
+	memcpy(current_value.data(), product.data(), n * sizeof(natmax));
+	refresh_length_of_value(n);
+	// 后置条件: *this <- *this ^ exponent
+}
 
-	sizevalue new_size = find_if(intermediate_data.rbegin(), intermediate_data.rend(), [](const nathalf v) { return v != 0; }).base() - intermediate_data.begin();
-	if (new_size == 0) {
-		new_size = 1;
-	}
-	intermediate_data.resize(new_size % 2 == 0 ? new_size : new_size + 1);
-	// intermediate_data.size() mod 2 = 0
-	span<natmax> final_intermediate_data((natmax*)intermediate_data.data(), intermediate_data.size() / 2);
-	// 在数值上，final_intermediate_data = intermediate_data
-	if (is_greater_or_equal(span<natmax>(final_intermediate_data).subspan(0, find_if(final_intermediate_data.rbegin(), --final_intermediate_data.rend(), [](const natmax v) { return v != 0; }).base() - final_intermediate_data.begin()), span<natmax>(current_number_of_states))) {
-		mod_value_by_value(final_intermediate_data, current_number_of_states);
-	}
-	// final_intermediate_data <- final_intermediate_data mod current_number_of_states
-	memset(current_value.data(), 0, current_value.size());
-	memcpy(current_value.data(), final_intermediate_data.data(), final_intermediate_data.size() * sizeof(natmax));
-	// 后置条件: *this <- *this * right
+// 逻辑规范：
+// 前置条件 P: base, exponent, modulus 皆有效，且 modulus 的值不为0
+// 后置条件 Q: 返回状态数为 modulus 的值，值为 base 的值 ^ exponent 的值 mod modulus 的值的数胞
+numerical_cell pow_mod(const numerical_cell& base, const numerical_cell& exponent, const numerical_cell& modulus)
+{
+	// 前置条件: not base.empty() and not exponent.empty() and not modulus.empty() and modulus 的值不为0
+	span<natmax> modulus_value = modulus.significant_value();
+	runtime_assert(not base.empty() and not exponent.empty() and not modulus.empty() and modulus_value.back() != 0, "pow_mod 的前置条件不被满足");
+	numerical_cell result(vector<natmax>(modulus_value.begin(), modulus_value.end()), base.resource());
+	// 赋值时 base 的值会被限制在 modulus 的值中
+	result = base.significant_value();
+	result.pow(exponent);
+	return result;
+	// 后置条件: 返回 base ^ exponent mod modulus
+}
+
+byte_array numerical_cell::to_string(sizevalue base) const
+{
+	// 前置条件: not this->content.empty() and 2 <= base <= 36
+	runtime_assert(not this->content.empty() and 2 <= base and base <= 36, "数胞的to_string函数的前置条件不被满足");
+	return convert_value_to_string(significant_value(), base);
+}
+
+void numerical_cell::from_string(std::string_view text, sizevalue base)
+{
+	// 前置条件: not this->content.empty() and 2 <= base <= 36
+	runtime_assert(not this->content.empty() and 2 <= base and base <= 36, "数胞的from_string函数的前置条件不被满足");
+	scratch_vector parsed = convert_string_to_value(text, base);
+	*this = span<natmax>(parsed);
 }
 
 // 逻辑规范：
@@ -988,53 +995,81 @@ void numerical_cell::operator/=(const numerical_cell& right)
 	// 前置条件: not this->content.empty() and not right.content.empty()
 	runtime_assert(not this->content.empty() and not right.content.empty(), "数胞的/=函数的前置条件不被满足");
 
-	span<natmax> current_value = this->value();
-	span<natmax> right_value = right.value();
-	current_value = current_value.subspan(0, find_if(current_value.rbegin(), --current_value.rend(), [](const natmax v) { return v != 0; }).base() - current_value.begin());
-	right_value = right_value.subspan(0, find_if(right_value.rbegin(), --right_value.rend(), [](const natmax v) { return v != 0; }).base() - right_value.begin());
+	span<natmax> current_value = this->significant_value();
+	span<natmax> right_value = right.significant_value();
+	runtime_assert(right_value.back() != 0, "在数胞的/=函数中发现除数为0");
+	COUNT_CELL_OPERATION(DIVIDE, this->number_of_states().size());
 
-	// 如果满足以下条件，可以直接进行单次相除得到结果
-	if (current_value.size() == 1 and right_value.size() == 1) {
-		current_value.front() /= right_value.front();
+	// 除数只有一个单元时，用其倒数逐单元相除，只遍历一次被除数 (商直接写回自身的值)
+	if (right_value.size() == 1) {
+		natmax divisor = right_value.front();
+		divide_by_limb(current_value, divisor, reciprocal_of_limb(divisor << std::countl_zero(divisor)), current_value);
+		refresh_length_of_value(current_value.size());
 		return;
 	}
 	// 如果被除数小于除数，则结果一定为 0
 	if (is_less(span<natmax>(current_value), span<natmax>(right_value))) {
 		memset(current_value.data(), 0, current_value.size() * sizeof(natmax));
+		length_of_value = 1;
 		return;
 	}
-	// 满足 current_value >= right_value
-	vector<natmax> result = div_value_by_value(current_value, right_value);
-	memset(current_value.data(), 0, current_value.size() * sizeof(natmax));
-	memcpy(current_value.data(), result.data(), result.size() * sizeof(natmax));
+	// 满足 current_value >= right_value，以单元为基数做长除法；divide_in_place 会改变被除数与除数，因此都使用副本
+	scratch_vector dividend = make_scratch_vector(current_value.size() + 1);
+	memcpy(dividend.data(), current_value.data(), current_value.size() * sizeof(natmax));
+	scratch_vector divisor(right_value.begin(), right_value.end(), thread_local_pool());
+	divide_in_place(span<natmax>(dividend), span<natmax>(divisor), current_value.first(dividend.size() - divisor.size()));
+	memset(current_value.data() + (dividend.size() - divisor.size()), 0, (current_value.size() - (dividend.size() - divisor.size())) * sizeof(natmax));
+	refresh_length_of_value(dividend.size() - divisor.size());
 	// 后置条件: *this <- *this / right
 }
 
 // 逻辑规范：
 // 前置条件 P: *this, right 皆有效 (not this->content.empty() and not right.content.empty())，且 right 的值不为 0
-// 后置条件 Q: *this <- *this / right
+// 后置条件 Q: *this <- *this mod right
 void numerical_cell::operator%=(const numerical_cell& right)
 {
 	// 前置条件: not this->content.empty() and not right.content.empty()
 	runtime_assert(not this->content.empty() and not right.content.empty(), "数胞的%=函数的前置条件不被满足");
 
-	span<natmax> current_value = this->value();
-	span<natmax> right_value = right.value();
-	current_value = current_value.subspan(0, find_if(current_value.rbegin(), --current_value.rend(), [](const natmax v) { return v != 0; }).base() - current_value.begin());
-	right_value = right_value.subspan(0, find_if(right_value.rbegin(), --right_value.rend(), [](const natmax v) { return v != 0; }).base() - right_value.begin());
+	span<natmax> current_value = this->significant_value();
+	span<natmax> right_value = right.significant_value();
+	runtime_assert(right_value.back() != 0, "在数胞的%=函数中发现除数为0");
+	COUNT_CELL_OPERATION(MODULO, this->number_of_states().size());
 
-	// 如果满足以下条件，可以直接进行单次相除得到结果
-	if (current_value.size() == 1 and right_value.size() == 1) {
-		current_value.front() %= right_value.front();
+	// 除数只有一个单元时，用其倒数逐单元求余数，只遍历一次被除数
+	if (right_value.size() == 1) {
+		natmax divisor = right_value.front();
+		natmax remainder = divide_by_limb(current_value, divisor, reciprocal_of_limb(divisor << std::countl_zero(divisor)), span<natmax>{});
+		memset(current_value.data(), 0, current_value.size() * sizeof(natmax));
+		current_value.front() = remainder;
+		length_of_value = 1;
 		return;
 	}
 	// 如果被除数小于除数，则结果为被除数
 	if (is_less(span<natmax>(current_value), span<natmax>(right_value))) {
 		return;
 	}
-	// 满足 current_value >= right_value
-	mod_value_by_value(current_value, right_value);
-	// 后置条件: *this <- *this / right
+	// 满足 current_value >= right_value，以单元为基数做长除法，余数位于被除数的低位
+	scratch_vector dividend = make_scratch_vector(current_value.size() + 1);
+	memcpy(dividend.data(), current_value.data(), current_value.size() * sizeof(natmax));
+	scratch_vector divisor(right_value.begin(), right_value.end(), thread_local_pool());
+	divide_in_place(span<natmax>(dividend), span<natmax>(divisor), span<natmax>{});
+	memcpy(current_value.data(), dividend.data(), current_value.size() * sizeof(natmax));
+	refresh_length_of_value(right_value.size());
+	// 后置条件: *this <- *this mod right
+}
+
+// 逻辑规范：
+// 前置条件 P: 无
+// 后置条件 Q: left, right 皆有效、状态数相同 (divisor 为 true 时还要求 right 的值不为 0) 时直接返回，否则抛出 runtime_error；
+//   状态数先比较长度再逐单元比较，错误信息只在条件不成立时才构造
+static void assert_binary_operands(const numerical_cell& left, const numerical_cell& right, bool divisor, const char* name)
+{
+	if (not left.empty() and not right.empty() and is_equal(left.number_of_states(), right.number_of_states())
+		and (not divisor or right.significant_value().size() > 1 or right.significant_value()[0] != 0)) {
+		return;
+	}
+	runtime_assert(false, byte_array("数胞的") + name + "函数的前置条件不被满足，自身的状态数为" + generate_information_of_linear_table(left.number_of_states()) + "，自身的值为" + generate_information_of_linear_table(left.value()) + "，操作数的值为" + generate_information_of_linear_table(right.value()));
 }
 
 // 逻辑规范：
@@ -1042,7 +1077,7 @@ void numerical_cell::operator%=(const numerical_cell& right)
 // 后置条件 Q: 输出 *this + right
 numerical_cell numerical_cell::operator+(const numerical_cell& right) const noexcept
 {
-	runtime_assert(not this->content.empty() and not right.content.empty() and is_equal(this->number_of_states(), right.number_of_states()), "数胞的+函数的前置条件不被满足，自身的状态数为" + generate_information_of_linear_table(number_of_states()) + "，自身的值为" + generate_information_of_linear_table(this->value()) + "，操作数的值为" + generate_information_of_linear_table(right.value()));
+	assert_binary_operands(*this, right, false, "+");
 	numerical_cell result = *this;
 	result += right;
 	return std::move(result);
@@ -1053,7 +1088,7 @@ numerical_cell numerical_cell::operator+(const numerical_cell& right) const noex
 // 后置条件 Q: 输出 *this - right
 numerical_cell numerical_cell::operator-(const numerical_cell& right) const noexcept
 {
-	runtime_assert(not this->content.empty() and not right.content.empty() and is_equal(this->number_of_states(), right.number_of_states()), "数胞的-函数的前置条件不被满足，自身的状态数为" + generate_information_of_linear_table(number_of_states()) + "，自身的值为" + generate_information_of_linear_table(this->value()) + "，操作数的值为" + generate_information_of_linear_table(right.value()));
+	assert_binary_operands(*this, right, false, "-");
 	numerical_cell result = *this;
 	result -= right;
 	return std::move(result);
@@ -1064,7 +1099,7 @@ numerical_cell numerical_cell::operator-(const numerical_cell& right) const noex
 // 后置条件 Q: 输出 *this * right
 numerical_cell numerical_cell::operator*(const numerical_cell& right) const noexcept
 {
-	runtime_assert(not this->content.empty() and not right.content.empty() and is_equal(this->number_of_states(), right.number_of_states()), "数胞的*函数的前置条件不被满足，自身的状态数为" + generate_information_of_linear_table(number_of_states()) + "，自身的值为" + generate_information_of_linear_table(this->value()) + "，操作数的值为" + generate_information_of_linear_table(right.value()));
+	assert_binary_operands(*this, right, false, "*");
 	numerical_cell result = *this;
 	result *= right;
 	return std::move(result);
@@ -1075,8 +1110,7 @@ numerical_cell numerical_cell::operator*(const numerical_cell& right) const noex
 // 后置条件 Q: 输出 *this / right
 numerical_cell numerical_cell::operator/(const numerical_cell& right) const
 {
-	span<natmax> right_value = right.value();
-	runtime_assert(not this->content.empty() and not right.content.empty() and is_equal(this->number_of_states(), right.number_of_states()) and not all_of(right_value.begin(), right_value.end(), [](natmax v) { return v == 0; }), "数胞的/函数的前置条件不被满足，自身的状态数为" + generate_information_of_linear_table(number_of_states()) + "，自身的值为" + generate_information_of_linear_table(this->value()) + "，操作数的值为" + generate_information_of_linear_table(right.value()));
+	assert_binary_operands(*this, right, true, "/");
 	numerical_cell result = *this;
 	result /= right;
 	return std::move(result);
@@ -1087,8 +1121,7 @@ numerical_cell numerical_cell::operator/(const numerical_cell& right) const
 // 后置条件 Q: 输出 *this % right
 numerical_cell numerical_cell::operator%(const numerical_cell& right) const
 {
-	span<natmax> right_value = right.value();
-	runtime_assert(not this->content.empty() and not right.content.empty() and is_equal(this->number_of_states(), right.number_of_states()) and not all_of(right_value.begin(), right_value.end(), [](natmax v) { return v == 0; }), "数胞的%函数的前置条件不被满足，自身的状态数为" + generate_information_of_linear_table(number_of_states()) + "，自身的值为" + generate_information_of_linear_table(this->value()) + "，操作数的值为" + generate_information_of_linear_table(right.value()));
+	assert_binary_operands(*this, right, true, "%");
 	numerical_cell result = *this;
 	result %= right;
 	return std::move(result);
@@ -1099,11 +1132,10 @@ numerical_cell numerical_cell::operator%(const numerical_cell& right) const
 // 后置条件 Q: 输出 *this == right
 bool numerical_cell::operator==(const numerical_cell& right) const noexcept
 {
-	span<natmax> current_value = this->value();
-	span<natmax> right_value = right.value();
+	span<natmax> current_value = this->significant_value();
+	span<natmax> right_value = right.significant_value();
 	runtime_assert(not current_value.empty() and not right_value.empty(), "数胞的==函数的前置条件不被满足");
-	current_value = current_value.subspan(0, find_if(current_value.rbegin(), --current_value.rend(), [](const natmax v) { return v != 0; }).base() - current_value.begin());
-	right_value = right_value.subspan(0, find_if(right_value.rbegin(), --right_value.rend(), [](const natmax v) { return v != 0; }).base() - right_value.begin());
+	COUNT_CELL_OPERATION(COMPARE, this->number_of_states().size());
 	sizevalue min_size = min(current_value.size(), right_value.size());
 	if (current_value.size() != right_value.size()) {
 		return false;
@@ -1121,11 +1153,10 @@ bool numerical_cell::operator==(const numerical_cell& right) const noexcept
 // 后置条件 Q: 输出 *this <=> right
 weak_ordering numerical_cell::operator<=>(const numerical_cell& right) const noexcept
 {
-	span<natmax> current_value = this->value();
-	span<natmax> right_value = right.value();
+	span<natmax> current_value = this->significant_value();
+	span<natmax> right_value = right.significant_value();
 	runtime_assert(not current_value.empty() and not right_value.empty(), "数胞的<=>函数的前置条件不被满足");
-	current_value = current_value.subspan(0, find_if(current_value.rbegin(), --current_value.rend(), [](const natmax v) { return v != 0; }).base() - current_value.begin());
-	right_value = right_value.subspan(0, find_if(right_value.rbegin(), --right_value.rend(), [](const natmax v) { return v != 0; }).base() - right_value.begin());
+	COUNT_CELL_OPERATION(COMPARE, this->number_of_states().size());
 	sizevalue min_size = min(current_value.size(), right_value.size());
 	if (current_value.size() < right_value.size()) {
 		return weak_ordering::less;
@@ -0,0 +1,463 @@
+#include <radix-conversion>
+#include <limb-arithmetic>
+#include <runtime-exception>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <array>
+#include <bit>
+
+using std::vector;
+using std::span;
+using std::string_view;
+using std::invalid_argument;
+using std::min;
+
+static constexpr char DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+// 字符对应的数字，不是数字的字符对应 36 (不小于任何合法的进制)
+static constexpr auto DIGIT_OF_CHARACTER = [] {
+	std::array<nat8, 256> table{};
+	table.fill(36);
+	for (nat8 i = 0; i < 10; ++i) {
+		table['0' + i] = i;
+	}
+	for (nat8 i = 0; i < 26; ++i) {
+		table['a' + i] = 10 + i;
+		table['A' + i] = 10 + i;
+	}
+	return table;
+}();
+
+// 一个单元能容纳的最大整块：power = base^digits <= max(natmax) < base^{digits + 1}
+struct radix_chunk
+{
+	natmax power = 1;
+	sizevalue digits = 0;
+	natmax reciprocal = 0; // 规范化后的 power 的倒数，逐块转换时每个单元只需乘法而不需要除法
+};
+
+static radix_chunk chunk_of(sizevalue base) noexcept
+{
+	radix_chunk chunk;
+	while (chunk.power <= natmax_max / base) {
+		chunk.power *= base;
+		++chunk.digits;
+	}
+	chunk.reciprocal = reciprocal_of_limb(chunk.power << std::countl_zero(chunk.power));
+	return chunk;
+}
+
+// 幂表中的一项：power = chunk.power^{2^i}，reciprocal = floor(B^{2n} / power) (n 为 power 的单元数)，只在用到时求出
+struct radix_power
+{
+	scratch_vector power;
+	scratch_vector reciprocal;
+};
+
+static sizevalue significant_length(const span<natmax> parts) noexcept
+{
+	sizevalue length = parts.size();
+	while (length > 0 and parts[length - 1] == 0) {
+		--length;
+	}
+	return length;
+}
+
+// 逻辑规范：
+// 前置条件 P: 无 (两者皆可以含有高位0)
+// 后置条件 Q: 返回 left < right
+static bool is_less_than(const span<natmax> left, const span<natmax> right) noexcept
+{
+	sizevalue left_length = significant_length(left);
+	sizevalue right_length = significant_length(right);
+	if (left_length != right_length) {
+		return left_length < right_length;
+	}
+	for (sizevalue i = left_length - 1; i < left_length; --i) {
+		if (left[i] != right[i]) {
+			return left[i] < right[i];
+		}
+	}
+	return false;
+}
+
+// 逻辑规范：
+// 前置条件 P: addend 的有效单元数不超过 target.size()，且 target + addend < B^{target.size()}
+// 后置条件 Q: target <- target + addend
+static void add_parts(span<natmax> target, const span<natmax> addend) noexcept
+{
+	sizevalue length = significant_length(addend);
+	nat8 carry = 0;
+	for (sizevalue i = 0; i < length; ++i) {
+		target[i] = add_with_carry(target[i], addend[i], carry);
+	}
+	for (sizevalue i = length; carry == 1 and i < target.size(); ++i) {
+		target[i] = add_with_carry(target[i], 0, carry);
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: subtrahend 的有效单元数不超过 target.size()，且 subtrahend <= target
+// 后置条件 Q: target <- target - subtrahend
+static void subtract_parts(span<natmax> target, const span<natmax> subtrahend) noexcept
+{
+	sizevalue length = significant_length(subtrahend);
+	nat8 borrow = 0;
+	for (sizevalue i = 0; i < length; ++i) {
+		target[i] = subtract_with_borrow(target[i], subtrahend[i], borrow);
+	}
+	for (sizevalue i = length; borrow == 1 and i < target.size(); ++i) {
+		target[i] = subtract_with_borrow(target[i], 0, borrow);
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: left, right 皆非空，product.size() = left.size() + right.size()，且 product 与 left, right 皆不重叠
+// 后置条件 Q: product <- left * right
+static void multiply_parts(span<natmax> product, const span<natmax> left, const span<natmax> right) noexcept
+{
+	if (min(left.size(), right.size()) >= NUMBER_THEORETIC_TRANSFORM_THRESHOLD and product.size() <= NUMBER_THEORETIC_TRANSFORM_MAX_SIZE) {
+		multiply_by_number_theoretic_transform(product, left, right);
+		return;
+	}
+	multiply_by_schoolbook(product, left, right);
+}
+
+// 逻辑规范：
+// 前置条件 P: 无
+// 后置条件 Q: powers.size() > level，powers[i].power = chunk.power^{2^i}
+static void extend_powers(vector<radix_power>& powers, const radix_chunk& chunk, sizevalue level)
+{
+	if (powers.empty()) {
+		powers.push_back(radix_power{ scratch_vector(1, chunk.power, thread_local_pool()), make_scratch_vector(0) });
+	}
+	while (powers.size() <= level) {
+		span<natmax> last(powers.back().power);
+		scratch_vector square = make_scratch_vector(last.size() * 2);
+		multiply_parts(span<natmax>(square), last, last);
+		square.resize(significant_length(span<natmax>(square)));
+		powers.push_back(radix_power{ std::move(square), make_scratch_vector(0) });
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: divisor 非空且 divisor.back() != 0，设 n = divisor.size()，result.size() = n + 2
+// 后置条件 Q: result <- floor(B^{2n} / divisor)
+static void compute_reciprocal(span<natmax> result, const span<natmax> divisor)
+{
+	sizevalue n = divisor.size();
+	if (n < NUMBER_THEORETIC_TRANSFORM_THRESHOLD) {
+		// 乘法没有变快时，牛顿迭代并不比长除法快
+		scratch_vector dividend = make_scratch_vector(2 * n + 2);
+		dividend[2 * n] = 1;
+		scratch_vector normalized_divisor(divisor.begin(), divisor.end(), thread_local_pool());
+		divide_in_place(span<natmax>(dividend), span<natmax>(normalized_divisor), result);
+		return;
+	}
+	// 以高 h 个单元 (记为 D_h) 的倒数 X_h = floor(B^{2h} / D_h) 作为初始近似 X_0 = X_h * B^{n-h}，其相对误差约为 B^{1-h}
+	// 一次牛顿迭代 X_1 = X_0 + X_0 * (B^{2n} - divisor * X_0) / B^{2n} 后相对误差约为 B^{2-2h}，取 h = n/2 + 2 时绝对误差只有几个单位
+	sizevalue h = n / 2 + 2;
+	sizevalue shift = n - h;
+	scratch_vector approximation = make_scratch_vector(h + 2);
+	compute_reciprocal(span<natmax>(approximation), divisor.subspan(shift));
+	// 以 B^{n-h} 为单位：B^{2n} - divisor * X_0 = (B^{n+h} - divisor * X_h) * B^{n-h}
+	scratch_vector product = make_scratch_vector(n + h + 2);
+	multiply_parts(span<natmax>(product), divisor, span<natmax>(approximation));
+	scratch_vector error = make_scratch_vector(n + h + 2);
+	error[n + h] = 1;
+	bool overestimated = is_less_than(span<natmax>(error), span<natmax>(product));
+	if (overestimated) {
+		subtract_parts(span<natmax>(product), span<natmax>(error));
+		error.swap(product);
+	}
+	else {
+		subtract_parts(span<natmax>(error), span<natmax>(product));
+	}
+	// 修正量 = X_0 * |error| * B^{n-h} / B^{2n} = X_h * |error| / B^{2h}
+	std::fill(result.begin(), result.end(), 0);
+	std::copy(approximation.begin(), approximation.end(), result.begin() + shift);
+	sizevalue length_of_error = significant_length(span<natmax>(error));
+	if (length_of_error > 0) {
+		scratch_vector correction = make_scratch_vector(h + 2 + length_of_error);
+		multiply_parts(span<natmax>(correction), span<natmax>(approximation), span<natmax>(error).first(length_of_error));
+		if (correction.size() > 2 * h) {
+			span<natmax> shifted_correction = span<natmax>(correction).subspan(2 * h);
+			if (overestimated) {
+				subtract_parts(result, shifted_correction);
+			}
+			else {
+				add_parts(result, shifted_correction);
+			}
+		}
+	}
+	// 修正到精确值：余数 B^{2n} - divisor * result 应满足 0 <= 余数 < divisor
+	scratch_vector check = make_scratch_vector(2 * n + 2);
+	multiply_parts(span<natmax>(check), divisor, result);
+	scratch_vector remainder = make_scratch_vector(2 * n + 2);
+	remainder[2 * n] = 1;
+	natmax one[1] = { 1 };
+	while (is_less_than(span<natmax>(remainder), span<natmax>(check))) {
+		subtract_parts(result, span<natmax>(one));
+		subtract_parts(span<natmax>(check), divisor);
+	}
+	subtract_parts(span<natmax>(remainder), span<natmax>(check));
+	while (not is_less_than(span<natmax>(remainder), divisor)) {
+		add_parts(result, span<natmax>(one));
+		subtract_parts(span<natmax>(remainder), divisor);
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: 设 m = power.power.size()，dividend < power.power^2
+// 后置条件 Q: quotient <- dividend 整除 power.power，remainder <- dividend mod power.power (两者的单元数皆为 m)
+static void divide_by_power(scratch_vector& quotient, scratch_vector& remainder, const span<natmax> dividend, radix_power& power)
+{
+	span<natmax> divisor(power.power);
+	sizevalue m = divisor.size();
+	quotient.assign(m, 0);
+	remainder.assign(m, 0);
+	if (m < RADIX_CONVERSION_RECIPROCAL_THRESHOLD) {
+		// 长除法，被除数预留一个单元供规范化使用
+		scratch_vector parts = make_scratch_vector(std::max(dividend.size(), m) + 1);
+		std::copy(dividend.begin(), dividend.end(), parts.begin());
+		scratch_vector normalized_divisor(divisor.begin(), divisor.end(), thread_local_pool());
+		scratch_vector full_quotient = make_scratch_vector(parts.size() - m);
+		divide_in_place(span<natmax>(parts), span<natmax>(normalized_divisor), span<natmax>(full_quotient));
+		std::copy(full_quotient.begin(), full_quotient.begin() + min(m, full_quotient.size()), quotient.begin());
+		std::copy(parts.begin(), parts.begin() + m, remainder.begin());
+		return;
+	}
+	// Barrett 约减：以 floor(dividend / B^{m-1}) * reciprocal / B^{m+1} 估计商，估计值至多偏小2
+	if (power.reciprocal.empty()) {
+		power.reciprocal = make_scratch_vector(m + 2);
+		compute_reciprocal(span<natmax>(power.reciprocal), divisor);
+	}
+	scratch_vector parts = make_scratch_vector(std::max(dividend.size(), m + 1));
+	std::copy(dividend.begin(), dividend.end(), parts.begin());
+	if (dividend.size() >= m) {
+		span<natmax> top = dividend.subspan(m - 1);
+		scratch_vector product = make_scratch_vector(top.size() + m + 2);
+		multiply_parts(span<natmax>(product), top, span<natmax>(power.reciprocal));
+		span<natmax> estimate = span<natmax>(product).subspan(m + 1);
+		sizevalue length_of_estimate = significant_length(estimate);
+		if (length_of_estimate > 0) {
+			// parts <- dividend - estimate * divisor
+			scratch_vector subtrahend = make_scratch_vector(length_of_estimate + m);
+			multiply_parts(span<natmax>(subtrahend), estimate.first(length_of_estimate), divisor);
+			subtract_parts(span<natmax>(parts), span<natmax>(subtrahend));
+			std::copy(estimate.begin(), estimate.begin() + min(m, estimate.size()), quotient.begin());
+		}
+	}
+	natmax one[1] = { 1 };
+	while (not is_less_than(span<natmax>(parts), divisor)) {
+		subtract_parts(span<natmax>(parts), divisor);
+		add_parts(span<natmax>(quotient), span<natmax>(one));
+	}
+	std::copy(parts.begin(), parts.begin() + m, remainder.begin());
+}
+
+// 逻辑规范：
+// 前置条件 P: 0 <= chunk_value < base^digits，last - first >= digits 或者 chunk_value 的高位数字皆为0
+// 后置条件 Q: 从 last 向前写入 chunk_value 的 digits 位数字 (不超过 first)，last 移至写入的第一位
+static void write_chunk(natmax chunk_value, sizevalue digits, sizevalue base, char* first, char*& last) noexcept
+{
+	// 十进制最常用，单独处理以便编译器把除以常数优化为乘法
+	if (base == 10) {
+		for (sizevalue i = 0; i < digits and last != first; ++i) {
+			*--last = DIGITS[chunk_value % 10];
+			chunk_value /= 10;
+		}
+		return;
+	}
+	for (sizevalue i = 0; i < digits and last != first; ++i) {
+		*--last = DIGITS[chunk_value % base];
+		chunk_value /= base;
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: value < base^{last - first}
+// 后置条件 Q: [first, last) <- value 的 base 进制表示，高位补 '0'，value 被改变
+static void write_by_chunks(span<natmax> value, const radix_chunk& chunk, sizevalue base, char* first, char* last) noexcept
+{
+	sizevalue length = significant_length(value);
+	// 循环不变式：[last, 原 last) 为原 value mod base^{原 last - last} 的表示，value 为原 value 整除 base^{原 last - last}
+	while (length > 0) {
+		natmax remainder = divide_by_limb(value.first(length), chunk.power, chunk.reciprocal, value.first(length));
+		while (length > 0 and value[length - 1] == 0) {
+			--length;
+		}
+		write_chunk(remainder, chunk.digits, base, first, last);
+	}
+	std::fill(first, last, '0');
+}
+
+// 逻辑规范：
+// 前置条件 P: value < chunk.power^{2^level}，powers 至少有 level 项，last - first = chunk.digits * 2^level
+// 后置条件 Q: [first, last) <- value 的 base 进制表示，高位补 '0'
+static void write_by_powers(span<natmax> value, vector<radix_power>& powers, sizevalue level, const radix_chunk& chunk, sizevalue base, char* first, char* last)
+{
+	sizevalue length = significant_length(value);
+	if (level == 0 or length < RADIX_CONVERSION_DIVISION_THRESHOLD) {
+		write_by_chunks(value.first(length), chunk, base, first, last);
+		return;
+	}
+	// value = quotient * powers[level - 1] + remainder，两者都小于 powers[level - 1]，各占一半的数字
+	scratch_vector quotient = make_scratch_vector(0);
+	scratch_vector remainder = make_scratch_vector(0);
+	divide_by_power(quotient, remainder, value.first(length), powers[level - 1]);
+	char* middle = last - (chunk.digits << (level - 1));
+	write_by_powers(span<natmax>(quotient), powers, level - 1, chunk, base, first, middle);
+	write_by_powers(span<natmax>(remainder), powers, level - 1, chunk, base, middle, last);
+}
+
+byte_array convert_value_to_string(const span<natmax> value, sizevalue base)
+{
+	// 前置条件: 2 <= base <= 36
+	runtime_assert(2 <= base and base <= 36, "convert_value_to_string 的前置条件不被满足");
+	sizevalue length = significant_length(value);
+	if (length == 0) {
+		return "0";
+	}
+	sizevalue bit_length = (length - 1) * sizeof(natmax) * WORD_SIZE + std::bit_width(value[length - 1]);
+	if (std::has_single_bit(base)) {
+		// 每个数字恰好对应 bits_per_digit 个二进制位
+		sizevalue bits_per_digit = std::countr_zero(base);
+		sizevalue number_of_digits = (bit_length + bits_per_digit - 1) / bits_per_digit;
+		byte_array text(number_of_digits, '0');
+		for (sizevalue i = 0; i < number_of_digits; ++i) {
+			sizevalue position = i * bits_per_digit;
+			sizevalue index = position / (sizeof(natmax) * WORD_SIZE);
+			sizevalue offset = position % (sizeof(natmax) * WORD_SIZE);
+			natmax bits = value[index] >> offset;
+			if (offset + bits_per_digit > sizeof(natmax) * WORD_SIZE and index + 1 < length) {
+				bits |= value[index + 1] << (sizeof(natmax) * WORD_SIZE - offset);
+			}
+			text[number_of_digits - 1 - i] = DIGITS[bits & (base - 1)];
+		}
+		return text;
+	}
+	radix_chunk chunk = chunk_of(base);
+	scratch_vector work(value.begin(), value.begin() + length, thread_local_pool());
+	byte_array text;
+	if (length < RADIX_CONVERSION_DIVISION_THRESHOLD) {
+		// 每个整块至少消去 bit_width(chunk.power) - 1 个二进制位
+		sizevalue number_of_chunks = bit_length / (std::bit_width(chunk.power) - 1) + 1;
+		text.assign(number_of_chunks * chunk.digits, '0');
+		write_by_chunks(span<natmax>(work), chunk, base, text.data(), text.data() + text.size());
+	}
+	else {
+		// 取使 value < chunk.power^{2^level} 成立的 level，只需求出幂表的前 level 项：
+		// powers[level - 1] 有 s 个单元时，其平方不小于 B^{2s-2}
+		vector<radix_power> powers;
+		sizevalue level = 1;
+		extend_powers(powers, chunk, 0);
+		while (2 * powers[level - 1].power.size() - 2 < length) {
+			extend_powers(powers, chunk, level);
+			++level;
+		}
+		text.assign(chunk.digits << level, '0');
+		write_by_powers(span<natmax>(work), powers, level, chunk, base, text.data(), text.data() + text.size());
+	}
+	text.erase(0, min(text.find_first_not_of('0'), text.size() - 1));
+	return text;
+}
+
+// 逻辑规范：
+// 前置条件 P: text 非空且只含有 base 进制数字，result.size() = ceil(text.size() / chunk.digits)
+// 后置条件 Q: result <- text 以 base 进制表示的自然数
+static void read_by_chunks(string_view text, const radix_chunk& chunk, sizevalue base, span<natmax> result) noexcept
+{
+	std::fill(result.begin(), result.end(), 0);
+	sizevalue length = 0;
+	// 第一个整块可能不满 chunk.digits 位，其余整块皆满
+	sizevalue size = text.size() % chunk.digits == 0 ? chunk.digits : text.size() % chunk.digits;
+	// 循环不变式：result[0 .. length) = text[0 .. position) 表示的自然数
+	for (sizevalue position = 0; position < text.size(); position += size, size = chunk.digits) {
+		natmax carry = 0;
+		for (sizevalue i = 0; i < size; ++i) {
+			carry = carry * base + DIGIT_OF_CHARACTER[static_cast<nat8>(text[position + i])];
+		}
+		for (sizevalue i = 0; i < length; ++i) {
+			result[i] = multiply_add(result[i], chunk.power, 0, carry);
+		}
+		if (carry != 0) {
+			result[length++] = carry;
+		}
+	}
+}
+
+// 逻辑规范：
+// 前置条件 P: text 非空且只含有 base 进制数字，result.size() = ceil(text.size() / chunk.digits)，powers 足以覆盖 text 的长度
+// 后置条件 Q: result <- text 以 base 进制表示的自然数
+static void read_by_powers(string_view text, vector<radix_power>& powers, const radix_chunk& chunk, sizevalue base, span<natmax> result)
+{
+	if (text.size() < RADIX_CONVERSION_MULTIPLICATION_THRESHOLD * chunk.digits) {
+		read_by_chunks(text, chunk, base, result);
+		return;
+	}
+	// 低位部分恰好有 chunk.digits * 2^{level-1} 位，高位部分不多于低位部分
+	sizevalue level = 1;
+	while ((chunk.digits << level) < text.size()) {
+		++level;
+	}
+	sizevalue size_of_low = chunk.digits << (level - 1);
+	string_view high_text = text.substr(0, text.size() - size_of_low);
+	string_view low_text = text.substr(text.size() - size_of_low);
+	scratch_vector high = make_scratch_vector((high_text.size() + chunk.digits - 1) / chunk.digits);
+	scratch_vector low = make_scratch_vector(size_of_low / chunk.digits);
+	read_by_powers(high_text, powers, chunk, base, span<natmax>(high));
+	read_by_powers(low_text, powers, chunk, base, span<natmax>(low));
+	// result <- high * powers[level - 1] + low，乘积的单元数不超过 result.size()
+	std::fill(result.begin(), result.end(), 0);
+	span<natmax> power(powers[level - 1].power);
+	sizevalue length_of_high = significant_length(span<natmax>(high));
+	if (length_of_high > 0) {
+		multiply_parts(result.first(length_of_high + power.size()), span<natmax>(high).first(length_of_high), power);
+	}
+	add_parts(result, span<natmax>(low));
+}
+
+scratch_vector convert_string_to_value(string_view text, sizevalue base)
+{
+	// 前置条件: 2 <= base <= 36
+	runtime_assert(2 <= base and base <= 36, "convert_string_to_value 的前置条件不被满足");
+	if (text.empty()) {
+		throw invalid_argument("待转换的文本为空");
+	}
+	for (char c : text) {
+		if (DIGIT_OF_CHARACTER[static_cast<nat8>(c)] >= base) {
+			throw invalid_argument("待转换的文本含有不是" + std::to_string(base) + "进制数字的字符");
+		}
+	}
+	if (std::has_single_bit(base)) {
+		// 每个数字恰好对应 bits_per_digit 个二进制位
+		sizevalue bits_per_digit = std::countr_zero(base);
+		sizevalue bit_length = text.size() * bits_per_digit;
+		scratch_vector result = make_scratch_vector((bit_length + sizeof(natmax) * WORD_SIZE - 1) / (sizeof(natmax) * WORD_SIZE));
+		for (sizevalue i = 0; i < text.size(); ++i) {
+			natmax digit = DIGIT_OF_CHARACTER[static_cast<nat8>(text[text.size() - 1 - i])];
+			sizevalue position = i * bits_per_digit;
+			sizevalue index = position / (sizeof(natmax) * WORD_SIZE);
+			sizevalue offset = position % (sizeof(natmax) * WORD_SIZE);
+			result[index] |= digit << offset;
+			if (offset + bits_per_digit > sizeof(natmax) * WORD_SIZE) {
+				result[index + 1] |= digit >> (sizeof(natmax) * WORD_SIZE - offset);
+			}
+		}
+		return result;
+	}
+	radix_chunk chunk = chunk_of(base);
+	scratch_vector result = make_scratch_vector((text.size() + chunk.digits - 1) / chunk.digits);
+	vector<radix_power> powers;
+	if (text.size() >= RADIX_CONVERSION_MULTIPLICATION_THRESHOLD * chunk.digits) {
+		sizevalue level = 0;
+		while ((chunk.digits << (level + 1)) < text.size()) {
+			++level;
+		}
+		extend_powers(powers, chunk, level);
+	}
+	read_by_powers(text, powers, chunk, base, span<natmax>(result));
+	return result;
+}
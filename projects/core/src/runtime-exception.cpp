@@ -55,6 +55,10 @@ void runtime_assert(bool condition, byte_array information)
 
 void runtime_assert(bool condition, const char* information)
 {
+    // 条件成立时直接返回，避免在热路径上为错误信息构造字符串
+    if (condition) {
+        return;
+    }
     runtime_assert(condition, byte_array(information));
 }
 
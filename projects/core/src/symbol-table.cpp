@@ -0,0 +1,229 @@
+#include <symbol-table>
+#include <fnv-hash>
+#include <runtime-exception>
+#include <algorithm>
+
+// 逐个读出 UTF-32 文本的码位
+struct utf32_reader
+{
+	str_view text;
+	sizevalue i = 0;
+
+	bool done() const noexcept { return i >= text.size(); }
+	character next() noexcept { return text[i++]; }
+};
+
+// 逐个读出 UTF-8 文本的码位，解码规则与 fixed_length 相同 (无法解码的字节为 U+FFFD)
+struct utf8_reader
+{
+	std::string_view text;
+	sizevalue i = 0;
+
+	bool done() const noexcept { return i >= text.size(); }
+	character next() noexcept
+	{
+		sizevalue length = text.size();
+		nat8 c = static_cast<nat8>(text[i]);
+		if (c < 0x80) {
+			i += 1;
+			return c;
+		}
+		if ((c & 0xE0) == 0xC0 and i + 1 < length) {
+			character cp = ((c & 0x1F) << 6) | (static_cast<nat8>(text[i + 1]) & 0x3F);
+			i += 2;
+			return cp;
+		}
+		if ((c & 0xF0) == 0xE0 and i + 2 < length) {
+			character cp = ((c & 0x0F) << 12) | ((static_cast<nat8>(text[i + 1]) & 0x3F) << 6) | (static_cast<nat8>(text[i + 2]) & 0x3F);
+			i += 3;
+			return cp;
+		}
+		if ((c & 0xF8) == 0xF0 and i + 3 < length) {
+			character cp = ((c & 0x07) << 18) | ((static_cast<nat8>(text[i + 1]) & 0x3F) << 12)
+				| ((static_cast<nat8>(text[i + 2]) & 0x3F) << 6) | (static_cast<nat8>(text[i + 3]) & 0x3F);
+			i += 4;
+			return cp;
+		}
+		i += 1;
+		return 0xFFFD;
+	}
+};
+
+static utf32_reader reader_of(str_view text) noexcept { return { text }; }
+static utf8_reader reader_of(std::string_view text) noexcept { return { text }; }
+
+// 码位序列的 64 位 FNV-1a 散列，最后再混合一次，使高位 (用于选择分片) 同样均匀
+template<typename view>
+static natmax hash_of_text(view text) noexcept
+{
+	auto reader = reader_of(text);
+	natmax hash = FNV1A_OFFSET_BASIS;
+	while (not reader.done()) {
+		hash = fnv1a_step(hash, reader.next());
+	}
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDull;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+natmax symbol_table::hash_text(str_view text) noexcept
+{
+	return hash_of_text(text);
+}
+
+natmax symbol_table::hash_text(std::string_view utf8_text) noexcept
+{
+	return hash_of_text(utf8_text);
+}
+
+symbol_table::~symbol_table()
+{
+	for (auto& block : blocks) {
+		delete[] block.load(std::memory_order_relaxed);
+	}
+}
+
+const symbol_table::entry& symbol_table::entry_of(symbol s) const noexcept
+{
+	return blocks[s / ENTRIES_PER_BLOCK].load(std::memory_order_acquire)[s % ENTRIES_PER_BLOCK];
+}
+
+// 逻辑规范：
+// 前置条件 P: 持有 part 的锁 (共享或独占)，hash == hash_text(text)
+// 后置条件 Q: 返回 part 中文本为 text 的编号，不存在时返回 NO_SYMBOL
+template<typename view>
+symbol symbol_table::lookup(const shard& part, view text, natmax hash) const noexcept
+{
+	if (part.slots.empty()) {
+		return NO_SYMBOL;
+	}
+	sizevalue mask = part.slots.size() - 1;
+	for (sizevalue i = hash & mask; part.slots[i] != NO_SYMBOL; i = (i + 1) & mask) {
+		const entry& candidate = entry_of(part.slots[i]);
+		if (candidate.hash != hash) {
+			continue;
+		}
+		auto reader = reader_of(text);
+		sizevalue k = 0;
+		while (k < candidate.length and not reader.done() and reader.next() == candidate.text[k]) {
+			++k;
+		}
+		if (k == candidate.length and reader.done()) {
+			return part.slots[i];
+		}
+	}
+	return NO_SYMBOL;
+}
+
+template<typename view>
+symbol symbol_table::insert(view text)
+{
+	natmax hash = hash_of_text(text);
+	shard& part = shards[hash >> 60];
+	{
+		std::shared_lock lock(part.mutex);
+		symbol found = lookup(part, text, hash);
+		if (found != NO_SYMBOL) {
+			return found;
+		}
+	}
+	std::unique_lock lock(part.mutex);
+	// 在释放共享锁与取得独占锁之间，其他线程可能已经插入了同样的文本
+	symbol found = lookup(part, text, hash);
+	if (found != NO_SYMBOL) {
+		return found;
+	}
+	symbol s = next.fetch_add(1, std::memory_order_acq_rel);
+	runtime_assert(s < MAX_SYMBOLS, "符号表中的符号个数超过上限！");
+
+	// 文本以 UTF-32 复制到分片的内存池中，末尾补 U'\0'
+	sizevalue length = 0;
+	for (auto reader = reader_of(text); not reader.done(); reader.next()) {
+		++length;
+	}
+	character* copy = static_cast<character*>(part.arena.allocate((length + 1) * sizeof(character), alignof(character)));
+	auto reader = reader_of(text);
+	for (sizevalue k = 0; k < length; ++k) {
+		copy[k] = reader.next();
+	}
+	copy[length] = U'\0';
+
+	std::atomic<entry*>& block = blocks[s / ENTRIES_PER_BLOCK];
+	if (block.load(std::memory_order_acquire) == nullptr) {
+		std::lock_guard block_lock(block_mutex);
+		if (block.load(std::memory_order_relaxed) == nullptr) {
+			block.store(new entry[ENTRIES_PER_BLOCK], std::memory_order_release);
+		}
+	}
+	block.load(std::memory_order_acquire)[s % ENTRIES_PER_BLOCK] = { copy, length, hash };
+
+	// 装载因子保持在 1/2 以下
+	if ((part.count + 1) * 2 > part.slots.size()) {
+		std::vector<symbol> slots(std::max<sizevalue>(16, part.slots.size() * 2), NO_SYMBOL);
+		sizevalue mask = slots.size() - 1;
+		for (symbol old : part.slots) {
+			if (old != NO_SYMBOL) {
+				sizevalue i = entry_of(old).hash & mask;
+				while (slots[i] != NO_SYMBOL) {
+					i = (i + 1) & mask;
+				}
+				slots[i] = old;
+			}
+		}
+		part.slots = std::move(slots);
+	}
+	sizevalue mask = part.slots.size() - 1;
+	sizevalue i = hash & mask;
+	while (part.slots[i] != NO_SYMBOL) {
+		i = (i + 1) & mask;
+	}
+	part.slots[i] = s;
+	++part.count;
+	return s;
+}
+
+symbol symbol_table::intern(str_view text)
+{
+	return insert(text);
+}
+
+symbol symbol_table::intern(std::string_view utf8_text)
+{
+	return insert(utf8_text);
+}
+
+symbol symbol_table::find(str_view text) const noexcept
+{
+	natmax hash = hash_of_text(text);
+	const shard& part = shards[hash >> 60];
+	std::shared_lock lock(part.mutex);
+	return lookup(part, text, hash);
+}
+
+symbol symbol_table::find(std::string_view utf8_text) const noexcept
+{
+	natmax hash = hash_of_text(utf8_text);
+	const shard& part = shards[hash >> 60];
+	std::shared_lock lock(part.mutex);
+	return lookup(part, utf8_text, hash);
+}
+
+str_view symbol_table::text_of(symbol s) const
+{
+	runtime_assert(s < size(), "symbol_table::text_of 的前置条件不被满足");
+	const entry& e = entry_of(s);
+	return str_view(e.text, e.length);
+}
+
+natmax symbol_table::hash_of(symbol s) const
+{
+	runtime_assert(s < size(), "symbol_table::hash_of 的前置条件不被满足");
+	return entry_of(s).hash;
+}
+
+symbol_table& global_symbol_table()
+{
+	static symbol_table table;
+	return table;
+}
@@ -1,10 +1,134 @@
 #include <basic>
 #include <numerical-cell>
+#include <numerical-cell-fixed>
+#include <numerical-cell-batch>
+#include <memory-resource>
+#include <numerical-cell-serialization>
+#include <greatest-common-divisor>
+#include <numerical-cell-residue>
+#include <number-theoretic-transform>
+#include <symbol-table>
+#include <radix-conversion>
+#include <numerical-cell-counters>
 #include <vector>
 #include <iostream>
+#include <sstream>
+#include <random>
+#include <tuple>
+#include <array>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <numeric>
+#include <unistd.h>
 
 using std::vector;
 
+// 上限为 2^(64 * n) 的状态数
+static vector<natmax> power_of_limb(sizevalue n)
+{
+    vector<natmax> bound(n + 1, 0);
+    bound[n] = 1;
+    return bound;
+}
+
+static vector<natmax> random_limbs(std::mt19937_64& random, sizevalue n)
+{
+    vector<natmax> limbs(n);
+    for (natmax& limb : limbs) {
+        limb = random();
+    }
+    return limbs;
+}
+
+// 参照实现：逐单元相乘的教科书乘法，不经过数胞的任何乘法路径
+static vector<natmax> schoolbook_product(const vector<natmax>& left, const vector<natmax>& right)
+{
+    __extension__ typedef unsigned __int128 wide;
+    vector<natmax> product(left.size() + right.size(), 0);
+    for (sizevalue i = 0; i < left.size(); ++i) {
+        wide carry = 0;
+        for (sizevalue j = 0; j < right.size(); ++j) {
+            carry += static_cast<wide>(left[i]) * right[j] + product[i + j];
+            product[i + j] = static_cast<natmax>(carry);
+            carry >>= 64;
+        }
+        product[i + right.size()] = static_cast<natmax>(carry);
+    }
+    return product;
+}
+
+// 状态数为 bound、值为 value 的数胞 (value < bound)
+static NC make_cell(vector<natmax> bound, vector<natmax> value)
+{
+    return NC(std::move(bound), std::move(value));
+}
+
+// 参照实现：value mod modulus，只经过长除法，不经过按状态数形态的取模
+static vector<natmax> reference_mod(const vector<natmax>& value, const vector<natmax>& modulus)
+{
+    NC wide = make_cell(power_of_limb(value.size()), value);
+    wide %= make_cell(power_of_limb(modulus.size()), modulus);
+    return vector<natmax>(wide.value().begin(), wide.value().end());
+}
+
+// 状态数为 bound、值为 value mod bound 的数胞
+static NC cell_of(const vector<natmax>& bound, const vector<natmax>& value)
+{
+    return make_cell(bound, reference_mod(value, bound));
+}
+
+// 参照实现：从最高位起逐位平方，位为1时再乘以底数，只使用 *
+static NC reference_pow(const vector<natmax>& bound, const NC& base, const vector<natmax>& exponent)
+{
+    NC result = make_cell(bound, vector<natmax>{1});
+    for (sizevalue i = exponent.size() * 64; i-- > 0;) {
+        result = result * result;
+        if ((exponent[i / 64] >> (i % 64)) & 1) {
+            result = result * base;
+        }
+    }
+    return result;
+}
+
+#if defined(NUMERICAL_CELL_COUNTING)
+// 计数器钩子被调用时各次的加法计数 (钩子是函数指针，不能捕获局部变量)
+static vector<natmax> additions_seen_by_hook;
+
+static void record_additions(const numerical_cell_counters& counters)
+{
+    natmax additions = 0;
+    for (natmax count : counters.operations[static_cast<sizevalue>(cell_operation::ADD)]) {
+        additions += count;
+    }
+    additions_seen_by_hook.push_back(additions);
+}
+#endif
+
+// 参照实现：反复除以 base 得到 value 的 base 进制表示，不经过分块与分治转换
+static byte_array reference_to_string(vector<natmax> value, sizevalue base)
+{
+    __extension__ typedef unsigned __int128 wide;
+    byte_array text;
+    while (not value.empty()) {
+        wide remainder = 0;
+        for (sizevalue i = value.size(); i-- > 0;) {
+            wide current = (remainder << 64) | value[i];
+            value[i] = static_cast<natmax>(current / base);
+            remainder = current % base;
+        }
+        text.push_back("0123456789abcdefghijklmnopqrstuvwxyz"[static_cast<sizevalue>(remainder)]);
+        while (not value.empty() and value.back() == 0) {
+            value.pop_back();
+        }
+    }
+    if (text.empty()) {
+        text = "0";
+    }
+    return byte_array(text.rbegin(), text.rend());
+}
+
 int32 main()
 {
     NC c1 = NC(vector<natmax>{0, 1}, vector<natmax>{3});
@@ -14,10 +138,632 @@ int32 main()
     NC c5 = c1 * c2;
     NC c6 = c1 / c2;
     NC c7 = c1 % c2;
-    std::cout << c3.content[0] << std::endl;
-    std::cout << c4.content[0] << std::endl;
-    std::cout << c5.content[0] << std::endl;
-    std::cout << c6.content[0] << std::endl;
-    std::cout << c7.content[0] << std::endl;
+    std::cout << c3.value()[0] << std::endl;
+    std::cout << c4.value()[0] << std::endl;
+    std::cout << c5.value()[0] << std::endl;
+    std::cout << c6.value()[0] << std::endl;
+    std::cout << c7.value()[0] << std::endl;
+
+    // 进位链：(2^128 - 1) + 1 = 2^128，再减去 1 后借位穿过两个单元
+    NC k1 = make_cell(power_of_limb(3), vector<natmax>{natmax_max, natmax_max});
+    k1 += make_cell(power_of_limb(3), vector<natmax>{1});
+    bool carried = k1.significant_value().size() == 3 and k1.value()[2] == 1;
+    k1 -= make_cell(power_of_limb(3), vector<natmax>{1});
+    std::cout << (carried and k1.value()[0] == natmax_max and k1.value()[1] == natmax_max and k1.value()[2] == 0) << std::endl;
+
+    // 整单元乘法：(2^64 - 1) * (2^64 - 2) = 2^128 - 3 * 2^64 + 2，以及随机的多单元乘积与教科书乘法比较
+    NC k2 = make_cell(power_of_limb(2), vector<natmax>{natmax_max}) * make_cell(power_of_limb(2), vector<natmax>{natmax_max - 1});
+    bool multiplied = k2.value()[0] == 2 and k2.value()[1] == natmax_max - 2;
+    std::mt19937_64 random(20240611);
+    for (sizevalue i = 1; i <= 24; ++i) {
+        vector<natmax> left = random_limbs(random, i);
+        vector<natmax> right = random_limbs(random, 25 - i);
+        NC product = make_cell(power_of_limb(25), left) * make_cell(power_of_limb(25), right);
+        multiplied = multiplied and product == make_cell(power_of_limb(25), schoolbook_product(left, right));
+    }
+    std::cout << multiplied << std::endl;
+
+    // 按状态数的形态取模：一般、2^130、2^128 - 159、单个单元的状态数下，随机的积与长除法求出的余数比较
+    vector<vector<natmax>> bounds = {
+        { 0x123456789ABCDEF1, 0xFEDCBA9876543210, 0x0123456789ABCDEF },
+        { 0, 0, 4 },
+        { natmax_max - 158, natmax_max },
+        { 0xFEDCBA9876543211 },
+    };
+    vector<states_shape> shapes = { states_shape::GENERAL, states_shape::POWER_OF_TWO, states_shape::PSEUDO_MERSENNE, states_shape::SINGLE_LIMB };
+    bool reduced = true;
+    for (sizevalue k = 0; k < bounds.size(); ++k) {
+        const vector<natmax>& bound = bounds[k];
+        reduced = reduced and make_cell(bound, vector<natmax>{1}).shape() == shapes[k];
+        for (sizevalue i = 0; i < 200; ++i) {
+            NC left = cell_of(bound, random_limbs(random, bound.size() + 1));
+            NC right = cell_of(bound, random_limbs(random, bound.size() + 1));
+            if (i == 0) {
+                // 最大的两个值：(bound - 1) * (bound - 2)
+                left = make_cell(bound, vector<natmax>{0}) - make_cell(bound, vector<natmax>{1});
+                right = left - make_cell(bound, vector<natmax>{1});
+            }
+            vector<natmax> product = schoolbook_product(vector<natmax>(left.value().begin(), left.value().end()), vector<natmax>(right.value().begin(), right.value().end()));
+            reduced = reduced and left * right == cell_of(bound, product);
+        }
+    }
+    std::cout << reduced << std::endl;
+
+    // 幂：指数为 0、5 与两个单元的随机数时，pow 与 pow_mod 的结果与反复使用 * 的结果比较
+    bool powered = true;
+    for (const vector<natmax>& bound : bounds) {
+        vector<natmax> base_value = random_limbs(random, bound.size() + 1);
+        NC base = cell_of(bound, base_value);
+        NC modulus = make_cell(power_of_limb(bound.size()), bound);
+        NC wide_base = make_cell(power_of_limb(base_value.size()), base_value);
+        vector<natmax> multi_limb = random_limbs(random, 2);
+        vector<std::pair<vector<natmax>, NC>> cases = {
+            { { 0 }, make_cell(bound, vector<natmax>{ 1 }) },
+            { { 5 }, base * base * base * base * base },
+            { multi_limb, reference_pow(bound, base, multi_limb) },
+        };
+        for (const auto& [exponent, expected] : cases) {
+            NC exponent_cell = make_cell(power_of_limb(exponent.size()), exponent);
+            NC power = base;
+            power.pow(exponent_cell);
+            powered = powered and power == expected and pow_mod(wide_base, exponent_cell, modulus) == expected;
+        }
+    }
+    std::cout << powered << std::endl;
+
+    // 平方：各种形态的状态数下 square(x) = x * (x - 1) + x (x - 1 与 x 不同，乘法不会转为平方)
+    bool squared = true;
+    for (const vector<natmax>& bound : bounds) {
+        NC one = make_cell(bound, vector<natmax>{ 1 });
+        for (sizevalue i = 0; i < 50; ++i) {
+            NC x = i == 0 ? make_cell(bound, vector<natmax>{ 0 }) - one : cell_of(bound, random_limbs(random, bound.size() + 1));
+            NC square = x;
+            square.square();
+            squared = squared and square == x * (x - one) + x;
+        }
+    }
+    std::cout << squared << std::endl;
+
+    // 数论变换乘法：随机乘数与各单元都为 max(natmax) 的乘数 (卷积的各项最大) 的积与教科书乘法比较，
+    // 长度不同的乘数、乘数相同 (平方) 以及一般的状态数下取模的情形都要覆盖
+    bool transformed = true;
+    sizevalue large = NUMBER_THEORETIC_TRANSFORM_THRESHOLD;
+    vector<std::pair<vector<natmax>, vector<natmax>>> operands = {
+        { random_limbs(random, large + 32), random_limbs(random, large + 232) },
+        { vector<natmax>(large, natmax_max), vector<natmax>(large + 100, natmax_max) },
+    };
+    for (const auto& [left, right] : operands) {
+        vector<natmax> bound = power_of_limb(left.size() + right.size());
+        transformed = transformed and make_cell(bound, left) * make_cell(bound, right) == make_cell(bound, schoolbook_product(left, right));
+    }
+    vector<natmax> all_ones(large + 256, natmax_max);
+    NC all_ones_square = make_cell(power_of_limb(2 * all_ones.size()), all_ones);
+    all_ones_square.square();
+    transformed = transformed and all_ones_square == make_cell(power_of_limb(2 * all_ones.size()), schoolbook_product(all_ones, all_ones));
+    vector<natmax> general_bound = random_limbs(random, large + 64);
+    NC large_left = cell_of(general_bound, random_limbs(random, general_bound.size()));
+    NC large_right = cell_of(general_bound, random_limbs(random, general_bound.size()));
+    vector<natmax> large_product = schoolbook_product(vector<natmax>(large_left.value().begin(), large_left.value().end()), vector<natmax>(large_right.value().begin(), large_right.value().end()));
+    transformed = transformed and large_left.shape() == states_shape::GENERAL and large_left * large_right == cell_of(general_bound, large_product);
+    std::cout << transformed << std::endl;
+
+    // 多线程的数论变换乘法：乘积的长度不能被线程数整除的随机乘数、各单元都为 max(natmax) 的乘数、积中有跨越多个线程区间的
+    // 连续 max(natmax) 的乘数 ((B^k - 1) * r)，以及各区间自身的和都为连续的 max(natmax)、来自最低区间的进位要穿过其后所有区间的乘数
+    // ((2 + B + ... + B^{k-1}) * (B - 2 + B^767)，卷积的中间各项都为 max(natmax))
+    bool threaded = true;
+    sizevalue huge = 2 * NUMBER_THEORETIC_TRANSFORM_BUTTERFLIES_PER_THREAD;
+    vector<natmax> chain_left(4 * huge, 1);
+    chain_left[0] = 2;
+    vector<natmax> chain_right(large, 0);
+    chain_right[0] = natmax_max - 1;
+    chain_right[large - 1] = 1;
+    vector<std::tuple<vector<natmax>, vector<natmax>, sizevalue>> threaded_operands = {
+        { random_limbs(random, huge + 809), random_limbs(random, huge + 1), 3 },
+        { vector<natmax>(huge + 8, natmax_max), vector<natmax>(huge + 700, natmax_max), 4 },
+        { vector<natmax>(2 * huge, natmax_max), random_limbs(random, large), 3 },
+        { chain_left, chain_right, 4 },
+    };
+    for (const auto& [left, right, number_of_threads] : threaded_operands) {
+        vector<natmax> bound = power_of_limb(left.size() + right.size());
+        NC product = make_cell(bound, left);
+        product.multiply(make_cell(bound, right), number_of_threads);
+        threaded = threaded and product == make_cell(bound, schoolbook_product(left, right));
+    }
+    vector<natmax> huge_ones(huge + 5, natmax_max);
+    NC huge_square = make_cell(power_of_limb(2 * huge_ones.size()), huge_ones);
+    huge_square.square(4);
+    threaded = threaded and huge_square == make_cell(power_of_limb(2 * huge_ones.size()), schoolbook_product(huge_ones, huge_ones));
+    std::cout << threaded << std::endl;
+
+    // 除法：(5 + 7 * 2^64 + 9 * 2^128) / (3 + 2^64) 的商有两个单元 (回归)，以及随机的多单元被除数与除数满足 q * b + r = a 且 r < b
+    NC dividend = make_cell(power_of_limb(3), vector<natmax>{ 5, 7, 9 });
+    NC divisor = make_cell(power_of_limb(3), vector<natmax>{ 3, 1 });
+    NC quotient = dividend / divisor;
+    bool divided = quotient.significant_value().size() == 2 and quotient.value()[0] == 18446744073709551596ull and quotient.value()[1] == 8;
+    for (sizevalue i = 0; i < 300; ++i) {
+        sizevalue length = 2 + random() % 40;
+        vector<natmax> bound = power_of_limb(length);
+        vector<natmax> right = random_limbs(random, 1 + random() % length);
+        // 除数的最高单元有时很小，使规范化时的移位较大
+        right.back() >>= random() % 64;
+        right.back() |= 1;
+        NC a = make_cell(bound, random_limbs(random, length));
+        NC b = make_cell(bound, right);
+        NC q = a / b;
+        NC r = a % b;
+        divided = divided and r < b and q * b + r == a;
+    }
+    std::cout << divided << std::endl;
+
+    // 回归：(2^64 + 5) - 3，减数短于被减数且低位不产生借位 (borrow = 0 时也会传播借位)
+    NC d1 = NC(vector<natmax>{0, 0, 1}, vector<natmax>{5, 1});
+    d1 -= NC(vector<natmax>{0, 0, 1}, vector<natmax>{3});
+    std::cout << (d1.value()[0] == 2 and d1.value()[1] == 1) << std::endl;
+
+    // 回归：模 2^64 + 1 计算 2^64 * (2^64 - 1)，未约减的积超出状态数，应写回约减后的结果 2
+    NC d2 = NC(vector<natmax>{1, 1}, vector<natmax>{0, 1});
+    d2 *= NC(vector<natmax>{1, 1}, vector<natmax>{natmax_max});
+    std::cout << (d2.significant_value().size() == 1 and d2.value()[0] == 2 and d2.number_of_states()[1] == 1) << std::endl;
+
+    // 二元运算与复合赋值的结果相同；被除数与除数只有最低单元不同时，比较要逐单元扫描到最低位
+    bool compared = true;
+    {
+        std::mt19937_64 random(20240526);
+        vector<natmax> bound = power_of_limb(6);
+        vector<natmax> high = random_limbs(random, 6);
+        high[0] |= 1;
+        vector<natmax> low = high;
+        low[0] -= 1;
+        NC x = make_cell(bound, high);
+        NC y = make_cell(bound, low);
+        NC sum = x;
+        sum += y;
+        NC difference = x;
+        difference -= y;
+        NC product = x;
+        product *= y;
+        NC quotient = x;
+        quotient /= y;
+        NC remainder = y;
+        remainder %= x;
+        compared = x + y == sum and x - y == difference and x * y == product and x / y == quotient and y % x == remainder
+            and quotient.significant_value().size() == 1 and quotient.value()[0] == 1 and remainder == y and x > y;
+    }
+    std::cout << compared << std::endl;
+
+    // 定长数胞，状态数为0表示 2^64
+    constexpr NCF<1> f1 = NCF<1>({0}, {3});
+    constexpr NCF<1> f2 = NCF<1>({0}, {natmax_max});
+    constexpr NCF<1> f3 = f1 * f2;
+    std::cout << f3.value()[0] << std::endl;
+    std::cout << (static_cast<NC>(f3) == c5) << std::endl;
+
+    // 非整单元宽的状态数 (一般、2^k - c、只占低位单元) 下，随机的 +, -, * 与动态数胞的结果比较
+    bool fixed = true;
+    vector<std::array<natmax, 2>> fixed_bounds = {
+        { 0x123456789ABCDEF1, 0x0FEDCBA987654321 },
+        { natmax_max - 158, natmax_max },
+        { 0xFEDCBA9876543211, 0 },
+    };
+    for (const std::array<natmax, 2>& bound : fixed_bounds) {
+        vector<natmax> dynamic_bound(bound.begin(), bound.end());
+        if (dynamic_bound.back() == 0) {
+            dynamic_bound.pop_back();
+        }
+        for (sizevalue i = 0; i < 100; ++i) {
+            NC x = cell_of(dynamic_bound, random_limbs(random, 3));
+            NC y = cell_of(dynamic_bound, random_limbs(random, 3));
+            NCF<2> fx(x);
+            NCF<2> fy(y);
+            fixed = fixed and static_cast<NC>(fx + fy) == x + y and static_cast<NC>(fx - fy) == x - y and static_cast<NC>(fx * fy) == x * y
+                and std::ranges::equal(fx.number_of_states(), bound);
+        }
+    }
+    std::cout << fixed << std::endl;
+
+    // 共用状态数的一批数胞：{3, natmax_max} + {natmax_max, 3}，各自相加后的总和
+    NCB b1(vector<natmax>{0, 1}, 2);
+    NCB b2(vector<natmax>{0, 1}, 2);
+    b1.set(0, c1.value());
+    b1.set(1, c2.value());
+    b2.set(0, c2.value());
+    b2.set(1, c1.value());
+    b1 += b2;
+    std::cout << b1.sum().value()[0] << std::endl;
+
+    // 一般、2^130、2^128 - 159 的状态数下，随机的逐元素 +=, -=, *= 与 sum 与逐个数胞计算的结果比较
+    bool batched = true;
+    for (sizevalue k = 0; k < 3; ++k) {
+        const vector<natmax>& bound = bounds[k];
+        sizevalue count = 37;
+        NCB left(bound, count);
+        NCB right(bound, count);
+        vector<NC> left_cells;
+        vector<NC> right_cells;
+        for (sizevalue i = 0; i < count; ++i) {
+            left_cells.push_back(cell_of(bound, random_limbs(random, bound.size() + 1)));
+            right_cells.push_back(i == 0 ? make_cell(bound, vector<natmax>{0}) - make_cell(bound, vector<natmax>{1}) : cell_of(bound, random_limbs(random, bound.size() + 1)));
+            left.set(i, left_cells[i].value());
+            right.set(i, right_cells[i].value());
+        }
+        NCB sums = left;
+        sums += right;
+        NCB differences = left;
+        differences -= right;
+        NCB products = left;
+        products *= right;
+        NC total = make_cell(bound, vector<natmax>{0});
+        for (sizevalue i = 0; i < count; ++i) {
+            batched = batched and sums.get(i) == left_cells[i] + right_cells[i] and differences.get(i) == left_cells[i] - right_cells[i]
+                and products.get(i) == left_cells[i] * right_cells[i];
+            total += products.get(i);
+        }
+        batched = batched and products.sum() == total and std::ranges::equal(products.sum().number_of_states(), total.number_of_states());
+    }
+    std::cout << batched << std::endl;
+
+    // 从线程局部的单调内存池分配的数胞，运算结果沿用同一内存池，用完后一次性释放
+    {
+        NC a1 = NC(vector<natmax>{0, 1}, vector<natmax>{3}, thread_local_arena());
+        NC a2 = a1 * c2;
+        std::cout << (a2 == c5 and a2.resource() == thread_local_arena()) << std::endl;
+    }
+    reset_thread_local_arena();
+
+    // 文本与数胞之间的转换：2^128 - 1 的十进制表示，以十六进制输出
+    NC t1 = NC(vector<natmax>{0, 0, 1}, vector<natmax>{0});
+    t1.from_string("340282366920938463463374607431768211455");
+    std::cout << t1.to_string(16) << std::endl;
+
+    // 进制转换：逐块 (单元数少于 48)、分治 (不少于 48)、使用倒数 (拆分所用的除数不少于 8192 个单元) 与数论变换合并的路径，
+    // 2 的幂与非 2 的幂的进制下，较短的值与逐位相除的结果比较，所有的值都要能从文本还原
+    bool converted = true;
+    for (sizevalue length : { sizevalue(1), sizevalue(3), sizevalue(47), sizevalue(48), sizevalue(130) }) {
+        for (sizevalue base : { sizevalue(2), sizevalue(7), sizevalue(10), sizevalue(16), sizevalue(36) }) {
+            vector<natmax> limbs = random_limbs(random, length);
+            if (length == 130) {
+                // 中间的一段为0，分治时高半部分或低半部分可能只有高位0
+                std::fill(limbs.begin() + 40, limbs.begin() + 100, 0);
+            }
+            NC cell = make_cell(power_of_limb(length), limbs);
+            byte_array text = cell.to_string(base);
+            NC parsed = make_cell(power_of_limb(length), vector<natmax>{0});
+            parsed.from_string(text, base);
+            converted = converted and text == reference_to_string(limbs, base) and parsed == cell;
+        }
+    }
+    for (sizevalue length : { RADIX_CONVERSION_MULTIPLICATION_THRESHOLD * 2 + 5, RADIX_CONVERSION_RECIPROCAL_THRESHOLD * 2 + 1000 }) {
+        for (sizevalue base : { sizevalue(10), sizevalue(7), sizevalue(36) }) {
+            vector<natmax> limbs = base == 36 ? vector<natmax>(length, natmax_max) : random_limbs(random, length);
+            NC cell = make_cell(power_of_limb(length), limbs);
+            NC parsed = make_cell(power_of_limb(length), vector<natmax>{0});
+            parsed.from_string(cell.to_string(base), base);
+            converted = converted and parsed == cell;
+        }
+    }
+    // 大写字母与小写字母等价；空文本与含有非法字符的文本被拒绝，且不修改数胞
+    NC hexadecimal = make_cell(power_of_limb(1), vector<natmax>{0});
+    hexadecimal.from_string("DeadBeef", 16);
+    converted = converted and hexadecimal.value()[0] == 0xdeadbeef;
+    for (auto [text, base] : { std::pair<const char*, sizevalue>{ "", 10 }, { "12a", 10 }, { "-1", 10 }, { "8", 8 }, { "z!", 36 } }) {
+        try {
+            hexadecimal.from_string(text, base);
+            converted = false;
+        }
+        catch (const std::invalid_argument&) {
+            converted = converted and hexadecimal.value()[0] == 0xdeadbeef;
+        }
+    }
+    std::cout << converted << std::endl;
+
+    // 数胞表的写入与读出
+    std::stringstream table;
+    write_numerical_cells(table, vector<NC>{c1, c5, t1});
+    vector<NC> loaded = read_numerical_cells(table);
+    std::cout << (loaded.size() == 3 and loaded[1] == c5 and loaded[2].to_string() == t1.to_string()) << std::endl;
+
+    // 两种种类的数胞表经流与映射 (numerical_cell_table_view) 读出后不变；魔数、版本、种类不符，数据被截断，
+    // 以及值不小于状态数的表都被拒绝
+    bool serialized = true;
+    {
+        vector<NC> cells = { c1, cell_of(bounds[0], random_limbs(random, 4)), t1, cell_of(bounds[2], random_limbs(random, 3)) };
+        NCB batch(bounds[0], 5);
+        for (sizevalue i = 0; i < batch.size(); ++i) {
+            batch.set(i, cell_of(bounds[0], random_limbs(random, 4)).value());
+        }
+        std::stringstream cells_stream;
+        write_numerical_cells(cells_stream, cells);
+        std::stringstream batch_stream;
+        write_numerical_cell_batch(batch_stream, batch);
+        const byte_array cells_bytes = cells_stream.str();
+        const byte_array batch_bytes = batch_stream.str();
+
+        vector<NC> cells_loaded = read_numerical_cells(cells_stream);
+        NCB batch_loaded = read_numerical_cell_batch(batch_stream);
+        serialized = cells_loaded.size() == cells.size() and batch_loaded.size() == batch.size();
+        for (sizevalue i = 0; serialized and i < cells.size(); ++i) {
+            serialized = cells_loaded[i] == cells[i] and std::ranges::equal(cells_loaded[i].number_of_states(), cells[i].number_of_states());
+        }
+        for (sizevalue i = 0; serialized and i < batch.size(); ++i) {
+            serialized = batch_loaded.get(i) == batch.get(i);
+        }
+
+        // 写入临时文件后映射
+        byte_array path = (std::filesystem::temp_directory_path() / ("numerical-cell-table-" + std::to_string(getpid()))).string();
+        auto write_file = [&](const byte_array& bytes) {
+            std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+        };
+        write_file(cells_bytes);
+        {
+            numerical_cell_table_view view(path);
+            serialized = serialized and view.kind() == numerical_cell_format_kind::CELLS and view.size() == cells.size();
+            for (sizevalue i = 0; serialized and i < cells.size(); ++i) {
+                serialized = std::ranges::equal(view.value(i), cells[i].value()) and std::ranges::equal(view.number_of_states(i), cells[i].number_of_states())
+                    and view.get(i) == cells[i];
+            }
+        }
+        write_file(batch_bytes);
+        {
+            numerical_cell_table_view view(path);
+            serialized = serialized and view.kind() == numerical_cell_format_kind::BATCH and view.size() == batch.size();
+            for (sizevalue i = 0; serialized and i < batch.size(); ++i) {
+                serialized = std::ranges::equal(view.number_of_states(i), bounds[0]) and view.get(i) == batch.get(i);
+            }
+        }
+
+        // 修改第 index 个字后的表
+        auto with_word = [](byte_array bytes, sizevalue index, natmax word) {
+            memcpy(bytes.data() + index * sizeof(natmax), &word, sizeof(natmax));
+            return bytes;
+        };
+        auto word_of = [](const byte_array& bytes, sizevalue index) {
+            natmax word;
+            memcpy(&word, bytes.data() + index * sizeof(natmax), sizeof(natmax));
+            return word;
+        };
+        // 第一个数胞的值 <- 状态数 (值不小于状态数)；批中第一个数胞的值 <- 共用的状态数
+        byte_array cells_out_of_bound = cells_bytes;
+        sizevalue position = word_of(cells_bytes, 4);
+        sizevalue n = word_of(cells_bytes, 5);
+        for (sizevalue k = 0; k < n; ++k) {
+            cells_out_of_bound = with_word(cells_out_of_bound, position + k, word_of(cells_bytes, position + n + k));
+        }
+        byte_array batch_out_of_bound = batch_bytes;
+        n = word_of(batch_bytes, 4);
+        for (sizevalue k = 0; k < n; ++k) {
+            batch_out_of_bound = with_word(batch_out_of_bound, 5 + n + k, word_of(batch_bytes, 5 + k));
+        }
+        auto rejected = [](auto&& read) {
+            try {
+                read();
+                return false;
+            }
+            catch (const std::exception&) {
+                return true;
+            }
+        };
+        for (const byte_array* bytes : { &cells_bytes, &batch_bytes }) {
+            bool is_batch = bytes == &batch_bytes;
+            vector<byte_array> damaged = {
+                with_word(*bytes, 0, NUMERICAL_CELL_FORMAT_MAGIC + 1),
+                with_word(*bytes, 1, NUMERICAL_CELL_FORMAT_VERSION + 1),
+                with_word(*bytes, 2, 7),
+                bytes->substr(0, 5 * sizeof(natmax)),
+                is_batch ? batch_out_of_bound : cells_out_of_bound,
+            };
+            // 只截去最后一个字：流在读到末尾时发现；映射时要在访问最后一个数胞时才发现，因此只检查流
+            std::stringstream truncated(bytes->substr(0, bytes->size() - sizeof(natmax)));
+            serialized = serialized and rejected([&] {
+                if (is_batch) {
+                    read_numerical_cell_batch(truncated);
+                }
+                else {
+                    read_numerical_cells(truncated);
+                }
+            });
+            for (sizevalue i = 0; i < damaged.size(); ++i) {
+                std::stringstream stream(damaged[i]);
+                serialized = serialized and rejected([&] {
+                    if (is_batch) {
+                        read_numerical_cell_batch(stream);
+                    }
+                    else {
+                        read_numerical_cells(stream);
+                    }
+                });
+                // 映射时只检查头部与长度，值是否小于状态数在 get 时检查
+                write_file(damaged[i]);
+                serialized = serialized and rejected([&] {
+                    numerical_cell_table_view view(path);
+                    view.get(0);
+                });
+            }
+            // 种类不符
+            std::stringstream stream(*bytes);
+            serialized = serialized and rejected([&] {
+                if (is_batch) {
+                    read_numerical_cells(stream);
+                }
+                else {
+                    read_numerical_cell_batch(stream);
+                }
+            });
+        }
+        std::filesystem::remove(path);
+    }
+    std::cout << serialized << std::endl;
+
+    // 最大公因数与模逆元：gcd(3 * 2^64, 3) = 3，3 模 2^64 + 1 的逆元为 6148914691236517206
+    NC g1 = NC(vector<natmax>{0, 0, 1}, vector<natmax>{0, 3});
+    std::cout << gcd(g1, c1).value()[0] << std::endl;
+    NC m1 = NC(vector<natmax>{0, 0, 1}, vector<natmax>{1, 1});
+    std::cout << inverse_mod(c1, m1).value()[0] << std::endl;
+
+    // 多单元 (Lehmer 算法) 的随机值与含有公因数的值：gcd 与反复取余的结果比较，extended_gcd 满足 left * x + right * y = gcd
+    // 且 |x| <= right / gcd, |y| <= left / gcd，inverse_mod 的结果与值之积模模数为1，不互素时抛出 invalid_argument
+    bool divided_evenly = true;
+    {
+        // 参照运算在足以容纳所有积的状态数下进行
+        auto wide_cell = [](span<natmax> value) { return make_cell(power_of_limb(16), vector<natmax>(value.begin(), value.end())); };
+        auto is_zero = [](const NC& cell) { return cell.significant_value().size() == 1 and cell.value()[0] == 0; };
+        auto reference_gcd = [&](NC a, NC b) {
+            while (not is_zero(b)) {
+                a %= b;
+                std::swap(a, b);
+            }
+            return a;
+        };
+        vector<natmax> small_bound = power_of_limb(8);
+        for (sizevalue i = 0; i < 120; ++i) {
+            vector<natmax> left_value = random_limbs(random, 1 + i % 6);
+            vector<natmax> right_value = random_limbs(random, 1 + (i / 6) % 6);
+            if (i % 3 == 0) {
+                // 公因数占两个单元
+                vector<natmax> factor = random_limbs(random, 2);
+                left_value = schoolbook_product(vector<natmax>(left_value.begin(), left_value.begin() + (left_value.size() + 1) / 2), factor);
+                right_value = schoolbook_product(vector<natmax>(right_value.begin(), right_value.begin() + (right_value.size() + 1) / 2), factor);
+            }
+            if (i == 1) {
+                right_value = { 0 };
+            }
+            if (i == 2) {
+                left_value = { 0 };
+            }
+            NC left = make_cell(small_bound, left_value);
+            NC right = make_cell(small_bound, right_value);
+            NC expected = reference_gcd(wide_cell(left.value()), wide_cell(right.value()));
+            NC g = gcd(left, right);
+            extended_gcd_result bezout = extended_gcd(left, right);
+            divided_evenly = divided_evenly and wide_cell(g.value()) == expected and wide_cell(bezout.gcd.value()) == expected
+                and std::ranges::equal(g.number_of_states(), small_bound) and std::ranges::equal(bezout.left_coefficient.number_of_states(), small_bound);
+            // 把正负两侧分别累加：正项之和 = gcd + 负项之和
+            NC left_term = wide_cell(left.value()) * wide_cell(bezout.left_coefficient.value());
+            NC right_term = wide_cell(right.value()) * wide_cell(bezout.right_coefficient.value());
+            NC positive = make_cell(power_of_limb(16), vector<natmax>{0});
+            NC negative = positive;
+            (bezout.left_coefficient_is_negative ? negative : positive) += left_term;
+            (bezout.right_coefficient_is_negative ? negative : positive) += right_term;
+            divided_evenly = divided_evenly and positive == expected + negative;
+            // 另一个值为0时系数为1 (gcd 即为不为0的值)
+            if (not is_zero(expected)) {
+                NC one = make_cell(power_of_limb(16), vector<natmax>{1});
+                NC x = wide_cell(bezout.left_coefficient.value());
+                NC y = wide_cell(bezout.right_coefficient.value());
+                divided_evenly = divided_evenly and (is_zero(right) ? x == one : x * expected <= wide_cell(right.value()))
+                    and (is_zero(left) ? y == one : y * expected <= wide_cell(left.value()));
+            }
+
+            // 模逆元：模数为 right 的值 (不为0时)
+            if (is_zero(right) or (right.significant_value().size() == 1 and right.value()[0] == 1)) {
+                continue;
+            }
+            NC modulus = make_cell(power_of_limb(right.significant_value().size()), vector<natmax>(right.significant_value().begin(), right.significant_value().end()));
+            NC value = make_cell(power_of_limb(left.significant_value().size()), vector<natmax>(left.significant_value().begin(), left.significant_value().end()));
+            bool coprime = expected.significant_value().size() == 1 and expected.value()[0] == 1;
+            try {
+                NC inverse = inverse_mod(value, modulus);
+                NC product = wide_cell(inverse.value()) * wide_cell(left.value());
+                product %= wide_cell(right.value());
+                divided_evenly = divided_evenly and coprime and product.significant_value().size() == 1 and product.value()[0] == 1
+                    and std::ranges::equal(inverse.number_of_states(), right.significant_value());
+            }
+            catch (const std::invalid_argument&) {
+                divided_evenly = divided_evenly and not coprime;
+            }
+        }
+    }
+    std::cout << divided_evenly << std::endl;
+
+    // 剩余数系统：模数 2^61 - 1 与 2^31 - 1 下计算 (2^64 + 3) * 3，积小于模数之积，还原后即为积本身
+    residue_number_system r1(vector<natmax>{2305843009213693951, 2147483647});
+    NC r2 = NC(vector<natmax>{0, 0, 1}, vector<natmax>{3, 1});
+    NCR r3 = NCR(r1, r2) * NCR(r1, c1);
+    std::cout << r3.to_numerical_cell().to_string() << std::endl;
+
+    // 接近 2^63 的两两互素的奇数模数 (含 2^63 - 1) 下，随机的 +, -, * 与以模数之积为状态数的数胞的结果比较；
+    // 模数为空、为偶数、小于3、不小于 2^63 或者不两两互素时构造函数抛出 invalid_argument
+    bool residual = true;
+    {
+        vector<natmax> moduli = { (natmax(1) << 63) - 1 };
+        while (moduli.size() < 6) {
+            natmax candidate = ((natmax(1) << 63) - 1 - (random() % (natmax(1) << 20))) | 1;
+            if (std::ranges::all_of(moduli, [&](natmax m) { return std::gcd(m, candidate) == 1; })) {
+                moduli.push_back(candidate);
+            }
+        }
+        for (sizevalue k = 1; k <= moduli.size(); ++k) {
+            residue_number_system system(vector<natmax>(moduli.begin(), moduli.begin() + k));
+            vector<natmax> product(system.number_of_states().begin(), system.number_of_states().end());
+            for (sizevalue i = 0; i < 40; ++i) {
+                NC x = cell_of(product, random_limbs(random, product.size() + 1));
+                NC y = i == 0 ? make_cell(product, vector<natmax>{0}) - make_cell(product, vector<natmax>{1}) : cell_of(product, random_limbs(random, product.size() + 1));
+                NCR rx(system, x);
+                NCR ry(system, y);
+                residual = residual and (rx + ry).to_numerical_cell() == x + y and (rx - ry).to_numerical_cell() == x - y and (rx * ry).to_numerical_cell() == x * y
+                    and std::ranges::equal((rx * ry).to_numerical_cell().number_of_states(), product);
+                for (sizevalue j = 0; j < k; ++j) {
+                    residual = residual and rx.residue(j) == cell_of(vector<natmax>{ moduli[j] }, vector<natmax>(x.value().begin(), x.value().end())).value()[0];
+                }
+            }
+        }
+        vector<vector<natmax>> invalid_moduli = { {}, { 4, 7 }, { 1 }, { 7, natmax(1) << 63 | 1 }, { 15, 7, 21 } };
+        for (const vector<natmax>& invalid : invalid_moduli) {
+            try {
+                residue_number_system system(invalid);
+                residual = false;
+            }
+            catch (const std::invalid_argument&) {
+            }
+        }
+    }
+    std::cout << residual << std::endl;
+
+    // 运算计数：定义 NUMERICAL_CELL_COUNTING 编译时，一次回绕的 += 使加法与回绕的计数各加一，钩子每 period 次运算调用一次，
+    // reset 把所有计数清零，JSON 按状态数的单元数分级输出；未定义时计数始终为0
+    bool counters_checked = true;
+    {
+        auto all_zero = [](const numerical_cell_counters& counters) {
+            numerical_cell_counters zero{};
+            return memcmp(&counters, &zero, sizeof(counters)) == 0;
+        };
+        NC wrapping = make_cell(vector<natmax>{ 5 }, vector<natmax>{ 3 });
+        NC addend = make_cell(vector<natmax>{ 5 }, vector<natmax>{ 4 });
+        NC wide = cell_of(bounds[0], random_limbs(random, 4));
+        NC wide_five = make_cell(power_of_limb(5), vector<natmax>{ 1 });
+        reset_numerical_cell_counters();
+        wrapping += addend;
+        numerical_cell_counters after_wrap = snapshot_numerical_cell_counters();
+        reset_numerical_cell_counters();
+        numerical_cell_counters after_reset = snapshot_numerical_cell_counters();
+        wide_five += wide_five;
+        std::ostringstream json;
+        write_numerical_cell_counters(json, snapshot_numerical_cell_counters());
+#if defined(NUMERICAL_CELL_COUNTING)
+        counters_checked = wrapping.value()[0] == 2
+            and after_wrap.slow_paths[static_cast<sizevalue>(cell_slow_path::LIMIT_VALUE_AFTER_INCREASE)] == 1
+            and after_wrap.operations[static_cast<sizevalue>(cell_operation::ADD)][0] == 1
+            and all_zero(after_reset)
+            and json.str().find("{\"operations\": {\"add\": {\"5-8\": 1}}") == 0;
+        reset_numerical_cell_counters();
+        set_numerical_cell_counters_hook(record_additions, 3);
+        for (sizevalue i = 0; i < 10; ++i) {
+            wide += wide;
+        }
+        set_numerical_cell_counters_hook(nullptr, 0);
+        counters_checked = counters_checked and additions_seen_by_hook == vector<natmax>{ 3, 6, 9 }
+            and snapshot_numerical_cell_counters().operations[static_cast<sizevalue>(cell_operation::ADD)][limb_class_of(bounds[0].size())] == 10;
+#else
+        counters_checked = wrapping.value()[0] == 2 and all_zero(after_wrap) and all_zero(after_reset) and all_zero(snapshot_numerical_cell_counters())
+            and json.str() == "{\"operations\": {}, \"slow_paths\": {}, \"reductions\": {}, \"scratch_allocations\": 0, \"scratch_limbs\": 0}";
+#endif
+        reset_numerical_cell_counters();
+    }
+    std::cout << counters_checked << std::endl;
+
+    // 符号表：UTF-8 与 UTF-32 的同一文本得到同一编号，未驻留的文本查找不到
+    symbol_table symbols;
+    symbol s1 = symbols.intern(U"数胞");
+    symbol s2 = symbols.intern("数胞");
+    std::cout << (s1 == s2 and symbols.text_of(s1) == U"数胞" and symbols.find("数") == NO_SYMBOL and symbols.size() == 1) << std::endl;
     return 0;
 }
\ No newline at end of file